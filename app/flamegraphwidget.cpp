@@ -0,0 +1,185 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "flamegraphwidget.h"
+
+#include "massifdata/snapshotitem.h"
+#include "massifdata/treeleafitem.h"
+
+#include "visualizer/callertreegenerator.h"
+#include "visualizer/util.h"
+
+#include <QtGui/QPainter>
+#include <QtGui/QMouseEvent>
+#include <QtGui/QKeyEvent>
+#include <QtGui/QHelpEvent>
+#include <QtGui/QToolTip>
+
+using namespace Massif;
+
+namespace {
+
+QColor colorForNode(const TreeLeafItem* node, bool selected)
+{
+    if (selected) {
+        return QColor::fromHsv(210, 160, 255);
+    }
+    // stable, warm colors per function
+    const uint hash = qHash(CallerTreeGenerator::functionKey(node));
+    return QColor::fromHsv(hash % 50, 130 + hash % 80, 230);
+}
+
+}
+
+FlameGraphWidget::FlameGraphWidget(QWidget* parent)
+    : QWidget(parent), m_snapshot(0), m_zoom(0), m_selection(0)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setFocusPolicy(Qt::ClickFocus);
+    setMinimumSize(100, 100);
+}
+
+FlameGraphWidget::~FlameGraphWidget()
+{
+}
+
+void FlameGraphWidget::setSnapshot(SnapshotItem* snapshot)
+{
+    if (snapshot == m_snapshot) {
+        return;
+    }
+    m_snapshot = snapshot;
+    m_zoom = snapshot ? snapshot->heapTree() : 0;
+    m_selection = 0;
+    m_layouter.clear();
+    update();
+}
+
+SnapshotItem* FlameGraphWidget::snapshot() const
+{
+    return m_snapshot;
+}
+
+void FlameGraphWidget::setSelection(TreeLeafItem* node)
+{
+    m_selection = node;
+    if (node && m_zoom) {
+        // zoom out if the node is not below the zoomed frame
+        TreeLeafItem* parent = node;
+        while (parent && parent != m_zoom) {
+            parent = parent->parent();
+        }
+        if (!parent) {
+            m_zoom = m_snapshot ? m_snapshot->heapTree() : 0;
+        }
+    }
+    update();
+}
+
+void FlameGraphWidget::zoomInto(TreeLeafItem* node)
+{
+    if (!node || !node->cost()) {
+        return;
+    }
+    m_zoom = node;
+    update();
+}
+
+int FlameGraphWidget::rowHeight() const
+{
+    return fontMetrics().height() + 4;
+}
+
+void FlameGraphWidget::paintEvent(QPaintEvent* /*event*/)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().base());
+    m_layouter.layout(m_zoom, width(), height(), rowHeight());
+    foreach (const FlameGraphFrame& frame, m_layouter.frames()) {
+        drawFrame(&painter, frame);
+    }
+}
+
+void FlameGraphWidget::drawFrame(QPainter* painter, const FlameGraphFrame& frame)
+{
+    TreeLeafItem* node = frame.node;
+    painter->fillRect(frame.rect, colorForNode(node, node == m_selection));
+    const qreal width = frame.rect.width();
+    if (width > 20) {
+        const QString label = node->parent() ? functionInLabel(node) : prettyCost(node->cost());
+        painter->setPen(Qt::black);
+        painter->drawText(frame.rect.adjusted(2, 0, -2, 0), Qt::AlignVCenter | Qt::AlignLeft,
+                          fontMetrics().elidedText(label, Qt::ElideRight, int(width) - 4));
+    }
+}
+
+TreeLeafItem* FlameGraphWidget::frameAt(const QPoint& pos) const
+{
+    const FlameGraphFrame* frame = m_layouter.frameAt(pos);
+    return frame ? frame->node : 0;
+}
+
+void FlameGraphWidget::mouseReleaseEvent(QMouseEvent* event)
+{
+    if (event->button() == Qt::LeftButton) {
+        if (TreeLeafItem* node = frameAt(event->pos())) {
+            m_selection = node;
+            update();
+            emit nodeClicked(node);
+        }
+    }
+    QWidget::mouseReleaseEvent(event);
+}
+
+void FlameGraphWidget::mouseDoubleClickEvent(QMouseEvent* event)
+{
+    if (event->button() == Qt::LeftButton) {
+        zoomInto(frameAt(event->pos()));
+    }
+    QWidget::mouseDoubleClickEvent(event);
+}
+
+void FlameGraphWidget::keyPressEvent(QKeyEvent* event)
+{
+    if (event->key() == Qt::Key_Escape && m_zoom && m_zoom->parent()) {
+        // zoom out one level
+        zoomInto(m_zoom->parent());
+        event->accept();
+        return;
+    }
+    QWidget::keyPressEvent(event);
+}
+
+bool FlameGraphWidget::event(QEvent* event)
+{
+    if (event->type() == QEvent::ToolTip) {
+        QHelpEvent* helpEvent = static_cast<QHelpEvent*>(event);
+        TreeLeafItem* node = frameAt(helpEvent->pos());
+        if (node && m_snapshot) {
+            QToolTip::showText(helpEvent->globalPos(), tooltipForTreeLeaf(node, m_snapshot, node->label()), this);
+        } else {
+            QToolTip::hideText();
+        }
+        return true;
+    }
+    return QWidget::event(event);
+}
+
+#include "flamegraphwidget.moc"
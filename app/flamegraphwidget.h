@@ -0,0 +1,92 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MASSIF_FLAMEGRAPHWIDGET_H
+#define MASSIF_FLAMEGRAPHWIDGET_H
+
+#include <QtGui/QWidget>
+
+#include "visualizer/flamegraphlayouter.h"
+
+namespace Massif {
+
+class SnapshotItem;
+class TreeLeafItem;
+
+/**
+ * Shows the heap tree of a snapshot as icicle graph: the root spans the
+ * whole width, children are drawn below their parent with a width that is
+ * proportional to their cost.
+ *
+ * Frames narrower than a pixel are not drawn at all, double clicking a frame
+ * zooms into it.
+ */
+class FlameGraphWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    FlameGraphWidget(QWidget* parent = 0);
+    virtual ~FlameGraphWidget();
+
+    /**
+     * Show the heap tree of @p snapshot, or nothing if it is zero.
+     */
+    void setSnapshot(SnapshotItem* snapshot);
+    SnapshotItem* snapshot() const;
+
+    /**
+     * Highlight @p node, zooming out if it is not visible.
+     */
+    void setSelection(TreeLeafItem* node);
+
+    /**
+     * Zoom into @p node, which then spans the whole width.
+     */
+    void zoomInto(TreeLeafItem* node);
+
+signals:
+    /**
+     * Emitted when the frame for @p node got clicked.
+     */
+    void nodeClicked(Massif::TreeLeafItem* node);
+
+protected:
+    virtual void paintEvent(QPaintEvent* event);
+    virtual void mouseReleaseEvent(QMouseEvent* event);
+    virtual void mouseDoubleClickEvent(QMouseEvent* event);
+    virtual void keyPressEvent(QKeyEvent* event);
+    virtual bool event(QEvent* event);
+
+private:
+    void drawFrame(QPainter* painter, const FlameGraphFrame& frame);
+    TreeLeafItem* frameAt(const QPoint& pos) const;
+    int rowHeight() const;
+
+    SnapshotItem* m_snapshot;
+    TreeLeafItem* m_zoom;
+    TreeLeafItem* m_selection;
+    // frames drawn in the last paint event, for hit testing
+    FlameGraphLayouter m_layouter;
+};
+
+}
+
+#endif // MASSIF_FLAMEGRAPHWIDGET_H
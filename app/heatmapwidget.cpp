@@ -0,0 +1,170 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "heatmapwidget.h"
+
+#include "visualizer/heatmap.h"
+#include "visualizer/timeseriesindex.h"
+#include "visualizer/util.h"
+
+#include "massifdata/snapshotitem.h"
+
+#include <KLocalizedString>
+
+#include <QtGui/QPainter>
+#include <QtGui/QMouseEvent>
+#include <QtGui/QWheelEvent>
+#include <QtGui/QHelpEvent>
+#include <QtGui/QToolTip>
+#include <QtGui/QTextDocument>
+
+using namespace Massif;
+
+HeatMapWidget::HeatMapWidget(QWidget* parent)
+    : QWidget(parent), m_map(0), m_dragging(false)
+{
+    setMouseTracking(true);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setMinimumSize(100, 100);
+}
+
+HeatMapWidget::~HeatMapWidget()
+{
+}
+
+void HeatMapWidget::setHeatMap(const HeatMap* map)
+{
+    m_map = map;
+    m_image = map ? map->image() : QImage();
+    resetZoom();
+}
+
+void HeatMapWidget::resetZoom()
+{
+    m_view = QRectF(QPointF(0, 0), m_image.size());
+    update();
+}
+
+void HeatMapWidget::clampView()
+{
+    const QSizeF full = m_image.size();
+    // show at least a few cells
+    m_view.setWidth(qBound(qMin(qreal(4), full.width()), m_view.width(), full.width()));
+    m_view.setHeight(qBound(qMin(qreal(4), full.height()), m_view.height(), full.height()));
+    m_view.moveLeft(qBound(qreal(0), m_view.left(), full.width() - m_view.width()));
+    m_view.moveTop(qBound(qreal(0), m_view.top(), full.height() - m_view.height()));
+}
+
+QPointF HeatMapWidget::cellAt(const QPoint& pos) const
+{
+    return QPointF(m_view.left() + pos.x() * m_view.width() / width(),
+                   m_view.top() + pos.y() * m_view.height() / height());
+}
+
+void HeatMapWidget::paintEvent(QPaintEvent* /*event*/)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().base());
+    if (m_image.isNull()) {
+        return;
+    }
+    // nearest neighbor scaling keeps single expensive cells visible when zoomed in
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, false);
+    painter.drawImage(QRectF(rect()), m_image, m_view);
+}
+
+void HeatMapWidget::wheelEvent(QWheelEvent* event)
+{
+    if (m_image.isNull()) {
+        return;
+    }
+    // zoom around the cell under the cursor
+    const QPointF center = cellAt(event->pos());
+    const qreal factor = event->delta() > 0 ? 0.8 : 1.25;
+    m_view = QRectF(center.x() - (center.x() - m_view.left()) * factor,
+                    center.y() - (center.y() - m_view.top()) * factor,
+                    m_view.width() * factor, m_view.height() * factor);
+    clampView();
+    update();
+    event->accept();
+}
+
+void HeatMapWidget::mousePressEvent(QMouseEvent* event)
+{
+    if (event->button() == Qt::LeftButton) {
+        m_pressPos = event->pos();
+        m_lastPos = event->pos();
+        m_dragging = false;
+    }
+    QWidget::mousePressEvent(event);
+}
+
+void HeatMapWidget::mouseMoveEvent(QMouseEvent* event)
+{
+    if (event->buttons() & Qt::LeftButton) {
+        if ((event->pos() - m_pressPos).manhattanLength() > 3) {
+            m_dragging = true;
+        }
+        if (m_dragging) {
+            const QPoint delta = event->pos() - m_lastPos;
+            m_view.translate(-delta.x() * m_view.width() / width(), -delta.y() * m_view.height() / height());
+            clampView();
+            update();
+        }
+        m_lastPos = event->pos();
+    }
+    QWidget::mouseMoveEvent(event);
+}
+
+void HeatMapWidget::mouseReleaseEvent(QMouseEvent* event)
+{
+    if (event->button() == Qt::LeftButton && !m_dragging && m_map && rect().contains(event->pos())) {
+        const QPointF cell = cellAt(event->pos());
+        emit cellClicked(int(cell.y()), int(cell.x()));
+    }
+    m_dragging = false;
+    QWidget::mouseReleaseEvent(event);
+}
+
+bool HeatMapWidget::event(QEvent* event)
+{
+    if (event->type() == QEvent::ToolTip) {
+        QHelpEvent* helpEvent = static_cast<QHelpEvent*>(event);
+        if (!m_map || m_image.isNull()) {
+            QToolTip::hideText();
+            return true;
+        }
+        const QPointF cell = cellAt(helpEvent->pos());
+        const int row = qBound(0, int(cell.y()), m_map->rowCount() - 1);
+        const int column = qBound(0, int(cell.x()), m_map->columnCount() - 1);
+        const TimeSeriesIndex* index = m_map->seriesIndex();
+        const SnapshotItem* snapshot = index->snapshots().at(column);
+        QToolTip::showText(helpEvent->globalPos(),
+                           i18n("<dl><dt>cost:</dt><dd>%1 in snapshot #%2</dd>"
+                                "<dt>function:</dt><dd>%3</dd></dl>",
+                                prettyCost(m_map->cost(row, column)), snapshot->number(),
+                                Qt::escape(prettyLabel(index->label(m_map->labelForRow(row))))),
+                           this);
+        return true;
+    }
+    return QWidget::event(event);
+}
+
+#include "heatmapwidget.moc"
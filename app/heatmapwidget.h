@@ -0,0 +1,82 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MASSIF_HEATMAPWIDGET_H
+#define MASSIF_HEATMAPWIDGET_H
+
+#include <QtGui/QWidget>
+#include <QtGui/QImage>
+
+namespace Massif {
+
+class HeatMap;
+
+/**
+ * Shows a HeatMap, zoomable with the mouse wheel and pannable by dragging.
+ */
+class HeatMapWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    HeatMapWidget(QWidget* parent = 0);
+    virtual ~HeatMapWidget();
+
+    /**
+     * Show @p map, which must outlive this widget or be reset with zero.
+     */
+    void setHeatMap(const HeatMap* map);
+
+    /**
+     * Show the whole map again.
+     */
+    void resetZoom();
+
+signals:
+    /**
+     * Emitted when the cell at @p row and @p column of the heat map got clicked.
+     */
+    void cellClicked(int row, int column);
+
+protected:
+    virtual void paintEvent(QPaintEvent* event);
+    virtual void wheelEvent(QWheelEvent* event);
+    virtual void mousePressEvent(QMouseEvent* event);
+    virtual void mouseMoveEvent(QMouseEvent* event);
+    virtual void mouseReleaseEvent(QMouseEvent* event);
+    virtual bool event(QEvent* event);
+
+private:
+    /// maps widget coordinates to cell coordinates of the heat map
+    QPointF cellAt(const QPoint& pos) const;
+    void clampView();
+
+    const HeatMap* m_map;
+    QImage m_image;
+    // visible part of the map in cell coordinates
+    QRectF m_view;
+    QPoint m_pressPos;
+    QPoint m_lastPos;
+    bool m_dragging;
+};
+
+}
+
+#endif // MASSIF_HEATMAPWIDGET_H
@@ -31,6 +31,7 @@
 
 #include "massifdata/filedata.h"
 #include "massifdata/parser.h"
+#include "massifdata/filemerger.h"
 #include "massifdata/snapshotitem.h"
 #include "massifdata/treeleafitem.h"
 
@@ -39,6 +40,19 @@
 #include "visualizer/datatreemodel.h"
 #include "visualizer/filtereddatatreemodel.h"
 #include "visualizer/dotgraphgenerator.h"
+#include "visualizer/deltatreegenerator.h"
+#include "visualizer/deltatreemodel.h"
+#include "visualizer/timeseriesindex.h"
+#include "visualizer/trendanalyzer.h"
+#include "visualizer/trendmodel.h"
+#include "visualizer/componentcostmodel.h"
+#include "visualizer/callertreegenerator.h"
+#include "visualizer/callertreemodel.h"
+#include "flamegraphwidget.h"
+#include "treemapwidget.h"
+#include "visualizer/heatmap.h"
+#include "visualizer/sparklinedelegate.h"
+#include "visualizer/recursionfolder.h"
 #include "visualizer/util.h"
 
 #include "massif-visualizer-settings.h"
@@ -49,6 +63,7 @@
 #include <KAction>
 #include <KFileDialog>
 #include <KRecentFilesAction>
+#include <KSelectAction>
 #include <KMimeType>
 #include <KFilterDev>
 #include <KMessageBox>
@@ -58,12 +73,16 @@
 #include <KParts/Part>
 #include <KLibFactory>
 #include <KLibLoader>
+#include <KTemporaryFile>
 
 #include <QSortFilterProxyModel>
 #include <QStringListModel>
 #include <QLabel>
 #include <QSpinBox>
 #include <QInputDialog>
+#include <QMouseEvent>
+#include <QRubberBand>
+#include <QThread>
 
 #include <KDebug>
 
@@ -110,6 +129,24 @@ KConfigGroup allocatorConfig()
     return KGlobal::config()->group("Allocators");
 }
 
+KConfigGroup componentRulesConfig()
+{
+    return KGlobal::config()->group("ComponentRules");
+}
+
+// rules are stored as two lists, since the first matching rule wins
+QList<ComponentGrouper::Rule> componentRules()
+{
+    const KConfigGroup cfg = componentRulesConfig();
+    const QStringList patterns = cfg.readEntry("Patterns", QStringList());
+    const QStringList components = cfg.readEntry("Components", QStringList());
+    QList<ComponentGrouper::Rule> rules;
+    for (int i = 0; i < qMin(patterns.size(), components.size()); ++i) {
+        rules << qMakePair(patterns.at(i), components.at(i));
+    }
+    return rules;
+}
+
 //END Helper Functions
 
 MainWindow::MainWindow(QWidget* parent, Qt::WindowFlags f)
@@ -123,7 +160,6 @@ MainWindow::MainWindow(QWidget* parent, Qt::WindowFlags f)
     , m_legend(new Legend(m_chart))
     , m_dataTreeModel(new DataTreeModel(m_chart))
     , m_dataTreeFilterModel(new FilteredDataTreeModel(m_dataTreeModel))
-    , m_data(0)
     , m_selectPeak(0)
     , m_recentFiles(0)
     , m_changingSelections(false)
@@ -131,6 +167,7 @@ MainWindow::MainWindow(QWidget* parent, Qt::WindowFlags f)
     , m_graphViewerPart(0)
     , m_graphViewer(0)
     , m_dotGenerator(0)
+    , m_dotFile(0)
 #endif
     , m_zoomIn(0)
     , m_zoomOut(0)
@@ -140,6 +177,31 @@ MainWindow::MainWindow(QWidget* parent, Qt::WindowFlags f)
     , m_newAllocator(0)
     , m_removeAllocator(0)
     , m_shortenTemplates(0)
+    , m_deltaTreeModel(new DeltaTreeModel(this))
+    , m_deltaGenerator(0)
+    , m_deltaBase(0)
+    , m_setDeltaBase(0)
+    , m_compareWithDeltaBase(0)
+    , m_trendModel(new TrendModel(this))
+    , m_trendAnalyzer(0)
+    , m_showTrendInChart(0)
+    , m_showTrendInTree(0)
+    , m_componentCostModel(new ComponentCostModel(m_chart))
+    , m_groupBy(0)
+    , m_addComponentRule(0)
+    , m_clearComponentRules(0)
+    , m_callerTreeModel(new CallerTreeModel(this))
+    , m_callerGenerator(0)
+    , m_showCallerTree(0)
+    , m_showCallerTreeRange(0)
+    , m_heatMap(new HeatMap)
+    , m_sparklineDelegate(new SparklineDelegate(this))
+    , m_timeWindowBand(0)
+    , m_hasTimeWindow(false)
+    , m_rankBy(0)
+    , m_resetRanking(0)
+    , m_recursionFolder(0)
+    , m_collapseRecursion(0)
 {
     ui.setupUi(this);
 
@@ -152,6 +214,9 @@ MainWindow::MainWindow(QWidget* parent, Qt::WindowFlags f)
     connect(m_chart, SIGNAL(customContextMenuRequested(QPoint)),
             this, SLOT(chartContextMenuRequested(QPoint)));
     m_chart->setContextMenuPolicy(Qt::CustomContextMenu);
+    // shift + drag selects a time window
+    m_chart->installEventFilter(this);
+    m_timeWindowBand = new QRubberBand(QRubberBand::Rectangle, m_chart);
 
     m_legend->setPosition(Position(KDChartEnums::PositionFloating));
     m_legend->setTitleText("");
@@ -182,6 +247,9 @@ MainWindow::MainWindow(QWidget* parent, Qt::WindowFlags f)
             m_graphViewer = qobject_cast< KGraphViewer::KGraphViewerInterface* >(m_graphViewerPart);
             ui.dotGraphTab->layout()->addWidget(m_graphViewerPart->widget());
             connect(m_graphViewerPart, SIGNAL(graphLoaded()), this, SLOT(slotGraphLoaded()));
+            m_dotGenerator = new DotGraphGenerator(this);
+            connect(m_dotGenerator, SIGNAL(graphReady()), this, SLOT(dotGraphReady()));
+            m_dotGenerator->start();
             haveGraphViewer = true;
         }
     }
@@ -191,6 +259,7 @@ MainWindow::MainWindow(QWidget* parent, Qt::WindowFlags f)
     connect(ui.filterDataTree, SIGNAL(textChanged(QString)),
             m_dataTreeFilterModel, SLOT(setFilter(QString)));
     ui.dataTreeView->setModel(m_dataTreeFilterModel);
+    ui.dataTreeView->setItemDelegate(m_sparklineDelegate);
     connect(ui.dataTreeView->selectionModel(), SIGNAL(currentChanged(QModelIndex,QModelIndex)),
             this, SLOT(treeSelectionChanged(QModelIndex,QModelIndex)));
 
@@ -223,6 +292,51 @@ MainWindow::MainWindow(QWidget* parent, Qt::WindowFlags f)
     ui.allocatorView->setContextMenuPolicy(Qt::CustomContextMenu);
     //END custom allocators
 
+    //BEGIN snapshot delta
+    tabifyDockWidget(ui.dataTreeDock, ui.deltaDock);
+    ui.deltaTreeView->setModel(m_deltaTreeModel);
+    ui.deltaLabel->setText(i18n("Use the context menu of a snapshot to compare it with another one."));
+    //END snapshot delta
+
+    //BEGIN growth trends
+    tabifyDockWidget(ui.dataTreeDock, ui.trendDock);
+    ui.trendView->setModel(m_trendModel);
+    ui.trendView->sortByColumn(TrendModel::GrowthColumn, Qt::DescendingOrder);
+    connect(ui.trendView, SIGNAL(customContextMenuRequested(QPoint)),
+            this, SLOT(trendContextMenuRequested(QPoint)));
+    connect(ui.trendView, SIGNAL(doubleClicked(QModelIndex)),
+            this, SLOT(slotShowTrendInTree()));
+    ui.trendView->setContextMenuPolicy(Qt::CustomContextMenu);
+    //END growth trends
+
+    //BEGIN allocating functions
+    tabifyDockWidget(ui.dataTreeDock, ui.callerDock);
+    ui.callerTreeView->setModel(m_callerTreeModel);
+    ui.callerLabel->setText(i18n("Use the context menu of a snapshot to merge its allocating functions."));
+    //END allocating functions
+
+    //BEGIN heat map
+    tabifyDockWidget(ui.dataTreeDock, ui.heatMapDock);
+    connect(ui.heatMapOrder, SIGNAL(currentIndexChanged(int)),
+            this, SLOT(updateHeatMap()));
+    connect(ui.heatMapView, SIGNAL(cellClicked(int,int)),
+            this, SLOT(heatMapCellClicked(int,int)));
+    //END heat map
+
+    //BEGIN icicle graph
+    tabifyDockWidget(ui.dataTreeDock, ui.flameGraphDock);
+    ui.flameGraphLabel->setText(i18n("Double click a frame to zoom into it, press Escape to zoom out."));
+    connect(ui.flameGraphView, SIGNAL(nodeClicked(Massif::TreeLeafItem*)),
+            this, SLOT(snapshotViewNodeClicked(Massif::TreeLeafItem*)));
+    //END icicle graph
+
+    //BEGIN tree map
+    tabifyDockWidget(ui.dataTreeDock, ui.treeMapDock);
+    ui.treeMapLabel->setText(i18n("Double click a tile to zoom into it, press Escape to zoom out."));
+    connect(ui.treeMapView, SIGNAL(nodeClicked(Massif::TreeLeafItem*)),
+            this, SLOT(snapshotViewNodeClicked(Massif::TreeLeafItem*)));
+    //END tree map
+
     setupActions();
     setupGUI(StandardWindowOptions(Default ^ StatusBar));
     statusBar()->hide();
@@ -252,6 +366,20 @@ MainWindow::MainWindow(QWidget* parent, Qt::WindowFlags f)
 MainWindow::~MainWindow()
 {
     m_recentFiles->saveEntries(KGlobal::config()->group( QString() ));
+    ui.heatMapView->setHeatMap(0);
+    delete m_heatMap;
+#ifdef HAVE_KGRAPHVIEWER
+    if (m_dotGenerator) {
+        m_dotGenerator->stop();
+    }
+    delete m_dotFile;
+#endif
+    // canceled workers delete themselves once done, but they are still our
+    // children and must not get destroyed while running
+    foreach (QThread* worker, findChildren<QThread*>()) {
+        worker->wait();
+    }
+    delete m_recursionFolder;
 }
 
 void MainWindow::setupActions()
@@ -259,6 +387,10 @@ void MainWindow::setupActions()
     KAction* openFile = KStandardAction::open(this, SLOT(openFile()), actionCollection());
     KAction* reload = KStandardAction::redisplay(this, SLOT(reload()), actionCollection());
     actionCollection()->addAction("file_reload", reload);
+    KAction* mergeFiles = new KAction(KIcon("document-open"), i18n("Open and Merge..."), actionCollection());
+    mergeFiles->setToolTip(i18n("open the output of multiple processes, e.g. forked workers, as a single file"));
+    connect(mergeFiles, SIGNAL(triggered()), this, SLOT(openFiles()));
+    actionCollection()->addAction("file_merge", mergeFiles);
     m_recentFiles = KStandardAction::openRecent(this, SLOT(openFile(KUrl)), actionCollection());
     m_recentFiles->loadEntries(KGlobal::config()->group( QString() ));
 
@@ -275,6 +407,13 @@ void MainWindow::setupActions()
     connect(m_shortenTemplates, SIGNAL(toggled(bool)), SLOT(slotShortenTemplates(bool)));
     actionCollection()->addAction("shorten_templates", m_shortenTemplates);
 
+    m_collapseRecursion = new KAction(KIcon("format-indent-less"), i18n("Collapse Recursion"), actionCollection());
+    m_collapseRecursion->setToolTip(i18n("fold recursive calls of the same function into a single node"));
+    m_collapseRecursion->setCheckable(true);
+    m_collapseRecursion->setChecked(Settings::collapseRecursion());
+    connect(m_collapseRecursion, SIGNAL(toggled(bool)), SLOT(slotCollapseRecursion(bool)));
+    actionCollection()->addAction("collapse_recursion", m_collapseRecursion);
+
     m_toggleTotal = new KAction(KIcon("office-chart-area"), i18n("Toggle total cost graph"), actionCollection());
     m_toggleTotal->setCheckable(true);
     m_toggleTotal->setChecked(true);
@@ -314,7 +453,8 @@ void MainWindow::setupActions()
     stackNumLayout->addWidget(new QLabel(i18n("Stacked diagrams:")));
     QSpinBox* box = new QSpinBox;
     box->setMinimum(0);
-    box->setMaximum(50);
+    // the remaining functions are aggregated in a single dataset
+    box->setMaximum(9999);
     box->setValue(10);
     connect(box, SIGNAL(valueChanged(int)), this, SLOT(setStackNum(int)));
     stackNumLayout->addWidget(box);
@@ -347,11 +487,93 @@ void MainWindow::setupActions()
     m_hideOtherFunctions = new KAction(i18n("hide other functions"), this);
     connect(m_hideOtherFunctions, SIGNAL(triggered()),
             this, SLOT(slotHideOtherFunctions()));
+    m_undoHideFunctions = new KAction(KIcon("edit-undo"), i18n("show last hidden functions"), this);
+    connect(m_undoHideFunctions, SIGNAL(triggered()),
+            this, SLOT(slotUndoHideFunctions()));
+    m_showAllFunctions = new KAction(i18n("show all functions"), this);
+    connect(m_showAllFunctions, SIGNAL(triggered()),
+            this, SLOT(slotShowAllFunctions()));
     //END hiding functions
 
+    //BEGIN snapshot delta
+    m_setDeltaBase = new KAction(i18n("use as base for comparison"), this);
+    connect(m_setDeltaBase, SIGNAL(triggered()),
+            this, SLOT(slotSetDeltaBase()));
+    m_compareWithDeltaBase = new KAction(i18n("compare with base snapshot"), this);
+    connect(m_compareWithDeltaBase, SIGNAL(triggered()),
+            this, SLOT(slotCompareWithDeltaBase()));
+    //END snapshot delta
+
+    //BEGIN growth trends
+    m_showTrendInChart = new KAction(i18n("show in chart"), ui.trendDock);
+    connect(m_showTrendInChart, SIGNAL(triggered()),
+            this, SLOT(slotShowTrendInChart()));
+    m_showTrendInTree = new KAction(i18n("show in tree"), ui.trendDock);
+    connect(m_showTrendInTree, SIGNAL(triggered()),
+            this, SLOT(slotShowTrendInTree()));
+    //END growth trends
+
+    //BEGIN component grouping
+    m_groupBy = new KSelectAction(KIcon("view-group"), i18n("Group by"), actionCollection());
+    m_groupBy->setToolTip(i18n("aggregate the detailed cost graph per component"));
+    // keep in sync with slotGroupByComponent
+    m_groupBy->setItems(QStringList()
+        << i18n("Functions")
+        << i18n("Shared Objects")
+        << i18n("Source Directories")
+        << i18n("Custom Rules"));
+    m_groupBy->setCurrentItem(0);
+    m_groupBy->setEnabled(false);
+    connect(m_groupBy, SIGNAL(triggered(int)), this, SLOT(slotGroupByComponent(int)));
+    actionCollection()->addAction("groupBy", m_groupBy);
+
+    m_addComponentRule = new KAction(KIcon("list-add"), i18n("Add Component Rule..."), actionCollection());
+    connect(m_addComponentRule, SIGNAL(triggered()), this, SLOT(slotAddComponentRule()));
+    actionCollection()->addAction("addComponentRule", m_addComponentRule);
+
+    m_clearComponentRules = new KAction(KIcon("edit-clear-list"), i18n("Clear Component Rules"), actionCollection());
+    m_clearComponentRules->setEnabled(componentRulesConfig().exists());
+    connect(m_clearComponentRules, SIGNAL(triggered()), this, SLOT(slotClearComponentRules()));
+    actionCollection()->addAction("clearComponentRules", m_clearComponentRules);
+    //END component grouping
+
+    //BEGIN time window ranking
+    m_rankBy = new KSelectAction(KIcon("view-sort-descending"), i18n("Rank Time Window by"), actionCollection());
+    m_rankBy->setToolTip(i18n("order the stacked functions by their cost in the time window "
+                              "selected with Shift + drag in the chart"));
+    // keep in sync with TimeWindowIndex::Ranking
+    m_rankBy->setItems(QStringList()
+        << i18n("Peak Cost")
+        << i18n("Average Cost"));
+    m_rankBy->setCurrentItem(0);
+    connect(m_rankBy, SIGNAL(triggered(int)), this, SLOT(slotRankTimeWindow()));
+    actionCollection()->addAction("rankBy", m_rankBy);
+
+    m_resetRanking = new KAction(KIcon("view-refresh"), i18n("Reset Ranking"), actionCollection());
+    m_resetRanking->setToolTip(i18n("order the stacked functions by their global peak cost again"));
+    m_resetRanking->setEnabled(false);
+    connect(m_resetRanking, SIGNAL(triggered()), this, SLOT(slotResetRanking()));
+    actionCollection()->addAction("resetRanking", m_resetRanking);
+    //END time window ranking
+
+    //BEGIN allocating functions
+    m_showCallerTree = new KAction(i18n("show allocating functions"), this);
+    connect(m_showCallerTree, SIGNAL(triggered()),
+            this, SLOT(slotShowCallerTree()));
+    m_showCallerTreeRange = new KAction(i18n("show allocating functions since base snapshot"), this);
+    connect(m_showCallerTreeRange, SIGNAL(triggered()),
+            this, SLOT(slotShowCallerTreeRange()));
+    //END allocating functions
+
     //dock actions
     actionCollection()->addAction("toggleDataTree", ui.dataTreeDock->toggleViewAction());
     actionCollection()->addAction("toggleAllocators", ui.allocatorDock->toggleViewAction());
+    actionCollection()->addAction("toggleDeltaTree", ui.deltaDock->toggleViewAction());
+    actionCollection()->addAction("toggleTrends", ui.trendDock->toggleViewAction());
+    actionCollection()->addAction("toggleCallerTree", ui.callerDock->toggleViewAction());
+    actionCollection()->addAction("toggleHeatMap", ui.heatMapDock->toggleViewAction());
+    actionCollection()->addAction("toggleFlameGraph", ui.flameGraphDock->toggleViewAction());
+    actionCollection()->addAction("toggleTreeMap", ui.treeMapDock->toggleViewAction());
 
     //open page actions
     ui.openFile->setDefaultAction(openFile);
@@ -379,6 +601,7 @@ void MainWindow::settingsChanged()
     }
 
     Settings::self()->writeConfig();
+    reloadFormatSettings();
     updateHeader();
     updatePeaks();
     ui.dataTreeView->viewport()->update();
@@ -394,9 +617,72 @@ void MainWindow::openFile()
     }
 }
 
+void MainWindow::openFiles()
+{
+    const KUrl::List files = KFileDialog::getOpenUrls(KUrl("kfiledialog:///massif-visualizer"),
+                                                      QString("application/x-valgrind-massif"),
+                                                      this, i18n("Open Massif Output Files to Merge"));
+    if (!files.isEmpty()) {
+        openFiles(files);
+    }
+}
+
+void MainWindow::openFiles(const KUrl::List& files)
+{
+    Q_ASSERT(!files.isEmpty());
+    QList<QIODevice*> devices;
+    foreach (const KUrl& file, files) {
+        QIODevice* device = KFilterDev::deviceForFile(file.toLocalFile());
+        if (!device->open(QIODevice::ReadOnly)) {
+            KMessageBox::error(this, i18n("Could not open file <i>%1</i> for reading.", file.toLocalFile()), i18n("Could Not Read File"));
+            delete device;
+            qDeleteAll(devices);
+            return;
+        }
+        devices << device;
+    }
+    setUpdatesEnabled(false);
+    if (m_data) {
+        closeFile();
+    }
+    FileMerger merger;
+    merger.setMinimumCost(Settings::minimumCost(), Settings::minimumCostPercentage());
+    FileData* data = merger.merge(devices, m_allocatorModel->stringList());
+    qDeleteAll(devices);
+    if (!data) {
+        const QString file = files.at(merger.errorFile()).toLocalFile();
+        if (merger.errorLine() == -1) {
+            KMessageBox::error(this, i18n("The file <i>%1</i> uses a different time unit than the other files.", file),
+                               i18n("Could Not Merge Files"));
+        } else {
+            KMessageBox::error(this, i18n("Could not parse file <i>%1</i>.<br>"
+                                          "Parse error in line %2:<br>%3", file, merger.errorLine() + 1, merger.errorLineString()),
+                               i18n("Could Not Parse File"));
+        }
+        setUpdatesEnabled(true);
+        return;
+    } else if (data->snapshots().isEmpty()) {
+        KMessageBox::error(this, i18n("The files contain no data."), i18n("Empty Data File"));
+        delete data;
+        setUpdatesEnabled(true);
+        return;
+    }
+    m_mergedFiles = files;
+
+    kDebug() << "merged massif files:" << files;
+    m_recursionFolder = new RecursionFolder(FileDataHandle(data));
+    m_data = m_recursionFolder->data(Settings::collapseRecursion());
+    showData();
+
+    setUpdatesEnabled(true);
+}
+
 void MainWindow::reload()
 {
-    if (m_currentFile.isValid()) {
+    if (!m_mergedFiles.isEmpty()) {
+        // copy to prevent madness
+        openFiles(KUrl::List(m_mergedFiles));
+    } else if (m_currentFile.isValid()) {
         // copy to prevent madness
         openFile(KUrl(m_currentFile));
     }
@@ -416,29 +702,43 @@ void MainWindow::openFile(const KUrl& file)
         closeFile();
     }
     Parser p;
-    m_data = p.parse(device, m_allocatorModel->stringList());
-    if (!m_data) {
+    p.setMinimumCost(Settings::minimumCost(), Settings::minimumCostPercentage());
+    FileData* data = p.parse(device, m_allocatorModel->stringList());
+    if (!data) {
         KMessageBox::error(this, i18n("Could not parse file <i>%1</i>.<br>"
                                       "Parse error in line %2:<br>%3", file.toLocalFile(), p.errorLine() + 1, p.errorLineString()),
                            i18n("Could Not Parse File"));
         setUpdatesEnabled(true);
         return;
-    } else if (m_data->snapshots().isEmpty()) {
+    } else if (data->snapshots().isEmpty()) {
         KMessageBox::error(this, i18n("Empty data file <i>%1</i>.", file.toLocalFile()),
                            i18n("Empty Data File"));
-        delete m_data;
-        m_data = 0;
+        delete data;
         setUpdatesEnabled(true);
         return;
     }
     m_currentFile = file;
 
+    kDebug() << "loaded massif file:" << file;
+    m_recursionFolder = new RecursionFolder(FileDataHandle(data));
+    m_data = m_recursionFolder->data(Settings::collapseRecursion());
+    showData();
+
+    //BEGIN RecentFiles
+    m_recentFiles->addUrl(file);
+
+    delete device;
+
+    setUpdatesEnabled(true);
+}
+
+void MainWindow::showData()
+{
     Q_ASSERT(m_data->peak());
 
     m_close->setEnabled(true);
     ui.stackedWidget->setCurrentWidget(ui.displayPage);
 
-    kDebug() << "loaded massif file:" << file;
     qDebug() << "description:" << m_data->description();
     qDebug() << "command:" << m_data->cmd();
     qDebug() << "time unit:" << m_data->timeUnit();
@@ -479,7 +779,9 @@ void MainWindow::openFile(const KUrl& file)
         updateHeader();
     }
 
-    setWindowTitle(i18n("Massif Visualizer - evaluation of %1 (%2)", m_data->cmd(), file.fileName()));
+    const QString fileName = m_mergedFiles.isEmpty() ? m_currentFile.fileName()
+                           : i18np("%1 merged file", "%1 merged files", m_mergedFiles.size());
+    setWindowTitle(i18n("Massif Visualizer - evaluation of %1 (%2)", m_data->cmd(), fileName));
 
     //BEGIN TotalDiagram
     m_totalDiagram = new Plotter;
@@ -506,7 +808,7 @@ void MainWindow::openFile(const KUrl& file)
     leftAxis->setPosition ( CartesianAxis::Left );
     m_totalDiagram->addAxis(leftAxis);
 
-    m_totalCostModel->setSource(m_data);
+    m_totalCostModel->setSource(m_data.data());
     m_totalDiagram->setModel(m_totalCostModel);
 
     m_chart->coordinatePlane()->addDiagram(m_totalDiagram);
@@ -520,8 +822,12 @@ void MainWindow::openFile(const KUrl& file)
     m_detailedDiagram->setAntiAliasing(true);
     m_detailedDiagram->setType(KDChart::Plotter::Stacked);
 
-    m_detailedCostModel->setSource(m_data);
+    m_detailedCostModel->setSource(m_data.data());
     m_detailedDiagram->setModel(m_detailedCostModel);
+    m_groupBy->setEnabled(true);
+    if (m_groupBy->currentItem() > 0) {
+        updateComponentModel();
+    }
 
     CartesianAxis* topAxis = new CartesianAxis(m_detailedDiagram);
     topAxis->setTextAttributes(axisTextAttributes);
@@ -549,15 +855,18 @@ void MainWindow::openFile(const KUrl& file)
     m_legend->show();
 
     //BEGIN TreeView
-    m_dataTreeModel->setSource(m_data);
+    m_dataTreeModel->setSource(m_data.data());
     m_selectPeak->setEnabled(true);
 
-    //BEGIN RecentFiles
-    m_recentFiles->addUrl(file);
-
-    delete device;
+    //BEGIN Icicle Graph
+    ui.flameGraphView->setSnapshot(m_data->peak());
+    ui.treeMapView->setSnapshot(m_data, m_data->peak());
 
-    setUpdatesEnabled(true);
+    //BEGIN Trends
+    m_trendAnalyzer = new TrendAnalyzer(m_data, this);
+    connect(m_trendAnalyzer, SIGNAL(finished()),
+            this, SLOT(trendsReady()));
+    m_trendAnalyzer->start();
 }
 
 void MainWindow::updateHeader()
@@ -568,6 +877,11 @@ void MainWindow::updateHeader()
                         .arg(i18n("Memory consumption of %1", app))
                         .arg(i18n("Peak of %1 at snapshot #%2", prettyCost(m_data->peak()->memHeap()), m_data->peak()->number()))
     );
+    if (m_hasTimeWindow) {
+        m_header->setText(m_header->text() + "<br />"
+                          + i18n("Functions ranked by cost between %1 and %2 %3",
+                                 m_timeWindow.first, m_timeWindow.second, m_data->timeUnit()));
+    }
     m_header->setToolTip(i18n("Command: %1\nValgrind Options: %2", m_data->cmd(), m_data->description()));
 }
 
@@ -587,12 +901,15 @@ void MainWindow::treeSelectionChanged(const QModelIndex& now, const QModelIndex&
     );
 
     if (now.parent().isValid()) {
-        m_detailedCostModel->setSelection(m_detailedCostModel->indexForItem(item));
+        if (!isGroupedByComponent()) {
+            m_detailedCostModel->setSelection(m_detailedCostModel->indexForItem(item));
+        }
         m_totalCostModel->setSelection(QModelIndex());
     } else {
         m_totalCostModel->setSelection(m_totalCostModel->indexForItem(item));
         m_detailedCostModel->setSelection(QModelIndex());
     }
+    updateSnapshotViews(item);
 
     m_chart->update();
 #ifdef HAVE_KGRAPHVIEWER
@@ -612,19 +929,27 @@ void MainWindow::detailedItemClicked(const QModelIndex& idx)
 
     m_changingSelections = true;
 
-    m_detailedCostModel->setSelection(idx);
     m_totalCostModel->setSelection(QModelIndex());
 
     // hack: the ToolTip will only be queried by KDChart and that one uses the
     // left index, but we want it to query the right one
-    const QModelIndex _idx = m_detailedCostModel->index(idx.row() + 1, idx.column(), idx.parent());
+    QPair< TreeLeafItem*, SnapshotItem* > item(0, 0);
+    if (isGroupedByComponent()) {
+        m_componentCostModel->setSelection(idx);
+        // components have no node in the tree, select the snapshot instead
+        item.second = m_componentCostModel->snapshotForRow(idx.row() + 1);
+    } else {
+        m_detailedCostModel->setSelection(idx);
+        const QModelIndex _idx = m_detailedCostModel->index(idx.row() + 1, idx.column(), idx.parent());
+        item = m_detailedCostModel->itemForIndex(_idx);
+    }
     ui.dataTreeView->selectionModel()->clearSelection();
-    QPair< TreeLeafItem*, SnapshotItem* > item = m_detailedCostModel->itemForIndex(_idx);
     const QModelIndex& newIndex = m_dataTreeFilterModel->mapFromSource(
         m_dataTreeModel->indexForItem(item)
     );
     ui.dataTreeView->selectionModel()->setCurrentIndex(newIndex, QItemSelectionModel::Select | QItemSelectionModel::Rows);
     ui.dataTreeView->scrollTo(ui.dataTreeView->selectionModel()->currentIndex());
+    updateSnapshotViews(item);
 
     m_chart->update();
 #ifdef HAVE_KGRAPHVIEWER
@@ -647,6 +972,7 @@ void MainWindow::totalItemClicked(const QModelIndex& idx_)
     QModelIndex idx = idx_.model()->index(idx_.row() + 1, idx_.column(), idx_.parent());
 
     m_detailedCostModel->setSelection(QModelIndex());
+    m_componentCostModel->setSelection(QModelIndex());
     m_totalCostModel->setSelection(idx);
 
     QPair< TreeLeafItem*, SnapshotItem* > item = m_totalCostModel->itemForIndex(idx);
@@ -657,6 +983,7 @@ void MainWindow::totalItemClicked(const QModelIndex& idx_)
     );
     ui.dataTreeView->selectionModel()->setCurrentIndex(newIndex, QItemSelectionModel::Select | QItemSelectionModel::Rows);
     ui.dataTreeView->scrollTo(ui.dataTreeView->selectionModel()->currentIndex());
+    updateSnapshotViews(item);
 
     m_chart->update();
 
@@ -669,19 +996,33 @@ void MainWindow::closeFile()
         return;
     }
 
+    kDebug() << "closing file";
+
+    resetViews();
+
+    // both variants of the data get deleted once no worker uses them anymore
+    delete m_recursionFolder;
+    m_recursionFolder = 0;
+    m_data.clear();
+    m_currentFile.clear();
+    m_mergedFiles.clear();
+
+    setWindowTitle(i18n("Massif Visualizer"));
+}
+
+void MainWindow::resetViews()
+{
 #ifdef HAVE_KGRAPHVIEWER
     if (m_dotGenerator) {
-        if (m_dotGenerator->isRunning()) {
-            disconnect(m_dotGenerator, 0, this, 0);
-            connect(m_dotGenerator, SIGNAL(finished()), m_dotGenerator, SLOT(deleteLater()));
-            m_dotGenerator->cancel();
-        } else {
-            delete m_dotGenerator;
-        }
-        m_dotGenerator = 0;
+        m_dotGenerator->cancel();
     }
+    m_dotGraph.clear();
+    m_dotGraphId.clear();
+    m_costlyGraphvizId.clear();
     if (m_graphViewer) {
         m_graphViewerPart->closeUrl();
+        delete m_dotFile;
+        m_dotFile = 0;
         m_zoomIn->setEnabled(false);
         m_zoomOut->setEnabled(false);
         m_focusExpensive->setEnabled(false);
@@ -690,15 +1031,31 @@ void MainWindow::closeFile()
     m_lastDotItem.second = 0;
 #endif
 
+    stopDeltaGenerator();
+    m_deltaTreeModel->setSource(0, 0, 0);
+    m_deltaBase = 0;
+
+    stopTrendAnalyzer();
+    // the heat map and sparklines refer to the index owned by the trend model
+    ui.heatMapView->setHeatMap(0);
+    m_sparklineDelegate->setSeriesIndex(0);
+    m_heatMap->setSource(0, QVector<Trend>(), HeatMap::ByPeak);
+    m_trendModel->setSource(0, QVector<Trend>());
+
+    stopCallerTreeGenerator();
+    m_callerTreeModel->setSource(0, 0, 0);
+    m_callerSnapshots.clear();
+
     m_close->setEnabled(false);
     ui.stackedWidget->setCurrentWidget(ui.openPage);
 
-    kDebug() << "closing file";
-
     m_chart->replaceCoordinatePlane(new CartesianCoordinatePlane);
     m_legend->removeDiagrams();
     m_legend->hide();
     m_header->setText("");
+    m_hasTimeWindow = false;
+    m_resetRanking->setEnabled(false);
+    m_timeWindowBand->hide();
 
     m_toggleDetailed->setEnabled(false);
     m_toggleDetailed->setChecked(true);
@@ -710,18 +1067,16 @@ void MainWindow::closeFile()
     delete m_totalDiagram;
     m_totalDiagram = 0;
 
+    ui.flameGraphView->setSnapshot(0);
+    ui.treeMapView->setSnapshot(FileDataHandle(), 0);
     m_dataTreeModel->setSource(0);
     m_dataTreeFilterModel->setFilter("");
     m_detailedCostModel->setSource(0);
+    m_componentCostModel->setSource(0);
+    m_groupBy->setEnabled(false);
     m_totalCostModel->setSource(0);
 
     m_selectPeak->setEnabled(false);
-
-    delete m_data;
-    m_data = 0;
-    m_currentFile.clear();
-
-    setWindowTitle(i18n("Massif Visualizer"));
 }
 
 Chart* MainWindow::chart()
@@ -772,54 +1127,72 @@ void MainWindow::getDotGraph(QPair<TreeLeafItem*, SnapshotItem*> item)
     m_lastDotItem = item;
 
     Q_ASSERT(m_graphViewer);
+    Q_ASSERT(m_dotGenerator);
 
-    kDebug() << "new dot graph requested" << item;
-    if (m_dotGenerator) {
-        kDebug() << "existing generator is running:" << m_dotGenerator->isRunning();
-        if (m_dotGenerator->isRunning()) {
-            disconnect(m_dotGenerator, 0, this, 0);
-            connect(m_dotGenerator, SIGNAL(finished()), m_dotGenerator, SLOT(deleteLater()));
-            m_dotGenerator->cancel();
-        } else {
-            delete m_dotGenerator;
-        }
-        m_dotGenerator = 0;
-    }
+    // requests that come in quickly, e.g. while scrolling through the tree, get coalesced
+    m_dotGraph.clear();
     if (!item.first && !item.second) {
-        return;
-    }
-    if (item.second) {
-        m_dotGenerator = new DotGraphGenerator(item.second, m_data->timeUnit(), this);
+        m_dotGenerator->cancel();
+    } else if (item.second) {
+        m_dotGenerator->requestGraph(m_data, item.second, m_data->timeUnit());
     } else {
-        m_dotGenerator = new DotGraphGenerator(item.first, m_data->timeUnit(), this);
+        m_dotGenerator->requestGraph(m_data, item.first, m_data->timeUnit());
     }
-    connect(m_dotGenerator, SIGNAL(finished()),
-            this, SLOT(showDotGraph()));
-    m_dotGenerator->start();
+}
+
+void MainWindow::dotGraphReady()
+{
+    QByteArray graph;
+    QString costlyGraphvizId;
+    // the request might have been replaced in the meantime
+    if (!m_dotGenerator->takeGraph(&graph, &costlyGraphvizId)) {
+        return;
+    }
+    m_dotGraph = graph;
+    m_dotGraphId = costlyGraphvizId;
+    showDotGraph();
 }
 
 void MainWindow::showDotGraph()
 {
-    if (!m_dotGenerator || !m_graphViewerPart || !m_graphViewerPart->widget()->isVisible()) {
+    if (m_dotGraph.isEmpty() || !m_graphViewerPart || !m_graphViewerPart->widget()->isVisible()) {
         return;
     }
-    kDebug() << "show dot graph in output file" << m_dotGenerator->outputFile();
-    if (!m_dotGenerator->outputFile().isEmpty() && m_graphViewerPart->url() != KUrl(m_dotGenerator->outputFile())) {
-        m_graphViewerPart->openUrl(KUrl(m_dotGenerator->outputFile()));
+
+    // the part might report the loaded graph right away
+    m_costlyGraphvizId = m_dotGraphId;
+    const QString mimeType = QLatin1String("text/vnd.graphviz");
+    if (m_graphViewerPart->openStream(mimeType, KUrl("callgraph.dot"))) {
+        m_graphViewerPart->writeStream(m_dotGraph);
+        m_graphViewerPart->closeStream();
+    } else {
+        // the part can only load files
+        KTemporaryFile* file = new KTemporaryFile;
+        file->setSuffix(QLatin1String(".dot"));
+        if (!file->open() || file->write(m_dotGraph) != m_dotGraph.size() || !file->flush()) {
+            kWarning() << "could not create temp file for writing Dot-graph";
+            delete file;
+            return;
+        }
+        kDebug() << "show dot graph in output file" << file->fileName();
+        m_graphViewerPart->openUrl(KUrl(file->fileName()));
+        delete m_dotFile;
+        m_dotFile = file;
     }
+    m_dotGraph.clear();
 }
 
 void MainWindow::slotGraphLoaded()
 {
     Q_ASSERT(m_graphViewer);
 
-    if (!m_dotGenerator) {
+    if (m_costlyGraphvizId.isEmpty()) {
         return;
     }
     m_graphViewer->setZoomFactor(0.75);
     m_graphViewer->setPannerPosition(KGraphViewer::KGraphViewerInterface::BottomRight);
     m_graphViewer->setPannerEnabled(true);
-    m_graphViewer->centerOnNode(m_dotGenerator->mostCostIntensiveGraphvizId());
+    m_graphViewer->centerOnNode(m_costlyGraphvizId);
 }
 
 void MainWindow::zoomIn()
@@ -840,7 +1213,7 @@ void MainWindow::focusExpensiveGraphNode()
 {
     Q_ASSERT(m_graphViewer);
 
-    m_graphViewer->centerOnNode(m_dotGenerator->mostCostIntensiveGraphvizId());
+    m_graphViewer->centerOnNode(m_costlyGraphvizId);
 }
 
 #endif
@@ -880,6 +1253,11 @@ void MainWindow::updatePeaks()
 
 void MainWindow::updateDetailedPeaks()
 {
+    if (isGroupedByComponent()) {
+        // components have no single peak node that could be marked
+        return;
+    }
+
     KColorScheme scheme(QPalette::Active, KColorScheme::Window);
     QPen foreground(scheme.foreground().color());
 
@@ -966,15 +1344,23 @@ void MainWindow::dataTreeContextMenuRequested(const QPoint& pos)
         return;
     }
 
+    QMenu menu;
     if (!idx.parent().isValid()) {
         // snapshot item
-        return;
+        SnapshotItem* snapshot = m_dataTreeModel->itemForIndex(idx).second;
+        Q_ASSERT(snapshot);
+        if (!snapshot->heapTree()) {
+            return;
+        }
+        menu.setTitle(i18n("Snapshot #%1", snapshot->number()));
+        prepareSnapshotActions(&menu, snapshot);
+    } else {
+        TreeLeafItem* item = m_dataTreeModel->itemForIndex(idx).first;
+        Q_ASSERT(item);
+        prepareActions(&menu, item);
+        menu.addSeparator();
+        prepareSnapshotActions(&menu, m_dataTreeModel->snapshotForTreeLeaf(item));
     }
-
-    QMenu menu;
-    TreeLeafItem* item = m_dataTreeModel->itemForIndex(idx).first;
-    Q_ASSERT(item);
-    prepareActions(&menu, item);
     menu.exec(ui.dataTreeView->mapToGlobal(pos));
 }
 
@@ -986,24 +1372,41 @@ void MainWindow::chartContextMenuRequested(const QPoint& pos)
     if (!idx.isValid()) {
         return;
     }
+    if (isGroupedByComponent()) {
+        QMenu menu;
+        prepareSnapshotActions(&menu, m_componentCostModel->snapshotForRow(idx.row() + 1));
+        if (!menu.isEmpty()) {
+            menu.exec(m_detailedDiagram->mapToGlobal(dPos));
+        }
+        return;
+    }
     // hack: the ToolTip will only be queried by KDChart and that one uses the
     // left index, but we want it to query the right one
     const QModelIndex _idx = m_detailedCostModel->index(idx.row() + 1, idx.column(), idx.parent());
     QPair< TreeLeafItem*, SnapshotItem* > item = m_detailedCostModel->itemForIndex(_idx);
 
     if (!item.first) {
+        // e.g. the other functions
+        if (m_detailedCostModel->hasHiddenFunctions()) {
+            QMenu menu;
+            menu.addAction(m_undoHideFunctions);
+            menu.addAction(m_showAllFunctions);
+            menu.exec(m_detailedDiagram->mapToGlobal(dPos));
+        }
         return;
     }
 
     QMenu menu;
     menu.addAction(m_markCustomAllocator);
     prepareActions(&menu, item.first);
+    menu.addSeparator();
+    prepareSnapshotActions(&menu, m_dataTreeModel->snapshotForTreeLeaf(item.first));
     menu.exec(m_detailedDiagram->mapToGlobal(dPos));
 }
 
 void MainWindow::prepareActions(QMenu* menu, TreeLeafItem* item)
 {
-    QString func = functionInLabel(item->label());
+    QString func = functionInLabel(item);
     if (func.length() > 40) {
         func.resize(40);
         func.append("...");
@@ -1018,6 +1421,36 @@ void MainWindow::prepareActions(QMenu* menu, TreeLeafItem* item)
 
     m_hideOtherFunctions->setData(QVariant::fromValue(item));
     menu->addAction(m_hideOtherFunctions);
+
+    if (m_detailedCostModel->hasHiddenFunctions()) {
+        menu->addAction(m_undoHideFunctions);
+        menu->addAction(m_showAllFunctions);
+    }
+}
+
+void MainWindow::prepareSnapshotActions(QMenu* menu, SnapshotItem* snapshot)
+{
+    if (!snapshot) {
+        return;
+    }
+
+    m_setDeltaBase->setData(QVariant::fromValue(snapshot));
+    menu->addAction(m_setDeltaBase);
+
+    if (m_deltaBase && m_deltaBase != snapshot) {
+        m_compareWithDeltaBase->setText(i18n("compare with snapshot #%1", m_deltaBase->number()));
+        m_compareWithDeltaBase->setData(QVariant::fromValue(snapshot));
+        menu->addAction(m_compareWithDeltaBase);
+    }
+
+    m_showCallerTree->setData(QVariant::fromValue(snapshot));
+    menu->addAction(m_showCallerTree);
+
+    if (m_deltaBase && m_deltaBase != snapshot) {
+        m_showCallerTreeRange->setText(i18n("show allocating functions averaged from snapshot #%1", m_deltaBase->number()));
+        m_showCallerTreeRange->setData(QVariant::fromValue(snapshot));
+        menu->addAction(m_showCallerTreeRange);
+    }
 }
 
 void MainWindow::slotHideFunction()
@@ -1030,6 +1463,36 @@ void MainWindow::slotHideOtherFunctions()
     m_detailedCostModel->hideOtherFunctions(m_hideOtherFunctions->data().value<TreeLeafItem*>());
 }
 
+void MainWindow::slotUndoHideFunctions()
+{
+    m_detailedCostModel->undoHide();
+}
+
+void MainWindow::slotShowAllFunctions()
+{
+    m_detailedCostModel->showAllFunctions();
+}
+
+void MainWindow::slotCollapseRecursion(bool collapse)
+{
+    if (collapse != Settings::self()->collapseRecursion()) {
+        Settings::self()->setCollapseRecursion(collapse);
+        Settings::self()->writeConfig();
+    }
+
+    if (!m_data || m_recursionFolder->data(collapse) == m_data) {
+        return;
+    }
+
+    setUpdatesEnabled(false);
+    // the other variant has its own tree items, workers still reading the
+    // current one keep it alive until they are done
+    resetViews();
+    m_data = m_recursionFolder->data(collapse);
+    showData();
+    setUpdatesEnabled(true);
+}
+
 void MainWindow::slotShortenTemplates(bool shorten)
 {
     if (shorten == Settings::self()->shortenTemplates()) {
@@ -1040,4 +1503,497 @@ void MainWindow::slotShortenTemplates(bool shorten)
     settingsChanged();
 }
 
+void MainWindow::slotSetDeltaBase()
+{
+    m_deltaBase = m_setDeltaBase->data().value<SnapshotItem*>();
+    Q_ASSERT(m_deltaBase);
+    ui.deltaLabel->setText(i18n("Base for comparison: snapshot #%1", m_deltaBase->number()));
+}
+
+void MainWindow::slotCompareWithDeltaBase()
+{
+    SnapshotItem* snapshot = m_compareWithDeltaBase->data().value<SnapshotItem*>();
+    Q_ASSERT(snapshot);
+    Q_ASSERT(m_deltaBase);
+
+    // always compare the earlier snapshot against the later one
+    if (m_data->snapshots().indexOf(snapshot) < m_data->snapshots().indexOf(m_deltaBase)) {
+        compareSnapshots(snapshot, m_deltaBase);
+    } else {
+        compareSnapshots(m_deltaBase, snapshot);
+    }
+}
+
+void MainWindow::stopDeltaGenerator()
+{
+    if (!m_deltaGenerator) {
+        return;
+    }
+    if (m_deltaGenerator->isRunning()) {
+        disconnect(m_deltaGenerator, 0, this, 0);
+        connect(m_deltaGenerator, SIGNAL(finished()), m_deltaGenerator, SLOT(deleteLater()));
+        m_deltaGenerator->cancel();
+    } else {
+        delete m_deltaGenerator;
+    }
+    m_deltaGenerator = 0;
+}
+
+void MainWindow::compareSnapshots(SnapshotItem* before, SnapshotItem* after)
+{
+    stopDeltaGenerator();
+
+    ui.deltaLabel->setText(i18n("Comparing snapshot #%1 with #%2...", before->number(), after->number()));
+    ui.deltaDock->show();
+    ui.deltaDock->raise();
+
+    m_deltaGenerator = new DeltaTreeGenerator(m_data, before, after, this);
+    connect(m_deltaGenerator, SIGNAL(finished()),
+            this, SLOT(deltaTreeReady()));
+    m_deltaGenerator->start();
+}
+
+void MainWindow::deltaTreeReady()
+{
+    if (!m_deltaGenerator) {
+        return;
+    }
+
+    const SnapshotItem* before = m_deltaGenerator->before();
+    const SnapshotItem* after = m_deltaGenerator->after();
+    m_deltaTreeModel->setSource(m_deltaGenerator->takeResult(), before, after);
+    ui.deltaLabel->setText(i18n("Heap cost changed by %1 from snapshot #%2 to #%3.",
+                                prettyCostDelta(long(after->memHeap()) - long(before->memHeap())),
+                                before->number(), after->number()));
+    ui.deltaTreeView->expand(m_deltaTreeModel->index(0, 0));
+
+    m_deltaGenerator->deleteLater();
+    m_deltaGenerator = 0;
+}
+
+void MainWindow::stopTrendAnalyzer()
+{
+    if (!m_trendAnalyzer) {
+        return;
+    }
+    if (m_trendAnalyzer->isRunning()) {
+        disconnect(m_trendAnalyzer, 0, this, 0);
+        connect(m_trendAnalyzer, SIGNAL(finished()), m_trendAnalyzer, SLOT(deleteLater()));
+        m_trendAnalyzer->cancel();
+    } else {
+        delete m_trendAnalyzer;
+    }
+    m_trendAnalyzer = 0;
+}
+
+void MainWindow::trendsReady()
+{
+    if (!m_trendAnalyzer) {
+        return;
+    }
+
+    ui.heatMapView->setHeatMap(0);
+    m_sparklineDelegate->setSeriesIndex(0);
+    m_trendModel->setSource(m_trendAnalyzer->takeIndex(), m_trendAnalyzer->trends());
+    ui.trendView->resizeColumnToContents(TrendModel::FunctionColumn);
+    updateHeatMap();
+    m_sparklineDelegate->setSeriesIndex(m_trendModel->seriesIndex());
+    ui.dataTreeView->viewport()->update();
+
+    m_trendAnalyzer->deleteLater();
+    m_trendAnalyzer = 0;
+}
+
+void MainWindow::trendContextMenuRequested(const QPoint& pos)
+{
+    const QModelIndex idx = ui.trendView->indexAt(pos);
+    if (m_trendModel->labelForIndex(idx) == -1) {
+        return;
+    }
+
+    QMenu menu;
+    menu.addAction(m_showTrendInChart);
+    menu.addAction(m_showTrendInTree);
+    menu.exec(ui.trendView->mapToGlobal(pos));
+}
+
+void MainWindow::slotShowTrendInChart()
+{
+    const int label = m_trendModel->labelForIndex(ui.trendView->currentIndex());
+    if (label == -1 || !m_detailedDiagram) {
+        return;
+    }
+
+    const TimeSeriesIndex* index = m_trendModel->seriesIndex();
+    QMap<SnapshotItem*, TreeLeafItem*> nodes;
+    for (int i = 0; i < index->snapshotCount(); ++i) {
+        if (TreeLeafItem* node = index->node(label, i)) {
+            nodes[index->snapshots().at(i)] = node;
+        }
+    }
+    if (nodes.isEmpty()) {
+        return;
+    }
+
+    if (isGroupedByComponent()) {
+        m_groupBy->setCurrentItem(0);
+        slotGroupByComponent(0);
+    }
+    m_detailedCostModel->showOnlyFunction(index->label(label), nodes);
+    updateDetailedPeaks();
+    showDetailedGraph(true);
+    if (ui.displayPage != ui.plotterTab) {
+        ui.tabWidget->setCurrentWidget(ui.plotterTab);
+    }
+}
+
+void MainWindow::slotShowTrendInTree()
+{
+    const int label = m_trendModel->labelForIndex(ui.trendView->currentIndex());
+    if (label == -1) {
+        return;
+    }
+
+    TreeLeafItem* node = m_trendModel->seriesIndex()->peakNode(label);
+    if (!node) {
+        return;
+    }
+
+    ui.dataTreeDock->show();
+    ui.dataTreeDock->raise();
+    selectInDataTree(node);
+}
+
+void MainWindow::slotShowCallerTree()
+{
+    SnapshotItem* snapshot = m_showCallerTree->data().value<SnapshotItem*>();
+    Q_ASSERT(snapshot);
+
+    showCallerTree(QList<SnapshotItem*>() << snapshot);
+}
+
+void MainWindow::slotShowCallerTreeRange()
+{
+    SnapshotItem* snapshot = m_showCallerTreeRange->data().value<SnapshotItem*>();
+    Q_ASSERT(snapshot);
+    Q_ASSERT(m_deltaBase);
+
+    int first = m_data->snapshots().indexOf(m_deltaBase);
+    int last = m_data->snapshots().indexOf(snapshot);
+    if (first > last) {
+        qSwap(first, last);
+    }
+    showCallerTree(m_data->snapshots().mid(first, last - first + 1));
+}
+
+void MainWindow::stopCallerTreeGenerator()
+{
+    if (!m_callerGenerator) {
+        return;
+    }
+    if (m_callerGenerator->isRunning()) {
+        disconnect(m_callerGenerator, 0, this, 0);
+        connect(m_callerGenerator, SIGNAL(finished()), m_callerGenerator, SLOT(deleteLater()));
+        m_callerGenerator->cancel();
+    } else {
+        delete m_callerGenerator;
+    }
+    m_callerGenerator = 0;
+}
+
+void MainWindow::showCallerTree(const QList<SnapshotItem*>& snapshots)
+{
+    stopCallerTreeGenerator();
+
+    ui.callerLabel->setText(i18n("Merging allocating functions..."));
+    ui.callerDock->show();
+    ui.callerDock->raise();
+
+    m_callerSnapshots = snapshots;
+    m_callerGenerator = new CallerTreeGenerator(m_data, snapshots, this);
+    if (m_groupBy->currentItem() != 0) {
+        m_callerGenerator->setGrouper(componentGrouper());
+    }
+    connect(m_callerGenerator, SIGNAL(finished()),
+            this, SLOT(callerTreeReady()));
+    m_callerGenerator->start();
+}
+
+void MainWindow::callerTreeReady()
+{
+    if (!m_callerGenerator) {
+        return;
+    }
+
+    const QList<SnapshotItem*> snapshots = m_callerGenerator->snapshots();
+    if (snapshots.isEmpty()) {
+        m_callerTreeModel->setSource(0, 0, 0);
+        ui.callerLabel->setText(i18n("There are no detailed snapshots to merge."));
+    } else {
+        m_callerTreeModel->setSource(m_callerGenerator->takeResult(), snapshots.first(), snapshots.last());
+        ui.callerLabel->setText(i18np("Merged the call sites of one detailed snapshot.",
+                                      "Merged the call sites of %1 detailed snapshots.",
+                                      snapshots.size()));
+    }
+
+    m_callerGenerator->deleteLater();
+    m_callerGenerator = 0;
+}
+
+void MainWindow::updateHeatMap()
+{
+    const TimeSeriesIndex* index = m_trendModel->seriesIndex();
+    if (!index) {
+        return;
+    }
+
+    ui.heatMapView->setHeatMap(0);
+    m_heatMap->setSource(index, m_trendModel->trends(),
+                         ui.heatMapOrder->currentIndex() == 1 ? HeatMap::ByGrowth : HeatMap::ByPeak);
+    ui.heatMapView->setHeatMap(m_heatMap);
+}
+
+void MainWindow::heatMapCellClicked(int row, int column)
+{
+    if (row < 0 || row >= m_heatMap->rowCount() || column < 0 || column >= m_heatMap->columnCount()) {
+        return;
+    }
+
+    TreeLeafItem* node = m_heatMap->seriesIndex()->node(m_heatMap->labelForRow(row), column);
+    if (!node) {
+        return;
+    }
+
+    selectInDataTree(node);
+}
+
+void MainWindow::snapshotViewNodeClicked(TreeLeafItem* node)
+{
+    selectInDataTree(node);
+}
+
+void MainWindow::selectInDataTree(TreeLeafItem* node)
+{
+    // make sure the node is not filtered out
+    ui.filterDataTree->clear();
+    ui.dataTreeView->selectionModel()->clearSelection();
+    const QModelIndex& newIndex = m_dataTreeFilterModel->mapFromSource(
+        m_dataTreeModel->indexForTreeLeaf(node)
+    );
+    ui.dataTreeView->selectionModel()->setCurrentIndex(newIndex, QItemSelectionModel::Select | QItemSelectionModel::Rows);
+    ui.dataTreeView->scrollTo(ui.dataTreeView->selectionModel()->currentIndex());
+}
+
+void MainWindow::updateSnapshotViews(const QPair<TreeLeafItem*, SnapshotItem*>& item)
+{
+    if (item.first) {
+        SnapshotItem* snapshot = m_dataTreeModel->snapshotForTreeLeaf(item.first);
+        ui.flameGraphView->setSnapshot(snapshot);
+        ui.flameGraphView->setSelection(item.first);
+        ui.treeMapView->setSnapshot(m_data, snapshot);
+        ui.treeMapView->setSelection(item.first);
+    } else if (item.second && item.second->heapTree()) {
+        ui.flameGraphView->setSnapshot(item.second);
+        ui.flameGraphView->setSelection(0);
+        ui.treeMapView->setSnapshot(m_data, item.second);
+        ui.treeMapView->setSelection(0);
+    }
+}
+
+bool MainWindow::isGroupedByComponent() const
+{
+    return m_detailedDiagram && m_detailedDiagram->model() == m_componentCostModel;
+}
+
+void MainWindow::updateComponentModel()
+{
+    Q_ASSERT(m_data);
+    Q_ASSERT(m_detailedDiagram);
+
+    m_componentCostModel->setSource(m_data.data(), componentGrouper());
+    m_detailedDiagram->setModel(m_componentCostModel);
+}
+
+ComponentGrouper MainWindow::componentGrouper() const
+{
+    ComponentGrouper::Mode mode;
+    switch (m_groupBy->currentItem()) {
+        case 1:
+            mode = ComponentGrouper::ByObject;
+            break;
+        case 2:
+            mode = ComponentGrouper::BySourceDirectory;
+            break;
+        default:
+            mode = ComponentGrouper::ByRules;
+            break;
+    }
+
+    return ComponentGrouper(mode, mode == ComponentGrouper::ByRules ? componentRules() : QList<ComponentGrouper::Rule>());
+}
+
+void MainWindow::slotGroupByComponent(int mode)
+{
+    if (!m_data || !m_detailedDiagram) {
+        return;
+    }
+
+    m_changingSelections = true;
+    if (mode == 0) {
+        m_componentCostModel->setSource(0);
+        m_detailedDiagram->setModel(m_detailedCostModel);
+        updateDetailedPeaks();
+    } else {
+        updateComponentModel();
+    }
+    m_changingSelections = false;
+
+    showDetailedGraph(true);
+
+    if (!m_callerSnapshots.isEmpty()) {
+        // the caller tree is grouped the same way
+        showCallerTree(m_callerSnapshots);
+    }
+}
+
+void MainWindow::slotAddComponentRule()
+{
+    const QString pattern = QInputDialog::getText(this, i18n("Add Component Rule"),
+                                                  i18n("regular expression for functions or locations, e.g. ^KDevelop::"));
+    if (pattern.isEmpty()) {
+        return;
+    }
+    if (!QRegExp(pattern, Qt::CaseSensitive, QRegExp::RegExp2).isValid()) {
+        KMessageBox::sorry(this, i18n("%1 is not a valid regular expression.", pattern));
+        return;
+    }
+    const QString component = QInputDialog::getText(this, i18n("Add Component Rule"),
+                                                    i18n("component for %1:", pattern));
+    if (component.isEmpty()) {
+        return;
+    }
+
+    KConfigGroup cfg = componentRulesConfig();
+    cfg.writeEntry("Patterns", cfg.readEntry("Patterns", QStringList()) << pattern);
+    cfg.writeEntry("Components", cfg.readEntry("Components", QStringList()) << component);
+    cfg.sync();
+    m_clearComponentRules->setEnabled(true);
+
+    if (m_data) {
+        m_groupBy->setCurrentItem(3);
+        slotGroupByComponent(3);
+    }
+}
+
+void MainWindow::slotClearComponentRules()
+{
+    KConfigGroup cfg = componentRulesConfig();
+    cfg.deleteGroup();
+    cfg.sync();
+    m_clearComponentRules->setEnabled(false);
+
+    if (m_data && m_groupBy->currentItem() == 3) {
+        slotGroupByComponent(3);
+    }
+}
+
+double MainWindow::timeForChartPosition(const QPoint& pos) const
+{
+    if (!m_data || !m_detailedDiagram) {
+        return -1;
+    }
+    const CartesianCoordinatePlane* plane = qobject_cast<CartesianCoordinatePlane*>(m_chart->coordinatePlane());
+    if (!plane) {
+        return -1;
+    }
+    // the plane is linear, translate two known times into diagram coordinates and interpolate
+    const double lastTime = m_data->snapshots().last()->time();
+    const qreal x0 = plane->translate(QPointF(0, 0)).x();
+    const qreal x1 = plane->translate(QPointF(lastTime, 0)).x();
+    if (qFuzzyCompare(x0, x1)) {
+        return -1;
+    }
+    const QPoint dPos = m_detailedDiagram->mapFromGlobal(m_chart->mapToGlobal(pos));
+    return qMax(0.0, (dPos.x() - x0) / (x1 - x0) * lastTime);
+}
+
+bool MainWindow::eventFilter(QObject* object, QEvent* event)
+{
+    if (object != m_chart || !m_detailedDiagram || isGroupedByComponent()) {
+        return KParts::MainWindow::eventFilter(object, event);
+    }
+
+    switch (event->type()) {
+        case QEvent::MouseButtonPress: {
+            QMouseEvent* mouseEvent = static_cast<QMouseEvent*>(event);
+            if (mouseEvent->button() == Qt::LeftButton && mouseEvent->modifiers() & Qt::ShiftModifier) {
+                m_timeWindowOrigin = mouseEvent->pos();
+                m_timeWindowBand->setGeometry(QRect(m_timeWindowOrigin.x(), 0, 1, m_chart->height()));
+                m_timeWindowBand->show();
+                return true;
+            }
+            break;
+        }
+        case QEvent::MouseMove: {
+            if (m_timeWindowBand->isVisible()) {
+                QMouseEvent* mouseEvent = static_cast<QMouseEvent*>(event);
+                const int left = qMin(m_timeWindowOrigin.x(), mouseEvent->pos().x());
+                const int right = qMax(m_timeWindowOrigin.x(), mouseEvent->pos().x());
+                m_timeWindowBand->setGeometry(QRect(left, 0, right - left + 1, m_chart->height()));
+                return true;
+            }
+            break;
+        }
+        case QEvent::MouseButtonRelease: {
+            if (m_timeWindowBand->isVisible()) {
+                QMouseEvent* mouseEvent = static_cast<QMouseEvent*>(event);
+                m_timeWindowBand->hide();
+                const double t0 = timeForChartPosition(m_timeWindowOrigin);
+                const double t1 = timeForChartPosition(mouseEvent->pos());
+                if (t0 >= 0 && t1 >= 0) {
+                    m_timeWindow = qMakePair(qMin(t0, t1), qMax(t0, t1));
+                    m_hasTimeWindow = true;
+                    slotRankTimeWindow();
+                }
+                return true;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    return KParts::MainWindow::eventFilter(object, event);
+}
+
+void MainWindow::slotRankTimeWindow()
+{
+    if (!m_data || !m_hasTimeWindow) {
+        return;
+    }
+
+    const TimeWindowIndex::Ranking ranking = static_cast<TimeWindowIndex::Ranking>(m_rankBy->currentItem());
+    if (!m_detailedCostModel->rankByTimeWindow(m_timeWindow.first, m_timeWindow.second, ranking)) {
+        // no detailed snapshot in the window, keep the current order
+        m_hasTimeWindow = false;
+        return;
+    }
+    m_resetRanking->setEnabled(true);
+    updateHeader();
+    updateDetailedPeaks();
+    m_chart->update();
+}
+
+void MainWindow::slotResetRanking()
+{
+    m_hasTimeWindow = false;
+    m_resetRanking->setEnabled(false);
+    if (!m_data) {
+        return;
+    }
+    m_detailedCostModel->resetRanking();
+    updateHeader();
+    updateDetailedPeaks();
+    m_chart->update();
+}
+
 #include "mainwindow.moc"
@@ -25,8 +25,11 @@
 
 #include "ui_mainwindow.h"
 
+#include "massifdata/filedata.h"
+
 class QStringListModel;
 class QLabel;
+class QRubberBand;
 
 namespace KDChart {
 class Chart;
@@ -43,6 +46,8 @@ class ReadOnlyPart;
 
 class KAction;
 class KRecentFilesAction;
+class KTemporaryFile;
+class KSelectAction;
 
 namespace KGraphViewer {
 
@@ -52,12 +57,22 @@ class KGraphViewerInterface;
 
 namespace Massif {
 
-class FileData;
 class DetailedCostModel;
 class TotalCostModel;
 class DataTreeModel;
 class FilteredDataTreeModel;
 class DotGraphGenerator;
+class DeltaTreeModel;
+class DeltaTreeGenerator;
+class TrendModel;
+class TrendAnalyzer;
+class ComponentCostModel;
+class ComponentGrouper;
+class CallerTreeModel;
+class CallerTreeGenerator;
+class HeatMap;
+class SparklineDelegate;
+class RecursionFolder;
 class SnapshotItem;
 class TreeLeafItem;
 
@@ -73,6 +88,9 @@ public:
 
     void setupActions();
 
+protected:
+    virtual bool eventFilter(QObject* object, QEvent* event);
+
 public slots:
     /**
      * Open a dialog to pick a massif output file to display.
@@ -84,6 +102,16 @@ public slots:
      */
     void openFile(const KUrl& file);
 
+    /**
+     * Open a dialog to pick multiple massif output files which get merged.
+     */
+    void openFiles();
+
+    /**
+     * Opens all @p files, e.g. of forked processes, and visualizes them merged as a single file.
+     */
+    void openFiles(const KUrl::List& files);
+
     /**
      * reload currently opened file
      */
@@ -115,6 +143,7 @@ private slots:
     void setStackNum(int num);
 
 #ifdef HAVE_KGRAPHVIEWER
+    void dotGraphReady();
     void showDotGraph();
     void slotTabChanged(int index);
     void slotGraphLoaded();
@@ -136,15 +165,61 @@ private slots:
 
     void slotHideFunction();
     void slotHideOtherFunctions();
+    void slotUndoHideFunctions();
+    void slotShowAllFunctions();
 
     void slotShortenTemplates(bool);
+    void slotCollapseRecursion(bool collapse);
+
+    void slotSetDeltaBase();
+    void slotCompareWithDeltaBase();
+    void deltaTreeReady();
+
+    void trendsReady();
+    void trendContextMenuRequested(const QPoint &pos);
+    void slotShowTrendInChart();
+    void slotShowTrendInTree();
+
+    void slotGroupByComponent(int mode);
+    void slotAddComponentRule();
+    void slotClearComponentRules();
+
+    void slotShowCallerTree();
+    void slotShowCallerTreeRange();
+    void callerTreeReady();
+
+    void updateHeatMap();
+    void heatMapCellClicked(int row, int column);
+
+    void snapshotViewNodeClicked(Massif::TreeLeafItem* node);
+
+    void slotRankTimeWindow();
+    void slotResetRanking();
 
 private:
     void getDotGraph(QPair<TreeLeafItem*, SnapshotItem*> item);
+    void compareSnapshots(SnapshotItem* before, SnapshotItem* after);
+    void stopDeltaGenerator();
+    void stopTrendAnalyzer();
+    void showCallerTree(const QList<SnapshotItem*>& snapshots);
+    void stopCallerTreeGenerator();
     void updateHeader();
+    /// shows m_data in all views
+    void showData();
+    /// removes m_data from all views, without deleting it
+    void resetViews();
     void updatePeaks();
     void updateDetailedPeaks();
     void prepareActions(QMenu* menu, TreeLeafItem* item);
+    void prepareSnapshotActions(QMenu* menu, SnapshotItem* snapshot);
+    bool isGroupedByComponent() const;
+    void selectInDataTree(TreeLeafItem* node);
+    void updateSnapshotViews(const QPair<TreeLeafItem*, SnapshotItem*>& item);
+    void updateComponentModel();
+    /// @return The grouper for the component grouping selected by the user
+    ComponentGrouper componentGrouper() const;
+    /// @return The time at the x-coordinate of @p pos in the chart, or -1 if it is not known.
+    double timeForChartPosition(const QPoint& pos) const;
 
     Ui::MainWindow ui;
     KDChart::Chart* m_chart;
@@ -161,8 +236,11 @@ private:
 
     DataTreeModel* m_dataTreeModel;
     FilteredDataTreeModel* m_dataTreeFilterModel;
-    FileData* m_data;
+    // shared with the background workers, which might still run after the file got closed
+    FileDataHandle m_data;
     KUrl m_currentFile;
+    // the files that are shown merged, if any
+    KUrl::List m_mergedFiles;
     KAction* m_selectPeak;
 
     KRecentFilesAction* m_recentFiles;
@@ -173,6 +251,13 @@ private:
     KGraphViewer::KGraphViewerInterface* m_graphViewer;
     DotGraphGenerator* m_dotGenerator;
     QPair<TreeLeafItem*, SnapshotItem*> m_lastDotItem;
+    // the latest generated graph, until it is shown
+    QByteArray m_dotGraph;
+    QString m_dotGraphId;
+    // the GraphViz node ID of the most cost-intensive item in the shown graph
+    QString m_costlyGraphvizId;
+    // the file the shown graph was loaded from, if it could not be streamed
+    KTemporaryFile* m_dotFile;
 #endif
     KAction* m_zoomIn;
     KAction* m_zoomOut;
@@ -186,8 +271,47 @@ private:
 
     KAction* m_hideFunction;
     KAction* m_hideOtherFunctions;
+    KAction* m_undoHideFunctions;
+    KAction* m_showAllFunctions;
 
     KAction* m_shortenTemplates;
+
+    DeltaTreeModel* m_deltaTreeModel;
+    DeltaTreeGenerator* m_deltaGenerator;
+    SnapshotItem* m_deltaBase;
+    KAction* m_setDeltaBase;
+    KAction* m_compareWithDeltaBase;
+
+    TrendModel* m_trendModel;
+    TrendAnalyzer* m_trendAnalyzer;
+    KAction* m_showTrendInChart;
+    KAction* m_showTrendInTree;
+
+    ComponentCostModel* m_componentCostModel;
+    KSelectAction* m_groupBy;
+    KAction* m_addComponentRule;
+    KAction* m_clearComponentRules;
+
+    CallerTreeModel* m_callerTreeModel;
+    CallerTreeGenerator* m_callerGenerator;
+    // snapshots merged into the caller tree, to regroup it
+    QList<SnapshotItem*> m_callerSnapshots;
+    KAction* m_showCallerTree;
+    KAction* m_showCallerTreeRange;
+
+    HeatMap* m_heatMap;
+    SparklineDelegate* m_sparklineDelegate;
+
+    // time window selection in the chart, to rank the stacked functions
+    QRubberBand* m_timeWindowBand;
+    QPoint m_timeWindowOrigin;
+    QPair<double, double> m_timeWindow;
+    bool m_hasTimeWindow;
+    KSelectAction* m_rankBy;
+    KAction* m_resetRanking;
+
+    RecursionFolder* m_recursionFolder;
+    KAction* m_collapseRecursion;
 };
 
 }
@@ -0,0 +1,250 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "treemapwidget.h"
+
+#include "massifdata/snapshotitem.h"
+#include "massifdata/treeleafitem.h"
+
+#include "visualizer/callertreegenerator.h"
+#include "visualizer/util.h"
+
+#include <QtGui/QPainter>
+#include <QtGui/QMouseEvent>
+#include <QtGui/QKeyEvent>
+#include <QtGui/QHelpEvent>
+#include <QtGui/QToolTip>
+#include <QtCore/QTimer>
+
+using namespace Massif;
+
+TreeMapWidget::TreeMapWidget(QWidget* parent)
+    : QWidget(parent), m_snapshot(0), m_zoom(0), m_selection(0), m_layouter(0)
+    , m_relayoutTimer(new QTimer(this))
+{
+    m_relayoutTimer->setSingleShot(true);
+    m_relayoutTimer->setInterval(100);
+    connect(m_relayoutTimer, SIGNAL(timeout()), this, SLOT(relayout()));
+
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setFocusPolicy(Qt::ClickFocus);
+    setMinimumSize(100, 100);
+}
+
+TreeMapWidget::~TreeMapWidget()
+{
+    stopLayouter();
+}
+
+void TreeMapWidget::setSnapshot(const FileDataHandle& data, SnapshotItem* snapshot)
+{
+    if (snapshot == m_snapshot && data == m_data) {
+        return;
+    }
+    m_data = snapshot ? data : FileDataHandle();
+    m_snapshot = snapshot;
+    m_zoom = snapshot ? snapshot->heapTree() : 0;
+    m_selection = 0;
+    relayout();
+}
+
+void TreeMapWidget::setSelection(TreeLeafItem* node)
+{
+    m_selection = node;
+    if (node && m_zoom) {
+        // zoom out if the node is not below the zoomed tile
+        TreeLeafItem* parent = node;
+        while (parent && parent != m_zoom) {
+            parent = parent->parent();
+        }
+        if (!parent) {
+            zoomInto(m_snapshot ? m_snapshot->heapTree() : 0);
+            return;
+        }
+    }
+    update();
+}
+
+void TreeMapWidget::zoomInto(TreeLeafItem* node)
+{
+    if (!node || node == m_zoom) {
+        return;
+    }
+    m_zoom = node;
+    relayout();
+}
+
+void TreeMapWidget::stopLayouter()
+{
+    if (!m_layouter) {
+        return;
+    }
+    if (m_layouter->isRunning()) {
+        disconnect(m_layouter, 0, this, 0);
+        connect(m_layouter, SIGNAL(finished()), m_layouter, SLOT(deleteLater()));
+        m_layouter->cancel();
+    } else {
+        delete m_layouter;
+    }
+    m_layouter = 0;
+}
+
+void TreeMapWidget::relayout()
+{
+    m_relayoutTimer->stop();
+    stopLayouter();
+    m_tiles.clear();
+    m_cache = QPixmap(size());
+    m_cache.fill(palette().color(QPalette::Base));
+    update();
+
+    if (!m_zoom || size().isEmpty()) {
+        return;
+    }
+
+    m_layouter = new TreeMapLayouter(m_data, m_zoom, QRectF(rect()), 4, 64, this);
+    connect(m_layouter, SIGNAL(levelFinished()),
+            this, SLOT(levelFinished()), Qt::QueuedConnection);
+    m_layouter->start();
+}
+
+void TreeMapWidget::levelFinished()
+{
+    if (!m_layouter) {
+        return;
+    }
+    const QVector<TreeMapTile> tiles = m_layouter->takeTiles();
+    if (tiles.isEmpty()) {
+        return;
+    }
+    m_tiles += tiles;
+    paintTiles(tiles);
+    update();
+}
+
+void TreeMapWidget::paintTiles(const QVector<TreeMapTile>& tiles)
+{
+    QPainter painter(&m_cache);
+    const QColor border = palette().color(QPalette::Dark);
+    const int textHeight = fontMetrics().height();
+    foreach (const TreeMapTile& tile, tiles) {
+        // stable colors per function, deeper levels get brighter
+        const uint hash = qHash(CallerTreeGenerator::functionKey(tile.node));
+        const QColor color = QColor::fromHsv(hash % 360, 90 + hash % 60, qMin(255, 160 + tile.depth * 25));
+        painter.setPen(border);
+        painter.setBrush(color);
+        painter.drawRect(tile.rect);
+        // labels of parents get covered by their children, if those are laid out
+        if (tile.rect.width() > 40 && tile.rect.height() > textHeight + 2) {
+            painter.setPen(Qt::black);
+            painter.drawText(tile.rect.adjusted(2, 1, -2, -1), Qt::AlignLeft | Qt::AlignTop,
+                             fontMetrics().elidedText(functionInLabel(tile.node), Qt::ElideRight,
+                                                      int(tile.rect.width()) - 4));
+        }
+    }
+}
+
+void TreeMapWidget::paintEvent(QPaintEvent* /*event*/)
+{
+    QPainter painter(this);
+    if (m_cache.size() != size()) {
+        painter.fillRect(rect(), palette().base());
+    }
+    painter.drawPixmap(0, 0, m_cache);
+
+    if (m_selection) {
+        // the selection is the only thing not in the cache
+        foreach (const TreeMapTile& tile, m_tiles) {
+            if (tile.node == m_selection) {
+                painter.setPen(QPen(palette().color(QPalette::Highlight), 3));
+                painter.setBrush(Qt::NoBrush);
+                painter.drawRect(tile.rect.adjusted(1, 1, -1, -1));
+                break;
+            }
+        }
+    }
+}
+
+void TreeMapWidget::resizeEvent(QResizeEvent* event)
+{
+    QWidget::resizeEvent(event);
+    m_relayoutTimer->start();
+}
+
+const TreeMapTile* TreeMapWidget::tileAt(const QPoint& pos) const
+{
+    // tiles are ordered by depth, so the last hit is the deepest one
+    for (int i = m_tiles.size() - 1; i >= 0; --i) {
+        if (m_tiles.at(i).rect.contains(pos)) {
+            return &m_tiles.at(i);
+        }
+    }
+    return 0;
+}
+
+void TreeMapWidget::mouseReleaseEvent(QMouseEvent* event)
+{
+    if (event->button() == Qt::LeftButton) {
+        if (const TreeMapTile* tile = tileAt(event->pos())) {
+            m_selection = tile->node;
+            update();
+            emit nodeClicked(tile->node);
+        }
+    }
+    QWidget::mouseReleaseEvent(event);
+}
+
+void TreeMapWidget::mouseDoubleClickEvent(QMouseEvent* event)
+{
+    if (event->button() == Qt::LeftButton) {
+        if (const TreeMapTile* tile = tileAt(event->pos())) {
+            zoomInto(tile->node);
+        }
+    }
+    QWidget::mouseDoubleClickEvent(event);
+}
+
+void TreeMapWidget::keyPressEvent(QKeyEvent* event)
+{
+    if (event->key() == Qt::Key_Escape && m_zoom && m_zoom->parent()) {
+        // zoom out one level
+        zoomInto(m_zoom->parent());
+        event->accept();
+        return;
+    }
+    QWidget::keyPressEvent(event);
+}
+
+bool TreeMapWidget::event(QEvent* event)
+{
+    if (event->type() == QEvent::ToolTip) {
+        QHelpEvent* helpEvent = static_cast<QHelpEvent*>(event);
+        const TreeMapTile* tile = tileAt(helpEvent->pos());
+        if (tile && m_snapshot) {
+            QToolTip::showText(helpEvent->globalPos(), tooltipForTreeLeaf(tile->node, m_snapshot, tile->node->label()), this);
+        } else {
+            QToolTip::hideText();
+        }
+        return true;
+    }
+    return QWidget::event(event);
+}
+
+#include "treemapwidget.moc"
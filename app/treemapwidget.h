@@ -0,0 +1,106 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MASSIF_TREEMAPWIDGET_H
+#define MASSIF_TREEMAPWIDGET_H
+
+#include <QtGui/QWidget>
+#include <QtGui/QPixmap>
+#include <QtCore/QVector>
+
+class QTimer;
+
+#include "visualizer/treemaplayouter.h"
+
+namespace Massif {
+
+class SnapshotItem;
+class TreeLeafItem;
+
+/**
+ * Shows the heap tree of a snapshot as squarified tree map.
+ *
+ * The layout is computed on a TreeMapLayouter thread, tiles are painted
+ * into a cached pixmap as soon as a level is finished.
+ */
+class TreeMapWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    TreeMapWidget(QWidget* parent = 0);
+    virtual ~TreeMapWidget();
+
+    /**
+     * Show the heap tree of @p snapshot, or nothing if it is zero.
+     *
+     * @p data owns the snapshot and is kept alive while it is laid out.
+     */
+    void setSnapshot(const FileDataHandle& data, SnapshotItem* snapshot);
+
+    /**
+     * Highlight @p node, zooming out if it is not visible.
+     */
+    void setSelection(TreeLeafItem* node);
+
+    /**
+     * Lay out the subtree of @p node in the whole widget.
+     */
+    void zoomInto(TreeLeafItem* node);
+
+signals:
+    /**
+     * Emitted when the tile for @p node got clicked.
+     */
+    void nodeClicked(Massif::TreeLeafItem* node);
+
+protected:
+    virtual void paintEvent(QPaintEvent* event);
+    virtual void resizeEvent(QResizeEvent* event);
+    virtual void mouseReleaseEvent(QMouseEvent* event);
+    virtual void mouseDoubleClickEvent(QMouseEvent* event);
+    virtual void keyPressEvent(QKeyEvent* event);
+    virtual bool event(QEvent* event);
+
+private slots:
+    void levelFinished();
+    void relayout();
+
+private:
+    void stopLayouter();
+    void paintTiles(const QVector<TreeMapTile>& tiles);
+    /// @return The deepest tile at @p pos or zero
+    const TreeMapTile* tileAt(const QPoint& pos) const;
+
+    FileDataHandle m_data;
+    SnapshotItem* m_snapshot;
+    TreeLeafItem* m_zoom;
+    TreeLeafItem* m_selection;
+    TreeMapLayouter* m_layouter;
+    // delays the layout while resizing
+    QTimer* m_relayoutTimer;
+    // the layout so far, ordered by depth
+    QVector<TreeMapTile> m_tiles;
+    QPixmap m_cache;
+};
+
+}
+
+#endif // MASSIF_TREEMAPWIDGET_H
@@ -0,0 +1,102 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "costkernels.h"
+
+namespace Massif {
+
+namespace {
+/// number of independent lanes, enough for two 128bit or one 256bit register
+const int lanes = 4;
+}
+
+quint64 sumCosts(const quint64* costs, int size)
+{
+    quint64 sums[lanes] = {0, 0, 0, 0};
+    int i = 0;
+    for (; i + lanes <= size; i += lanes) {
+        for (int j = 0; j < lanes; ++j) {
+            sums[j] += costs[i + j];
+        }
+    }
+    quint64 sum = sums[0] + sums[1] + sums[2] + sums[3];
+    for (; i < size; ++i) {
+        sum += costs[i];
+    }
+    return sum;
+}
+
+quint64 maxCost(const quint64* costs, int size)
+{
+    quint64 maxima[lanes] = {0, 0, 0, 0};
+    int i = 0;
+    for (; i + lanes <= size; i += lanes) {
+        for (int j = 0; j < lanes; ++j) {
+            maxima[j] = qMax(maxima[j], costs[i + j]);
+        }
+    }
+    quint64 max = qMax(qMax(maxima[0], maxima[1]), qMax(maxima[2], maxima[3]));
+    for (; i < size; ++i) {
+        max = qMax(max, costs[i]);
+    }
+    return max;
+}
+
+int argMaxCost(const quint64* costs, int size)
+{
+    if (!size) {
+        return -1;
+    }
+    // finding the maximum vectorizes, finding its first occurrence is a short scan
+    return firstAtLeast(costs, size, maxCost(costs, size));
+}
+
+void prefixSums(const quint64* costs, int size, quint64* sums)
+{
+    quint64 sum = 0;
+    for (int i = 0; i < size; ++i) {
+        sum += costs[i];
+        sums[i] = sum;
+    }
+}
+
+int firstAtLeast(const quint64* costs, int size, quint64 threshold)
+{
+    // test whole blocks without branching and only scan the block with a hit
+    const int block = 4 * lanes;
+    int i = 0;
+    for (; i + block <= size; i += block) {
+        bool hit = false;
+        for (int j = 0; j < block; ++j) {
+            hit |= costs[i + j] >= threshold;
+        }
+        if (hit) {
+            break;
+        }
+    }
+    for (; i < size; ++i) {
+        if (costs[i] >= threshold) {
+            return i;
+        }
+    }
+    return size;
+}
+
+}
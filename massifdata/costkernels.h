@@ -0,0 +1,66 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MASSIF_COSTKERNELS_H
+#define MASSIF_COSTKERNELS_H
+
+#include <QtCore/QtGlobal>
+
+#include "massifdata_export.h"
+
+/**
+ * Aggregations over contiguous arrays of costs.
+ *
+ * The loops are written without data dependent branches where possible,
+ * such that the compiler can vectorize them.
+ */
+namespace Massif {
+
+/**
+ * @return The sum of the first @p size entries in @p costs.
+ */
+MASSIFDATA_EXPORT quint64 sumCosts(const quint64* costs, int size);
+
+/**
+ * @return The maximum of the first @p size entries in @p costs, zero if @p size is zero.
+ */
+MASSIFDATA_EXPORT quint64 maxCost(const quint64* costs, int size);
+
+/**
+ * @return The index of the first maximum in @p costs, -1 if @p size is zero.
+ */
+MASSIFDATA_EXPORT int argMaxCost(const quint64* costs, int size);
+
+/**
+ * Writes the inclusive prefix sums of @p costs to @p sums,
+ * i.e. sums[i] is the sum of costs[0] to costs[i].
+ * Both arrays must hold @p size entries, they may be the same.
+ */
+MASSIFDATA_EXPORT void prefixSums(const quint64* costs, int size, quint64* sums);
+
+/**
+ * @return The index of the first entry in @p costs which is at least @p threshold,
+ *         or @p size if there is none.
+ */
+MASSIFDATA_EXPORT int firstAtLeast(const quint64* costs, int size, quint64 threshold);
+
+}
+
+#endif // MASSIF_COSTKERNELS_H
@@ -20,18 +20,21 @@
 
 #include "filedata.h"
 #include "snapshotitem.h"
+#include "symboltable.h"
 
 #include <QtCore/QDebug>
 
 using namespace Massif;
 
-FileData::FileData(QObject* parent) : QObject(parent), m_peak(0)
+FileData::FileData(QObject* parent)
+    : QObject(parent), m_peak(0), m_symbols(new SymbolTable)
 {
 }
 
 FileData::~FileData()
 {
     qDeleteAll(m_snapshots);
+    delete m_symbols;
 }
 
 void FileData::setCmd(const QString& cmd)
@@ -84,3 +87,23 @@ SnapshotItem* FileData::peak() const
 {
     return m_peak;
 }
+
+void FileData::updateColumns()
+{
+    m_columns.build(m_snapshots);
+}
+
+const SnapshotColumns& FileData::columns() const
+{
+    return m_columns;
+}
+
+const SymbolTable* FileData::symbols() const
+{
+    return m_symbols;
+}
+
+SymbolTable* FileData::symbols()
+{
+    return m_symbols;
+}
@@ -22,12 +22,15 @@
 #define MASSIF_FILEDATA_H
 
 #include "massifdata_export.h"
+#include "snapshotcolumns.h"
 
 #include <QtCore/QObject>
+#include <QtCore/QSharedPointer>
 
 namespace Massif {
 
 class SnapshotItem;
+class SymbolTable;
 
 /**
  * This structure holds all information that can be extracted from a massif output file.
@@ -85,14 +88,48 @@ public:
      */
     SnapshotItem* peak() const;
 
+    /**
+     * Fills the columns with the current totals of all snapshots.
+     * This needs to be called whenever snapshots were added or changed,
+     * the parser does it once the file is read.
+     */
+    void updateColumns();
+    /**
+     * @return The times and totals of all snapshots in contiguous columns.
+     */
+    const SnapshotColumns& columns() const;
+
+    /**
+     * @return The table of all labels in this dataset.
+     */
+    const SymbolTable* symbols() const;
+    /**
+     * @return The table of all labels in this dataset, to add new ones while loading.
+     */
+    SymbolTable* symbols();
+
 private:
     QString m_cmd;
     QString m_description;
     QString m_timeUnit;
     QList<SnapshotItem*> m_snapshots;
     SnapshotItem* m_peak;
+    SymbolTable* m_symbols;
+    SnapshotColumns m_columns;
 };
 
+/**
+ * Shared, read only access to loaded data.
+ *
+ * Background workers can read the data concurrently without locking as long as
+ * they hold a handle. The data gets deleted when the last handle is released,
+ * which might happen on a worker thread after the GUI dropped its handle.
+ *
+ * The data is never changed after loading, folding recursions builds a copy
+ * with folded heap trees instead.
+ */
+typedef QSharedPointer<const FileData> FileDataHandle;
+
 }
 
 #endif // MASSIF_FILEDATA_H
@@ -0,0 +1,377 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "filemerger.h"
+
+#include "filedata.h"
+#include "parser.h"
+#include "snapshotitem.h"
+#include "symbol.h"
+#include "symboltable.h"
+#include "treeleafitem.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QIODevice>
+#include <QtCore/QRegExp>
+#include <QtCore/QVector>
+#include <QtCore/qalgorithms.h>
+#include <QtCore/QtConcurrentMap>
+
+using namespace Massif;
+
+namespace {
+
+/// massif writes a detailed snapshot every 10th snapshot by default
+const int detailedFrequency = 10;
+
+struct ParseJob
+{
+    QIODevice* file;
+    QStringList customAllocators;
+    unsigned long minimumCost;
+    double minimumPercentage;
+
+    FileData* data;
+    int errorLine;
+    QString errorLineString;
+};
+
+void parseFile(ParseJob& job)
+{
+    Parser parser;
+    parser.setMinimumCost(job.minimumCost, job.minimumPercentage);
+    job.data = parser.parse(job.file, job.customAllocators);
+    job.errorLine = parser.errorLine();
+    job.errorLineString = parser.errorLineString();
+}
+
+struct MergeJob
+{
+    QList<const TreeLeafItem*> roots;
+    // every job interns into its own table, which are merged afterwards
+    SymbolTable* symbols;
+    QHash<const Symbol*, const Symbol*> replacedSymbols;
+
+    TreeLeafItem* tree;
+};
+
+bool sortLeafsByCost(TreeLeafItem* l, TreeLeafItem* r)
+{
+    return l->cost() > r->cost();
+}
+
+TreeLeafItem* mergeNodes(const QList<const TreeLeafItem*>& nodes, SymbolTable* symbols,
+                         QRegExp& belowThreshold)
+{
+    Q_ASSERT(!nodes.isEmpty());
+
+    TreeLeafItem* merged = new TreeLeafItem;
+    const TreeLeafItem* first = nodes.first();
+    merged->setSymbol(first->symbol() ? symbols->insert(*first->symbol()) : symbols->symbol(first->label()));
+    unsigned long cost = 0;
+
+    // group children by label, keeping the order in which they are found
+    QStringList keys;
+    QHash<QString, QList<const TreeLeafItem*> > children;
+    // the number of places differs per file, so all of them are combined,
+    // labels never contain line breaks
+    const QString belowThresholdKey(QLatin1Char('\n'));
+    uint places = 0;
+    QString belowThresholdLabel;
+
+    foreach (const TreeLeafItem* node, nodes) {
+        cost += node->cost();
+        foreach (const TreeLeafItem* child, node->children()) {
+            QString key = child->label();
+            if (belowThreshold.indexIn(key) != -1) {
+                places += belowThreshold.cap(1).toUInt();
+                if (belowThresholdLabel.isEmpty()) {
+                    belowThresholdLabel = key;
+                }
+                key = belowThresholdKey;
+            }
+            QHash<QString, QList<const TreeLeafItem*> >::iterator it = children.find(key);
+            if (it == children.end()) {
+                keys << key;
+                children.insert(key, QList<const TreeLeafItem*>() << child);
+            } else {
+                it->append(child);
+            }
+        }
+    }
+    merged->setCost(cost);
+
+    QList<TreeLeafItem*> mergedChildren;
+    foreach (const QString& key, keys) {
+        TreeLeafItem* child = mergeNodes(children.value(key), symbols, belowThreshold);
+        if (key == belowThresholdKey && children.value(key).size() > 1) {
+            // in 803 places, all below massif's threshold (01.00%)
+            belowThreshold.indexIn(belowThresholdLabel);
+            QString label = belowThresholdLabel;
+            label.replace(belowThreshold.pos(1), belowThreshold.cap(1).length(), QString::number(places));
+            child->setSymbol(symbols->symbol(label));
+        }
+        mergedChildren << child;
+    }
+    qSort(mergedChildren.begin(), mergedChildren.end(), sortLeafsByCost);
+    merged->setChildren(mergedChildren);
+    return merged;
+}
+
+void mergeTrees(MergeJob& job)
+{
+    // QRegExp keeps state, hence every job needs its own
+    QRegExp belowThreshold("in ([0-9]+) places?, all below massif's threshold",
+                           Qt::CaseSensitive, QRegExp::RegExp2);
+    job.tree = mergeNodes(job.roots, job.symbols, belowThreshold);
+    job.tree->updateChains();
+}
+
+void replaceSymbols(TreeLeafItem* node, const QHash<const Symbol*, const Symbol*>& replaced)
+{
+    QHash<const Symbol*, const Symbol*>::const_iterator it = replaced.constFind(node->symbol());
+    if (it != replaced.constEnd()) {
+        node->setSymbol(it.value());
+    }
+    foreach (TreeLeafItem* child, node->children()) {
+        replaceSymbols(child, replaced);
+    }
+}
+
+void replaceMergedSymbols(MergeJob& job)
+{
+    if (!job.replacedSymbols.isEmpty()) {
+        replaceSymbols(job.tree, job.replacedSymbols);
+    }
+}
+
+/// @return The last snapshot in @p snapshots at or before @p time, optionally only detailed ones.
+SnapshotItem* snapshotAt(const QList<SnapshotItem*>& snapshots, double time, bool detailed)
+{
+    if (snapshots.isEmpty() || snapshots.last()->time() < time) {
+        // the process was not running anymore
+        return 0;
+    }
+    // binary search for the first snapshot after time
+    int first = 0;
+    int last = snapshots.size();
+    while (first < last) {
+        const int middle = (first + last) / 2;
+        if (snapshots.at(middle)->time() <= time) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+    for (int i = first - 1; i >= 0; --i) {
+        if (!detailed || snapshots.at(i)->heapTree()) {
+            return snapshots.at(i);
+        }
+    }
+    return 0;
+}
+
+QString joined(const QStringList& strings)
+{
+    QStringList unique;
+    foreach (const QString& string, strings) {
+        if (!unique.contains(string)) {
+            unique << string;
+        }
+    }
+    return unique.join("; ");
+}
+
+}
+
+FileMerger::FileMerger()
+    : m_errorFile(-1), m_errorLine(-1), m_minimumCost(0), m_minimumPercentage(0)
+{
+}
+
+FileMerger::~FileMerger()
+{
+}
+
+FileData* FileMerger::merge(const QList<QIODevice*>& files, const QStringList& customAllocators)
+{
+    m_errorFile = -1;
+    m_errorLine = -1;
+    m_errorLineString.clear();
+
+    QList<ParseJob> jobs;
+    foreach (QIODevice* file, files) {
+        ParseJob job;
+        job.file = file;
+        job.customAllocators = customAllocators;
+        job.minimumCost = m_minimumCost;
+        job.minimumPercentage = m_minimumPercentage;
+        job.data = 0;
+        job.errorLine = -1;
+        jobs << job;
+    }
+    QtConcurrent::blockingMap(jobs, parseFile);
+
+    QList<FileData*> parsed;
+    for (int i = 0; i < jobs.size(); ++i) {
+        const ParseJob& job = jobs.at(i);
+        if (!job.data && m_errorFile == -1) {
+            m_errorFile = i;
+            m_errorLine = job.errorLine;
+            m_errorLineString = job.errorLineString;
+        }
+        parsed << job.data;
+    }
+
+    FileData* data = 0;
+    if (m_errorFile == -1) {
+        data = merge(parsed);
+    }
+    qDeleteAll(parsed);
+    return data;
+}
+
+FileData* FileMerger::merge(const QList<FileData*>& files)
+{
+    m_errorFile = -1;
+    m_errorLine = -1;
+    m_errorLineString.clear();
+
+    if (files.isEmpty()) {
+        return 0;
+    }
+
+    QStringList cmds;
+    QStringList descriptions;
+    int snapshotCount = 0;
+    double endTime = 0;
+    for (int i = 0; i < files.size(); ++i) {
+        const FileData* file = files.at(i);
+        if (file->timeUnit() != files.first()->timeUnit()) {
+            m_errorFile = i;
+            return 0;
+        }
+        cmds << file->cmd();
+        descriptions << file->description();
+        snapshotCount = qMax(snapshotCount, file->snapshots().size());
+        if (!file->snapshots().isEmpty()) {
+            endTime = qMax(endTime, file->snapshots().last()->time());
+        }
+    }
+
+    FileData* data = new FileData;
+    data->setCmd(joined(cmds));
+    data->setDescription(joined(descriptions));
+    data->setTimeUnit(files.first()->timeUnit());
+
+    // resample onto a common time axis, with as many snapshots as the longest file
+    QList<MergeJob> jobs;
+    QList<SnapshotItem*> detailedSnapshots;
+    for (int i = 0; i < snapshotCount; ++i) {
+        const double time = snapshotCount > 1 ? endTime * i / (snapshotCount - 1) : endTime;
+        // for detailed snapshots only detailed ones are taken into account,
+        // such that the heap tree matches the heap size
+        QList<const SnapshotItem*> sources;
+        bool detailed = (i + 1) % detailedFrequency == 0 || i == snapshotCount - 1;
+        while (sources.isEmpty()) {
+            foreach (const FileData* file, files) {
+                if (const SnapshotItem* source = snapshotAt(file->snapshots(), time, detailed)) {
+                    sources << source;
+                }
+            }
+            if (!detailed) {
+                break;
+            }
+            detailed = false;
+        }
+
+        SnapshotItem* snapshot = new SnapshotItem;
+        snapshot->setNumber(i);
+        snapshot->setTime(time);
+        unsigned long memHeap = 0;
+        unsigned long memHeapExtra = 0;
+        unsigned int memStacks = 0;
+        MergeJob job;
+        job.symbols = 0;
+        job.tree = 0;
+        foreach (const SnapshotItem* source, sources) {
+            memHeap += source->memHeap();
+            memHeapExtra += source->memHeapExtra();
+            memStacks += source->memStacks();
+            if (detailed) {
+                job.roots << source->heapTree();
+            }
+        }
+        snapshot->setMemHeap(memHeap);
+        snapshot->setMemHeapExtra(memHeapExtra);
+        snapshot->setMemStacks(memStacks);
+        data->addSnapshot(snapshot);
+
+        if (!job.roots.isEmpty()) {
+            job.symbols = new SymbolTable;
+            jobs << job;
+            detailedSnapshots << snapshot;
+        }
+    }
+
+    // the heap trees are independent of each other and can be merged in parallel
+    QtConcurrent::blockingMap(jobs, mergeTrees);
+    // only the tables are merged sequentially, the trees are updated in parallel again
+    for (int i = 0; i < jobs.size(); ++i) {
+        MergeJob& job = jobs[i];
+        job.replacedSymbols = data->symbols()->merge(job.symbols);
+        delete job.symbols;
+        job.symbols = 0;
+    }
+    QtConcurrent::blockingMap(jobs, replaceMergedSymbols);
+    for (int i = 0; i < jobs.size(); ++i) {
+        detailedSnapshots.at(i)->setHeapTree(jobs.at(i).tree);
+    }
+
+    // like the parser, prefer a detailed snapshot as peak
+    data->updateColumns();
+    const int peak = data->columns().peak();
+    if (peak != -1) {
+        data->setPeak(data->snapshots().at(peak));
+    }
+
+    return data;
+}
+
+void FileMerger::setMinimumCost(unsigned long bytes, double percentage)
+{
+    m_minimumCost = bytes;
+    m_minimumPercentage = percentage;
+}
+
+int FileMerger::errorFile() const
+{
+    return m_errorFile;
+}
+
+int FileMerger::errorLine() const
+{
+    return m_errorLine;
+}
+
+QString FileMerger::errorLineString() const
+{
+    return m_errorLineString;
+}
@@ -0,0 +1,105 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MASSIF_FILEMERGER_H
+#define MASSIF_FILEMERGER_H
+
+#include <QtCore/QList>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include "massifdata_export.h"
+
+class QIODevice;
+
+namespace Massif {
+
+class FileData;
+
+/**
+ * Merges the massif output of multiple processes, e.g. forked workers,
+ * into a single dataset that can be used like a normally parsed file.
+ *
+ * The snapshots of all files are resampled onto a common time axis, where
+ * each file contributes its last snapshot before the given time, as long as
+ * it was still running. The heap trees get merged by call path, i.e. nodes
+ * with the same label below the same parents are combined and their costs
+ * summed up.
+ */
+class MASSIFDATA_EXPORT FileMerger
+{
+public:
+    FileMerger();
+    ~FileMerger();
+
+    /**
+     * Parses all @p files in parallel and merges them.
+     *
+     * @p customAllocators list of wildcard patterns used to find custom allocators
+     *
+     * @return Merged data or null if one of the files could not be parsed
+     *         or they use different time units.
+     *
+     * @note The caller has to delete the data afterwards.
+     */
+    FileData* merge(const QList<QIODevice*>& files,
+                    const QStringList& customAllocators = QStringList());
+
+    /**
+     * Merges the already parsed @p files, which are not modified and can be
+     * deleted afterwards.
+     *
+     * @return Merged data or null if the files use different time units.
+     *
+     * @note The caller has to delete the data afterwards.
+     */
+    FileData* merge(const QList<FileData*>& files);
+
+    /**
+     * Do not load call sites below these thresholds when parsing files.
+     *
+     * @see Parser::setMinimumCost()
+     */
+    void setMinimumCost(unsigned long bytes, double percentage = 0);
+
+    /**
+     * Returns the index of the file which could not be parsed or merged or -1 if no error occurred.
+     */
+    int errorFile() const;
+    /**
+     * Returns the number of the line which could not be parsed or -1.
+     */
+    int errorLine() const;
+    /**
+     * Returns the line which could not be parsed.
+     */
+    QString errorLineString() const;
+
+private:
+    int m_errorFile;
+    int m_errorLine;
+    QString m_errorLineString;
+    unsigned long m_minimumCost;
+    double m_minimumPercentage;
+};
+
+}
+
+#endif // MASSIF_FILEMERGER_H
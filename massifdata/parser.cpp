@@ -31,7 +31,7 @@
 using namespace Massif;
 
 Parser::Parser()
-    : m_errorLine(-1)
+    : m_errorLine(-1), m_minimumCost(0), m_minimumPercentage(0)
 {
 }
 
@@ -46,7 +46,7 @@ FileData* Parser::parse(QIODevice* file, const QStringList& customAllocators)
 
     FileData* data = new FileData;
 
-    ParserPrivate p(file, data, customAllocators);
+    ParserPrivate p(file, data, customAllocators, m_minimumCost, m_minimumPercentage);
 
     if (p.error()) {
         delete data;
@@ -61,30 +61,28 @@ FileData* Parser::parse(QIODevice* file, const QStringList& customAllocators)
 
     // when a massif run gets terminated (^C) the snapshot data might be wrong,
     // hence just always ensure we pick the proper peak ourselves
-    if (!data->snapshots().isEmpty()) {
-        foreach ( SnapshotItem* snapshot, data->snapshots() ) {
-            if (!snapshot->heapTree()) {
-                // peak should have detailed info
-                continue;
-            }
-            if (!data->peak() || snapshot->memHeap() > data->peak()->memHeap()) {
-                data->setPeak(snapshot);
-            }
-        }
-        // still not found? pick any other snapshot
-        if (!data->peak()) {
-            foreach( SnapshotItem* snapshot, data->snapshots() ) {
-                if (!data->peak() || snapshot->memHeap() > data->peak()->memHeap()) {
-                    data->setPeak(snapshot);
-                }
-            }
-        }
+    data->updateColumns();
+    const int peak = data->columns().peak();
+    if (peak != -1) {
+        data->setPeak(data->snapshots().at(peak));
     }
     // peak might still be zero if we have no snapshots, should be handled in the UI then
 
+    foreach (SnapshotItem* snapshot, data->snapshots()) {
+        if (snapshot->heapTree()) {
+            snapshot->heapTree()->updateChains();
+        }
+    }
+
     return data;
 }
 
+void Parser::setMinimumCost(unsigned long bytes, double percentage)
+{
+    m_minimumCost = bytes;
+    m_minimumPercentage = percentage;
+}
+
 int Parser::errorLine() const
 {
     return m_errorLine;
@@ -53,6 +53,15 @@ public:
     FileData* parse(QIODevice* file,
                     const QStringList& customAllocators = QStringList());
 
+    /**
+     * Do not load call sites which cost less than @p bytes or less than
+     * @p percentage of the heap size of their snapshot. Their costs get
+     * folded into the "below threshold" node of their parent instead.
+     *
+     * This caps the memory usage for files recorded with a low massif threshold.
+     */
+    void setMinimumCost(unsigned long bytes, double percentage = 0);
+
     /**
      * Returns the number of the line which could not be parsed or -1 if no error occurred.
      */
@@ -65,6 +74,8 @@ public:
 private:
     int m_errorLine;
     QString m_errorLineString;
+    unsigned long m_minimumCost;
+    double m_minimumPercentage;
 };
 
 }
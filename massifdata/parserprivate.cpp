@@ -22,12 +22,13 @@
 
 #include "filedata.h"
 #include "snapshotitem.h"
+#include "symbol.h"
+#include "symboltable.h"
 #include "treeleafitem.h"
 
 #include <QtCore/QIODevice>
 
 #include <QtCore/QDebug>
-#include <visualizer/util.h>
 
 using namespace Massif;
 
@@ -36,10 +37,15 @@ using namespace Massif;
 #define VALIDATE_RETURN(x, y) if (!(x)) { m_error = Invalid; return y; }
 
 ParserPrivate::ParserPrivate(QIODevice* file, FileData* data,
-                             const QStringList& customAllocators)
+                             const QStringList& customAllocators,
+                             unsigned long minimumCost,
+                             double minimumPercentage)
     : m_file(file), m_data(data), m_nextLine(FileDesc)
     , m_currentLine(0), m_error(NoError), m_snapshot(0)
     , m_parentItem(0), m_hadCustomAllocators(false)
+    , m_minimumCost(minimumCost), m_minimumPercentage(minimumPercentage)
+    , m_snapshotMinimumCost(0), m_prunedCost(0), m_prunedPlaces(0)
+    , m_belowThreshold("in ([0-9]+) places?, all below massif's threshold", Qt::CaseSensitive, QRegExp::RegExp2)
 {
     foreach(const QString& allocator, customAllocators) {
         m_allocators << QRegExp(allocator, Qt::CaseSensitive, QRegExp::Wildcard);
@@ -233,6 +239,8 @@ void ParserPrivate::parseSnapshotHeapTree(const QByteArray& line)
         m_error = Invalid;
         return;
     }
+    m_snapshotMinimumCost = qMax(m_minimumCost,
+                                 static_cast<unsigned long>(m_snapshot->memHeap() * m_minimumPercentage / 100));
 }
 
 bool sortLeafsByCost(TreeLeafItem* l, TreeLeafItem* r)
@@ -254,9 +262,7 @@ void ParserPrivate::parseHeapTreeLeaf(const QByteArray& line)
         uint places = 0;
         QString oldPlaces;
         ///TODO: is massif translateable?
-        static QRegExp matchBT("in ([0-9]+) places, all below massif's threshold",
-                                            Qt::CaseSensitive, QRegExp::RegExp2);
-        m_data->timeUnit();
+        QRegExp& matchBT = m_belowThreshold;
         foreach(TreeLeafItem* child, newChildren) {
             if (child->label().indexOf(matchBT) != -1) {
                 places += matchBT.cap(1).toUInt();
@@ -273,7 +279,7 @@ void ParserPrivate::parseHeapTreeLeaf(const QByteArray& line)
         if (belowThreshold) {
             QString label = belowThreshold->label();
             label.replace(oldPlaces, QString::number(places));
-            belowThreshold->setLabel(label);
+            belowThreshold->setSymbol(m_data->symbols()->symbol(label));
         }
         qSort(newChildren.begin(), newChildren.end(), sortLeafsByCost);
         m_snapshot->heapTree()->setChildren(newChildren);
@@ -319,12 +325,32 @@ bool ParserPrivate::parseheapTreeLeafInternal(const QByteArray& line, int depth)
         return true;
     }
 
+    // prune call sites below our own threshold, without ever allocating them,
+    // all of their children are below the threshold as well
+    if (depth > 0 && (!m_parentItem || cost < m_snapshotMinimumCost)) {
+        if (m_parentItem) {
+            m_prunedCost += cost;
+            // massif's own "below threshold" nodes already stand for multiple places
+            if (line.indexOf("all below massif's threshold", spacePos) != -1
+                && m_belowThreshold.indexIn(QString(line.mid(spacePos + 1))) != -1)
+            {
+                m_prunedPlaces += m_belowThreshold.cap(1).toUInt();
+            } else {
+                ++m_prunedPlaces;
+            }
+        }
+        SaveAndRestoreItem skip(&m_parentItem, 0);
+        return parseHeapTreeChildren(children, depth);
+    }
+
     const QString label = line.mid(spacePos + 1);
+    // every unique label gets parsed only once
+    const Symbol* symbol = m_data->symbols()->symbol(label);
 
     bool isCustomAlloc = false;
 
     if (depth > 0) {
-        const QString func = functionInLabel(label);
+        const QString func = symbol->function();
         foreach(const QRegExp& allocator, m_allocators) {
             if (allocator.exactMatch(func)) {
                 isCustomAlloc = true;
@@ -337,7 +363,7 @@ bool ParserPrivate::parseheapTreeLeafInternal(const QByteArray& line, int depth)
     if (!isCustomAlloc) {
         TreeLeafItem* leaf = new TreeLeafItem;
         leaf->setCost(cost);
-        leaf->setLabel(label);
+        leaf->setSymbol(symbol);
 
         if (!depth) {
             m_snapshot->setHeapTree(leaf);
@@ -358,6 +384,23 @@ bool ParserPrivate::parseheapTreeLeafInternal(const QByteArray& line, int depth)
 
     SaveAndRestoreItem lastParent(&m_parentItem, newParent);
 
+    const unsigned long prunedCost = m_prunedCost;
+    const uint prunedPlaces = m_prunedPlaces;
+    m_prunedCost = 0;
+    m_prunedPlaces = 0;
+
+    const bool ret = parseHeapTreeChildren(children, depth);
+
+    if (m_prunedPlaces) {
+        addPrunedCost(newParent, m_prunedCost, m_prunedPlaces);
+    }
+    m_prunedCost = prunedCost;
+    m_prunedPlaces = prunedPlaces;
+    return ret;
+}
+
+bool ParserPrivate::parseHeapTreeChildren(unsigned int children, int depth)
+{
     for (unsigned int i = 0; i < children; ++i) {
         ++m_currentLine;
         QByteArray nextLine = m_file->readLine();
@@ -376,4 +419,42 @@ bool ParserPrivate::parseheapTreeLeafInternal(const QByteArray& line, int depth)
     return true;
 }
 
+void ParserPrivate::addPrunedCost(TreeLeafItem* parent, unsigned long cost, uint places)
+{
+    // fold the pruned children into the "below threshold" node, like massif does
+    QList<TreeLeafItem*> children = parent->children();
+    TreeLeafItem* belowThreshold = 0;
+    QString label;
+    foreach (TreeLeafItem* child, children) {
+        if (m_belowThreshold.indexIn(child->label()) != -1) {
+            belowThreshold = child;
+            break;
+        }
+    }
+    if (belowThreshold) {
+        // in 803 places, all below massif's threshold (01.00%)
+        places += m_belowThreshold.cap(1).toUInt();
+        label = belowThreshold->label();
+        label.replace(m_belowThreshold.pos(1), m_belowThreshold.cap(1).length(), QString::number(places));
+        belowThreshold->setCost(belowThreshold->cost() + cost);
+        children.removeOne(belowThreshold);
+    } else {
+        const double percentage = m_snapshot->memHeap() ? 100.0 * m_snapshotMinimumCost / m_snapshot->memHeap() : 0;
+        label = QString("in %1 %2, all below massif's threshold (%3%)")
+                    .arg(places).arg(places == 1 ? "place" : "places")
+                    .arg(percentage, 5, 'f', 2, QLatin1Char('0'));
+        belowThreshold = new TreeLeafItem;
+        belowThreshold->setCost(cost);
+    }
+    belowThreshold->setSymbol(m_data->symbols()->symbol(label));
+
+    // keep the children sorted by cost
+    int i = 0;
+    while (i < children.size() && children.at(i)->cost() >= belowThreshold->cost()) {
+        ++i;
+    }
+    children.insert(i, belowThreshold);
+    parent->setChildren(children);
+}
+
 //END Parser Functions
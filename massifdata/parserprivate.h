@@ -22,6 +22,7 @@
 #define MASSIF_PARSERPRIVATE_H
 
 #include <QtCore/QByteArray>
+#include <QtCore/QRegExp>
 #include <QtCore/QStringList>
 
 class QIODevice;
@@ -36,7 +37,9 @@ class ParserPrivate
 {
 public:
     explicit ParserPrivate(QIODevice* file, Massif::FileData* data,
-                           const QStringList& customAllocators);
+                           const QStringList& customAllocators,
+                           unsigned long minimumCost = 0,
+                           double minimumPercentage = 0);
     ~ParserPrivate();
 
     enum Error {
@@ -69,6 +72,8 @@ private:
     void parseSnapshotMemStacks(const QByteArray& line);
     void parseHeapTreeLeaf(const QByteArray& line);
     bool parseheapTreeLeafInternal(const QByteArray& line, int depth);
+    bool parseHeapTreeChildren(unsigned int children, int depth);
+    void addPrunedCost(TreeLeafItem* parent, unsigned long cost, uint places);
 
     QIODevice* m_file;
     FileData* m_data;
@@ -113,6 +118,18 @@ private:
 
     /// list of custom allocator wildcards
     QList<QRegExp> m_allocators;
+
+    /// optional pool to intern labels
+
+    /// call sites below these thresholds are not loaded
+    unsigned long m_minimumCost;
+    double m_minimumPercentage;
+    /// the minimum cost in the current snapshot
+    unsigned long m_snapshotMinimumCost;
+    /// cost and number of the pruned children of the current parent item
+    unsigned long m_prunedCost;
+    uint m_prunedPlaces;
+    QRegExp m_belowThreshold;
 };
 
 }
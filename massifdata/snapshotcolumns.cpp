@@ -0,0 +1,94 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "snapshotcolumns.h"
+
+#include "costkernels.h"
+#include "snapshotitem.h"
+
+using namespace Massif;
+
+SnapshotColumns::SnapshotColumns()
+{
+}
+
+SnapshotColumns::~SnapshotColumns()
+{
+}
+
+void SnapshotColumns::build(const QList<SnapshotItem*>& snapshots)
+{
+    const int n = snapshots.size();
+    m_times.resize(n);
+    m_heap.resize(n);
+    m_heapExtra.resize(n);
+    m_stacks.resize(n);
+    m_detailedHeap.resize(n);
+    for (int i = 0; i < n; ++i) {
+        const SnapshotItem* snapshot = snapshots.at(i);
+        m_times[i] = snapshot->time();
+        m_heap[i] = snapshot->memHeap();
+        m_heapExtra[i] = snapshot->memHeapExtra();
+        m_stacks[i] = snapshot->memStacks();
+        m_detailedHeap[i] = snapshot->heapTree() ? quint64(snapshot->memHeap()) + 1 : 0;
+    }
+}
+
+int SnapshotColumns::size() const
+{
+    return m_times.size();
+}
+
+const QVector<double>& SnapshotColumns::times() const
+{
+    return m_times;
+}
+
+const QVector<quint64>& SnapshotColumns::heap() const
+{
+    return m_heap;
+}
+
+const QVector<quint64>& SnapshotColumns::heapExtra() const
+{
+    return m_heapExtra;
+}
+
+const QVector<quint64>& SnapshotColumns::stacks() const
+{
+    return m_stacks;
+}
+
+int SnapshotColumns::peak() const
+{
+    // when a massif run gets terminated (^C) the snapshot data might be wrong,
+    // the peak should have detailed info if possible
+    const int detailed = argMaxCost(m_detailedHeap.constData(), m_detailedHeap.size());
+    if (detailed != -1 && m_detailedHeap.at(detailed)) {
+        return detailed;
+    }
+    return argMaxCost(m_heap.constData(), m_heap.size());
+}
+
+double SnapshotColumns::timeBefore(quint64 cost) const
+{
+    const int i = firstAtLeast(m_heap.constData(), m_heap.size(), cost);
+    return i > 0 ? m_times.at(i - 1) : 0;
+}
@@ -0,0 +1,95 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MASSIF_SNAPSHOTCOLUMNS_H
+#define MASSIF_SNAPSHOTCOLUMNS_H
+
+#include <QtCore/QList>
+#include <QtCore/QVector>
+
+#include "massifdata_export.h"
+
+namespace Massif {
+
+class SnapshotItem;
+
+/**
+ * The times and totals of all snapshots of a file, stored in contiguous columns
+ * such that aggregations over them do not chase pointers.
+ *
+ * @see costkernels.h
+ */
+class MASSIFDATA_EXPORT SnapshotColumns
+{
+public:
+    SnapshotColumns();
+    ~SnapshotColumns();
+
+    /**
+     * Fills the columns from @p snapshots.
+     */
+    void build(const QList<SnapshotItem*>& snapshots);
+
+    /**
+     * @return Number of snapshots.
+     */
+    int size() const;
+
+    /**
+     * @return The times of all snapshots.
+     */
+    const QVector<double>& times() const;
+    /**
+     * @return The heap sizes of all snapshots.
+     */
+    const QVector<quint64>& heap() const;
+    /**
+     * @return The extra heap sizes of all snapshots.
+     */
+    const QVector<quint64>& heapExtra() const;
+    /**
+     * @return The stack sizes of all snapshots.
+     */
+    const QVector<quint64>& stacks() const;
+
+    /**
+     * @return The index of the peak snapshot, preferring detailed snapshots,
+     *         or -1 if there are no snapshots.
+     */
+    int peak() const;
+
+    /**
+     * @return The time of the last snapshot before the heap reaches @p cost for
+     *         the first time, or zero if it is reached by the first snapshot.
+     */
+    double timeBefore(quint64 cost) const;
+
+private:
+    QVector<double> m_times;
+    QVector<quint64> m_heap;
+    QVector<quint64> m_heapExtra;
+    QVector<quint64> m_stacks;
+    // heap size + 1 for detailed snapshots, zero otherwise
+    QVector<quint64> m_detailedHeap;
+};
+
+}
+
+#endif // MASSIF_SNAPSHOTCOLUMNS_H
@@ -86,6 +86,9 @@ unsigned int SnapshotItem::memStacks() const
 void SnapshotItem::setHeapTree(TreeLeafItem* root)
 {
     m_heapTree = root;
+    if (root) {
+        root->setSnapshot(this);
+    }
 }
 
 TreeLeafItem* SnapshotItem::heapTree() const
@@ -21,6 +21,8 @@
 #ifndef SNAPSHOTITEM_H
 #define SNAPSHOTITEM_H
 
+#include <QtCore/QMetaType>
+
 #include "massifdata_export.h"
 
 namespace Massif
@@ -103,4 +105,6 @@ private:
 
 }
 
+Q_DECLARE_METATYPE(Massif::SnapshotItem*);
+
 #endif // SNAPSHOTITEM_H
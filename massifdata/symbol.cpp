@@ -0,0 +1,128 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "symbol.h"
+
+using namespace Massif;
+
+namespace {
+
+/// removes template arguments between <...>
+QString stripTemplateArguments(const QString& string)
+{
+    if (string.indexOf('<') == -1) {
+        return string;
+    }
+
+    QString ret = string;
+    int depth = 0;
+    int open = 0;
+    for (int i = 0; i < ret.length(); ++i) {
+        if (ret.at(i) == '<') {
+            if (!depth) {
+                open = i;
+            }
+            ++depth;
+        } else if (ret.at(i) == '>') {
+            --depth;
+            if (!depth) {
+                ret.remove(open + 1, i - open - 1);
+                i = open + 1;
+                open = 0;
+            }
+        }
+    }
+    return ret;
+}
+
+}
+
+Symbol::Symbol()
+    : m_belowThreshold(false)
+{
+}
+
+Symbol::Symbol(const QString& label)
+    : m_label(label)
+    , m_belowThreshold(label.indexOf("all below massif's threshold") != -1)
+{
+    // 0x6F675AB: QByteArray::resize(int) (in /usr/lib/libQtCore.so.4.5.2)
+    // 0x6F675AB: KDevelop::IndexedIdentifier::IndexedIdentifier(KDevelop::Identifier const&) (identifier.cpp:1050)
+    const int colonPos = label.indexOf(": ");
+    if (colonPos == -1) {
+        m_name = label;
+    } else {
+        m_address = label.left(colonPos);
+        m_name = label.mid(colonPos + 2);
+    }
+
+    const int locationPos = m_name.lastIndexOf(" (");
+    if (locationPos == -1) {
+        m_function = m_name;
+    } else {
+        m_function = m_name.left(locationPos);
+        if (!m_belowThreshold && m_name.endsWith(')')) {
+            m_location = m_name.mid(locationPos + 2, m_name.length() - locationPos - 3);
+        }
+    }
+
+    m_shortName = stripTemplateArguments(m_name);
+    m_shortFunction = stripTemplateArguments(m_function);
+}
+
+QString Symbol::label() const
+{
+    return m_label;
+}
+
+QString Symbol::address() const
+{
+    return m_address;
+}
+
+QString Symbol::name() const
+{
+    return m_name;
+}
+
+QString Symbol::shortName() const
+{
+    return m_shortName;
+}
+
+QString Symbol::function() const
+{
+    return m_function;
+}
+
+QString Symbol::shortFunction() const
+{
+    return m_shortFunction;
+}
+
+QString Symbol::location() const
+{
+    return m_location;
+}
+
+bool Symbol::isBelowThreshold() const
+{
+    return m_belowThreshold;
+}
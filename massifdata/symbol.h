@@ -0,0 +1,98 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MASSIF_SYMBOL_H
+#define MASSIF_SYMBOL_H
+
+#include <QtCore/QString>
+
+#include "massifdata_export.h"
+
+namespace Massif {
+
+/**
+ * The parts of a label in a heap tree, e.g.:
+ *
+ * 0x6F675AB: QByteArray::resize(int) (in /usr/lib/libQtCore.so.4.5.2)
+ *
+ * Labels get parsed once when they are first seen, see SymbolTable.
+ */
+class MASSIFDATA_EXPORT Symbol
+{
+public:
+    Symbol();
+    /**
+     * Parses @p label into its parts.
+     */
+    explicit Symbol(const QString& label);
+
+    /**
+     * @return The unparsed label.
+     */
+    QString label() const;
+
+    /**
+     * @return The memory address, e.g. "0x6F675AB", or an empty string.
+     */
+    QString address() const;
+
+    /**
+     * @return The label without the memory address.
+     */
+    QString name() const;
+    /**
+     * @return The label without the memory address and without template arguments.
+     */
+    QString shortName() const;
+
+    /**
+     * @return The function, i.e. the label without memory address and location.
+     */
+    QString function() const;
+    /**
+     * @return The function without template arguments.
+     */
+    QString shortFunction() const;
+
+    /**
+     * @return The location, either file:line or the library, e.g. "in /usr/lib/libQtCore.so.4.5.2",
+     *         or an empty string.
+     */
+    QString location() const;
+
+    /**
+     * @return True if this label denotes aggregated items below massif's threshold.
+     */
+    bool isBelowThreshold() const;
+
+private:
+    QString m_label;
+    QString m_address;
+    QString m_name;
+    QString m_shortName;
+    QString m_function;
+    QString m_shortFunction;
+    QString m_location;
+    bool m_belowThreshold;
+};
+
+}
+
+#endif // MASSIF_SYMBOL_H
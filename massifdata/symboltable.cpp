@@ -0,0 +1,83 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "symboltable.h"
+
+#include "symbol.h"
+
+using namespace Massif;
+
+SymbolTable::SymbolTable()
+{
+}
+
+SymbolTable::~SymbolTable()
+{
+    qDeleteAll(m_symbols);
+}
+
+const Symbol* SymbolTable::symbol(const QString& label)
+{
+    QHash<QString, Symbol*>::const_iterator it = m_symbols.constFind(label);
+    if (it != m_symbols.constEnd()) {
+        return it.value();
+    }
+    Symbol* symbol = new Symbol(label);
+    m_symbols.insert(label, symbol);
+    return symbol;
+}
+
+const Symbol* SymbolTable::insert(const Symbol& symbol)
+{
+    QHash<QString, Symbol*>::const_iterator it = m_symbols.constFind(symbol.label());
+    if (it != m_symbols.constEnd()) {
+        return it.value();
+    }
+    Symbol* copy = new Symbol(symbol);
+    m_symbols.insert(copy->label(), copy);
+    return copy;
+}
+
+const Symbol* SymbolTable::find(const QString& label) const
+{
+    return m_symbols.value(label, 0);
+}
+
+int SymbolTable::size() const
+{
+    return m_symbols.size();
+}
+
+QHash<const Symbol*, const Symbol*> SymbolTable::merge(SymbolTable* other)
+{
+    QHash<const Symbol*, const Symbol*> replaced;
+    QHash<QString, Symbol*>::const_iterator it = other->m_symbols.constBegin();
+    for (; it != other->m_symbols.constEnd(); ++it) {
+        QHash<QString, Symbol*>::const_iterator existing = m_symbols.constFind(it.key());
+        if (existing == m_symbols.constEnd()) {
+            m_symbols.insert(it.key(), it.value());
+        } else {
+            replaced.insert(it.value(), existing.value());
+            delete it.value();
+        }
+    }
+    other->m_symbols.clear();
+    return replaced;
+}
@@ -0,0 +1,83 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MASSIF_SYMBOLTABLE_H
+#define MASSIF_SYMBOLTABLE_H
+
+#include <QtCore/QHash>
+#include <QtCore/QString>
+
+#include "massifdata_export.h"
+
+namespace Massif {
+
+class Symbol;
+
+/**
+ * A table of all unique labels in a file and their parsed parts.
+ *
+ * The table is not thread safe. Threads which add symbols concurrently
+ * each fill their own table, which get merged afterwards.
+ */
+class MASSIFDATA_EXPORT SymbolTable
+{
+public:
+    SymbolTable();
+    ~SymbolTable();
+
+    /**
+     * @return The symbol for @p label, which gets parsed if it was not seen before.
+     *         The symbol is owned by this table.
+     */
+    const Symbol* symbol(const QString& label);
+
+    /**
+     * @return The symbol for the label of @p symbol, a copy of it gets added
+     *         if the label was not seen before. Unlike symbol() the label is
+     *         not parsed again.
+     */
+    const Symbol* insert(const Symbol& symbol);
+
+    /**
+     * @return The symbol for @p label or zero, if it is not in this table.
+     */
+    const Symbol* find(const QString& label) const;
+
+    /**
+     * @return Number of symbols in this table.
+     */
+    int size() const;
+
+    /**
+     * Moves all symbols of @p other into this table, @p other is empty afterwards.
+     *
+     * @return The symbols of @p other whose label already was in this table,
+     *         mapped to the symbol of this table which replaces them.
+     *         The replaced symbols are deleted.
+     */
+    QHash<const Symbol*, const Symbol*> merge(SymbolTable* other);
+
+private:
+    QHash<QString, Symbol*> m_symbols;
+};
+
+}
+
+#endif // MASSIF_SYMBOLTABLE_H
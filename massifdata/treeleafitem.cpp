@@ -20,10 +20,12 @@
 
 #include "treeleafitem.h"
 
+#include "symbol.h"
+
 using namespace Massif;
 
 TreeLeafItem::TreeLeafItem()
-    : m_cost(0), m_parent(0)
+    : m_symbol(0), m_cost(0), m_recursionDepth(1), m_parent(0), m_chainEnd(this), m_snapshot(0), m_row(0)
 {
 }
 
@@ -35,6 +37,7 @@ TreeLeafItem::~TreeLeafItem()
 void TreeLeafItem::setLabel(const QString label)
 {
     m_label = label;
+    m_symbol = 0;
 }
 
 QString TreeLeafItem::label() const
@@ -42,6 +45,17 @@ QString TreeLeafItem::label() const
     return m_label;
 }
 
+void TreeLeafItem::setSymbol(const Symbol* symbol)
+{
+    m_label = symbol->label();
+    m_symbol = symbol;
+}
+
+const Symbol* TreeLeafItem::symbol() const
+{
+    return m_symbol;
+}
+
 void TreeLeafItem::setCost(const unsigned long bytes)
 {
     m_cost = bytes;
@@ -52,15 +66,33 @@ unsigned long TreeLeafItem::cost() const
     return m_cost;
 }
 
+void TreeLeafItem::setRecursionDepth(const unsigned int depth)
+{
+    m_recursionDepth = depth;
+}
+
+unsigned int TreeLeafItem::recursionDepth() const
+{
+    return m_recursionDepth;
+}
+
 void TreeLeafItem::addChild(TreeLeafItem* leaf)
 {
     leaf->m_parent = this;
+    leaf->m_row = m_children.size();
+    leaf->setSnapshot(m_snapshot);
     m_children << leaf;
 }
 
 void TreeLeafItem::setChildren(const QList< TreeLeafItem* >& leafs)
 {
     m_children = leafs;
+    for (int i = 0; i < m_children.size(); ++i) {
+        TreeLeafItem* leaf = m_children.at(i);
+        leaf->m_parent = this;
+        leaf->m_row = i;
+        leaf->setSnapshot(m_snapshot);
+    }
 }
 
 QList< TreeLeafItem* > TreeLeafItem::children() const
@@ -72,3 +104,42 @@ TreeLeafItem* TreeLeafItem::parent() const
 {
     return m_parent;
 }
+
+int TreeLeafItem::row() const
+{
+    return m_row;
+}
+
+void TreeLeafItem::setSnapshot(SnapshotItem* snapshot)
+{
+    // items below one with the right snapshot already have it, too
+    if (m_snapshot == snapshot) {
+        return;
+    }
+    m_snapshot = snapshot;
+    foreach (TreeLeafItem* child, m_children) {
+        child->setSnapshot(snapshot);
+    }
+}
+
+SnapshotItem* TreeLeafItem::snapshot() const
+{
+    return m_snapshot;
+}
+
+TreeLeafItem* TreeLeafItem::chainEnd() const
+{
+    return m_chainEnd;
+}
+
+void TreeLeafItem::updateChains()
+{
+    foreach (TreeLeafItem* child, m_children) {
+        child->updateChains();
+    }
+    if (m_children.size() == 1 && m_children.first()->m_cost == m_cost) {
+        m_chainEnd = m_children.first()->m_chainEnd;
+    } else {
+        m_chainEnd = this;
+    }
+}
@@ -29,6 +29,9 @@
 
 namespace Massif {
 
+class Symbol;
+class SnapshotItem;
+
 class MASSIFDATA_EXPORT TreeLeafItem
 {
 public:
@@ -44,6 +47,16 @@ public:
      */
     QString label() const;
 
+    /**
+     * Sets the label for this leaf item to the one of @p symbol.
+     * The symbol is owned by the symbol table of the file.
+     */
+    void setSymbol(const Symbol* symbol);
+    /**
+     * @return The parsed label of this item or zero, if only a plain label was set.
+     */
+    const Symbol* symbol() const;
+
     /**
      * Sets the cost for this item in bytes.
      */
@@ -53,6 +66,15 @@ public:
      */
     unsigned long cost() const;
 
+    /**
+     * Sets the number of recursive calls that were folded into this item.
+     */
+    void setRecursionDepth(const unsigned int depth);
+    /**
+     * @return The number of recursive calls folded into this item, 1 if it is not recursive.
+     */
+    unsigned int recursionDepth() const;
+
     /**
      * Adds @p leaf as child of this item.
      * This item takes ownership.
@@ -76,12 +98,47 @@ public:
      */
     TreeLeafItem* parent() const;
 
+    /**
+     * @return The position of this item in the children of its parent, or zero for the root node.
+     */
+    int row() const;
+
+    /**
+     * Sets the snapshot whose heap tree this item is part of, for this item and all items below it.
+     * This is done by @c SnapshotItem::setHeapTree(), children added afterwards inherit it.
+     */
+    void setSnapshot(SnapshotItem* snapshot);
+    /**
+     * @return The snapshot whose heap tree this item is part of, or zero.
+     */
+    SnapshotItem* snapshot() const;
+
+    /**
+     * @return The end of the chain of single children with the same cost below
+     *         this item, i.e. the first fork or leaf, or this item itself.
+     *
+     * @see updateChains()
+     */
+    TreeLeafItem* chainEnd() const;
+
+    /**
+     * Recomputes the chain ends of this item and all items below it.
+     * This needs to be called whenever the tree was changed,
+     * the parser does it for all heap trees.
+     */
+    void updateChains();
+
 private:
     QString m_label;
+    const Symbol* m_symbol;
     unsigned long m_cost;
+    unsigned int m_recursionDepth;
     QList<TreeLeafItem*> m_children;
 
     TreeLeafItem* m_parent;
+    TreeLeafItem* m_chainEnd;
+    SnapshotItem* m_snapshot;
+    int m_row;
 };
 
 }
@@ -23,26 +23,75 @@
 #include "modeltest.h"
 
 #include "massifdata/parser.h"
+#include "massifdata/filemerger.h"
 #include "massifdata/filedata.h"
+#include "massifdata/costkernels.h"
 #include "massifdata/snapshotitem.h"
+#include "massifdata/symbol.h"
+#include "massifdata/symboltable.h"
 #include "massifdata/treeleafitem.h"
 
 #include "visualizer/totalcostmodel.h"
 #include "visualizer/detailedcostmodel.h"
 #include "visualizer/datatreemodel.h"
+#include "visualizer/datatreesearch.h"
+#include "visualizer/filtereddatatreemodel.h"
+#include "visualizer/deltatreegenerator.h"
+#include "visualizer/dotgraphgenerator.h"
+#include "visualizer/deltatreeitem.h"
+#include "visualizer/deltatreemodel.h"
+#include "visualizer/timeseriesindex.h"
+#include "visualizer/trendanalyzer.h"
+#include "visualizer/trendmodel.h"
+#include "visualizer/componentgrouper.h"
+#include "visualizer/componentcostmodel.h"
+#include "visualizer/callertreegenerator.h"
+#include "visualizer/callertreeitem.h"
+#include "visualizer/callertreemodel.h"
+#include "visualizer/heatmap.h"
+#include "visualizer/sparklinedelegate.h"
+#include "visualizer/treemaplayouter.h"
+#include "visualizer/flamegraphlayouter.h"
+#include "visualizer/timewindowindex.h"
+#include "visualizer/recursionfolder.h"
+#include "visualizer/labelsearchindex.h"
 #include "visualizer/util.h"
 
 #include <QtCore/QFile>
+#include <QtCore/QPointer>
+#include <QtCore/QSet>
 #include <QtTest/QTest>
+#include <QtTest/QSignalSpy>
 #include <QtCore/QDebug>
 
 #include <KConfigGroup>
+#include <KLocalizedString>
+#include <climits>
+#include <cmath>
 #include <qtest_kde.h>
 
 QTEST_KDEMAIN(DataModelTest, GUI)
 
 using namespace Massif;
 
+/// the massif output of kate, which most tests are run on
+static QString kateFile()
+{
+    return QString(KDESRCDIR) + "/data/massif.out.kate";
+}
+
+/// @return The parsed kateFile(), owned by the caller, or zero on errors.
+///         If @p parser is given it is used, e.g. to prune the heap trees.
+static FileData* parseKate(Parser* parser = 0)
+{
+    QFile file(kateFile());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+    Parser defaultParser;
+    return (parser ? parser : &defaultParser)->parse(&file);
+}
+
 void DataModelTest::parseFile()
 {
     const QString path = QString(KDESRCDIR) + "/data/massif.out.kate";
@@ -80,6 +129,19 @@ void DataModelTest::parseFile()
                 QVERIFY(model->data(model->index(r, 0)).toDouble() > model->data(model->index(r - 1, 0)).toDouble());
             }
         }
+        // datasets are ordered by their peak cost
+        model->setMaximumDatasetCount(INT_MAX);
+        const QMap<QModelIndex, TreeLeafItem*> peaks = model->peaks();
+        QVector<unsigned long> peakCosts(peaks.size(), 0);
+        QMap<QModelIndex, TreeLeafItem*>::const_iterator it = peaks.constBegin();
+        for (; it != peaks.constEnd(); ++it) {
+            peakCosts[it.key().column() / 2] = it.value()->cost();
+            QCOMPARE(model->itemForIndex(it.key()).first->label(), it.value()->label());
+            QCOMPARE(model->indexForTreeLeaf(it.value()).column(), it.key().column());
+        }
+        for (int i = 1; i < peakCosts.size(); ++i) {
+            QVERIFY(peakCosts.at(i) <= peakCosts.at(i - 1));
+        }
         // remove data
         model->setSource(0);
     }
@@ -129,7 +191,1464 @@ void DataModelTest::shortenTemplates()
     KConfigGroup conf = KGlobal::config()->group(QLatin1String("Settings"));
 
     conf.writeEntry(QLatin1String("shortenTemplates"), true);
+    reloadFormatSettings();
     QCOMPARE(prettyLabel(id), idShortened);
     conf.writeEntry(QLatin1String("shortenTemplates"), false);
+    reloadFormatSettings();
     QCOMPARE(prettyLabel(id), id);
 }
+
+static TreeLeafItem* addLeaf(TreeLeafItem* parent, const QString& label, unsigned long cost)
+{
+    TreeLeafItem* leaf = new TreeLeafItem;
+    leaf->setLabel(label);
+    leaf->setCost(cost);
+    if (parent) {
+        parent->addChild(leaf);
+    }
+    return leaf;
+}
+
+void DataModelTest::deltaTree()
+{
+    FileData* data = parseKate();
+    QVERIFY(data);
+    // released when the last handle goes out of scope
+    const FileDataHandle handle(data);
+
+    QList<SnapshotItem*> detailed;
+    foreach (SnapshotItem* snapshot, data->snapshots()) {
+        if (snapshot->heapTree()) {
+            detailed << snapshot;
+        }
+    }
+    QVERIFY(detailed.size() >= 2);
+    SnapshotItem* before = detailed.first();
+    SnapshotItem* after = detailed.last();
+
+    DeltaTreeGenerator generator(handle, before, after);
+    generator.run();
+    DeltaTreeItem* root = generator.takeResult();
+    QVERIFY(root);
+    QCOMPARE(root->delta(), long(after->memHeap()) - long(before->memHeap()));
+    QVERIFY(!root->children().isEmpty());
+    for (int i = 0; i < root->children().size(); ++i) {
+        DeltaTreeItem* child = root->children().at(i);
+        QVERIFY(child->delta() != 0 || !child->children().isEmpty());
+        QCOMPARE(child->row(), i);
+        if (i) {
+            QVERIFY(qAbs(child->delta()) <= qAbs(root->children().at(i - 1)->delta()));
+        }
+    }
+
+    DeltaTreeModel* model = new DeltaTreeModel(this);
+    new ModelTest(model, this);
+    model->setSource(root, before, after);
+    QCOMPARE(model->rowCount(), 1);
+    QCOMPARE(model->rowCount(model->index(0, 0)), root->children().size());
+    model->setSource(0, 0, 0);
+
+    // the cost of a node did not change, but moved between its callers
+    SnapshotItem shiftedBefore;
+    shiftedBefore.setMemHeap(100);
+    TreeLeafItem* beforeAlloc = addLeaf(addLeaf(0, "root", 100), "0x1: alloc() (alloc.cpp:1)", 100);
+    addLeaf(beforeAlloc, "0x2: foo() (foo.cpp:1)", 60);
+    addLeaf(beforeAlloc, "0x3: bar() (bar.cpp:1)", 40);
+    shiftedBefore.setHeapTree(beforeAlloc->parent());
+    SnapshotItem shiftedAfter;
+    shiftedAfter.setMemHeap(100);
+    TreeLeafItem* afterAlloc = addLeaf(addLeaf(0, "root", 100), "0x1: alloc() (alloc.cpp:1)", 100);
+    addLeaf(afterAlloc, "0x2: foo() (foo.cpp:1)", 30);
+    addLeaf(afterAlloc, "0x3: bar() (bar.cpp:1)", 60);
+    addLeaf(afterAlloc, "0x4: unchanged() (unchanged.cpp:1)", 0);
+    shiftedAfter.setHeapTree(afterAlloc->parent());
+
+    DeltaTreeGenerator shifted(FileDataHandle(), &shiftedBefore, &shiftedAfter);
+    shifted.run();
+    root = shifted.takeResult();
+    QVERIFY(root);
+    QCOMPARE(root->children().size(), 1);
+    QCOMPARE(root->children().first()->delta(), 0l);
+    QCOMPARE(root->children().first()->children().size(), 2);
+    // sorted by the absolute delta
+    QCOMPARE(root->children().first()->children().first()->delta(), -30l);
+    delete root;
+}
+
+void DataModelTest::trends()
+{
+    FileData* data = parseKate();
+    QVERIFY(data);
+    const FileDataHandle handle(data);
+
+    TrendAnalyzer analyzer(handle);
+    analyzer.run();
+    TimeSeriesIndex* index = analyzer.takeIndex();
+    QVERIFY(index);
+    QVERIFY(index->labelCount() > 0);
+    QCOMPARE(analyzer.trends().size(), index->labelCount());
+
+    // every top level node of every snapshot must be found in the index
+    for (int i = 0; i < index->snapshotCount(); ++i) {
+        foreach (TreeLeafItem* node, index->snapshots().at(i)->heapTree()->children()) {
+            if (isBelowThreshold(node->label())) {
+                continue;
+            }
+            const int id = index->labelId(node->label());
+            QVERIFY(id != -1);
+            QVERIFY(index->cost(id, i) >= node->cost());
+            QVERIFY(index->node(id, i));
+            QCOMPARE(index->node(id, i)->label(), node->label());
+            QVERIFY(index->node(id, i)->cost() >= node->cost());
+        }
+    }
+
+    // trends are ranked by their score
+    const QVector<Trend> trends = analyzer.trends();
+    for (int i = 1; i < trends.size(); ++i) {
+        QVERIFY(trends.at(i).score <= trends.at(i - 1).score);
+        QVERIFY(trends.at(i).monotonicity >= -1 && trends.at(i).monotonicity <= 1);
+    }
+    QVector<double> times;
+    foreach (SnapshotItem* snapshot, index->snapshots()) {
+        times << snapshot->time();
+    }
+    const Trend top = TrendAnalyzer::fit(index, times, trends.first().label);
+    QCOMPARE(top.score, trends.first().score);
+
+    TrendModel* model = new TrendModel(this);
+    new ModelTest(model, this);
+    model->setSource(index, trends);
+    QCOMPARE(model->rowCount(), trends.size());
+    // sorting keeps persistent indices on their trend
+    const QPersistentModelIndex current = model->index(0, TrendModel::GrowthColumn);
+    const int label = model->labelForIndex(current);
+    model->sort(TrendModel::PeakColumn, Qt::AscendingOrder);
+    QCOMPARE(model->labelForIndex(current), label);
+    QCOMPARE(current.column(), int(TrendModel::GrowthColumn));
+    for (int i = 1; i < model->rowCount(); ++i) {
+        QVERIFY(model->trends().at(i).peak >= model->trends().at(i - 1).peak);
+    }
+    model->sort(TrendModel::PeakColumn, Qt::DescendingOrder);
+    QCOMPARE(model->labelForIndex(current), label);
+    model->setSource(0, QVector<Trend>());
+}
+
+void DataModelTest::componentGrouping()
+{
+    FileData* data = parseKate();
+    QVERIFY(data);
+
+    QList<ComponentGrouper::Rule> rules;
+    rules << qMakePair(QString("^KDevelop::"), QString("kdevplatform"))
+          << qMakePair(QString("^Q[A-Z]"), QString("Qt"));
+
+    for (int mode = ComponentGrouper::ByObject; mode <= ComponentGrouper::ByRules; ++mode) {
+        ComponentGrouper grouper(static_cast<ComponentGrouper::Mode>(mode), rules);
+        foreach (SnapshotItem* snapshot, data->snapshots()) {
+            if (!snapshot->heapTree()) {
+                continue;
+            }
+            // every byte is attributed to exactly one component
+            const QVector<unsigned long> costs = grouper.aggregate(snapshot->heapTree());
+            QVERIFY(costs.size() <= grouper.componentCount());
+            unsigned long sum = 0;
+            foreach (unsigned long cost, costs) {
+                sum += cost;
+            }
+            QCOMPARE(sum, snapshot->heapTree()->cost());
+        }
+        QVERIFY(grouper.componentCount() > 0);
+    }
+
+    ComponentGrouper grouper(ComponentGrouper::ByObject);
+    const int qtCore = grouper.classify("0x6F675AB: QByteArray::resize(int) (in /usr/lib/libQtCore.so.4.5.2)");
+    QVERIFY(qtCore != -1);
+    QCOMPARE(grouper.component(qtCore), QString("libQtCore.so.4.5.2"));
+    QCOMPARE(grouper.classify("0x6F675AB: QByteArray::reserve(int) (in /usr/lib/libQtCore.so.4.5.2)"), qtCore);
+
+    // the first matching rule wins
+    ComponentGrouper ruleGrouper(ComponentGrouper::ByRules, QList<ComponentGrouper::Rule>() << rules
+                                 << qMakePair(QString("::"), QString("namespaced")));
+    const int kdevplatform = ruleGrouper.classify("0x6F675AB: KDevelop::DUChain::lock() (duchain.cpp:42)");
+    QVERIFY(kdevplatform != -1);
+    QCOMPARE(ruleGrouper.component(kdevplatform), QString("kdevplatform"));
+    const int namespaced = ruleGrouper.classify("0x6F675AB: Kate::View::foo() (view.cpp:42)");
+    QVERIFY(namespaced != -1);
+    QCOMPARE(ruleGrouper.component(namespaced), QString("namespaced"));
+    QCOMPARE(ruleGrouper.classify("0x6F675AB: main (main.cpp:42)"), -1);
+
+    ComponentCostModel* model = new ComponentCostModel(this);
+    new ModelTest(model, this);
+    model->setSource(data, ComponentGrouper(ComponentGrouper::ByObject));
+    QVERIFY(model->rowCount() > 1);
+    QVERIFY(model->columnCount() > 0);
+    QVERIFY(!model->snapshotForRow(0));
+    QVERIFY(model->snapshotForRow(1));
+    model->setSource(data, ComponentGrouper(ComponentGrouper::ByRules, rules));
+    model->setSource(0);
+
+    // the caller tree can be grouped the same way, with the same costs per component
+    const FileDataHandle handle(data);
+    CallerTreeGenerator generator(handle, QList<SnapshotItem*>() << data->peak());
+    generator.setGrouper(ComponentGrouper(ComponentGrouper::ByObject));
+    generator.run();
+    CallerTreeItem* root = generator.takeResult();
+    QVERIFY(root);
+    QHash<QString, unsigned long> componentCosts;
+    const QVector<unsigned long> peakCosts = grouper.aggregate(data->peak()->heapTree());
+    for (int id = 0; id < peakCosts.size(); ++id) {
+        if (peakCosts.at(id)) {
+            componentCosts.insert(grouper.component(id), peakCosts.at(id));
+        }
+    }
+    QCOMPARE(root->children().size(), componentCosts.size());
+    foreach (CallerTreeItem* component, root->children()) {
+        QCOMPARE(component->cost(), componentCosts.value(component->function()));
+    }
+    delete root;
+}
+
+void DataModelTest::callerTree()
+{
+    QCOMPARE(CallerTreeGenerator::functionKey("0x6F675AB: QByteArray::resize(int) (in /usr/lib/libQtCore.so.4.5.2)"),
+             QString("QByteArray::resize(int)"));
+    QCOMPARE(CallerTreeGenerator::functionKey("0x6F675AB: QByteArray::resize(int) (in /usr/lib/libQtCore.so.4.5.2)"),
+             CallerTreeGenerator::functionKey("0x6F67000: QByteArray::resize(int) (in /usr/lib/libQtCore.so.4.5.2)"));
+    QCOMPARE(CallerTreeGenerator::functionKey("0x5FFDF56: ??? (in /usr/lib/libkdecore.so.5.3.0)"),
+             QString("??? (in /usr/lib/libkdecore.so.5.3.0)"));
+
+    FileData* data = parseKate();
+    QVERIFY(data);
+    const FileDataHandle handle(data);
+
+    // single snapshot: costs on every level add up to the heap cost
+    CallerTreeGenerator peakGenerator(handle, QList<SnapshotItem*>() << data->peak());
+    peakGenerator.run();
+    CallerTreeItem* root = peakGenerator.takeResult();
+    QVERIFY(root);
+    QCOMPARE(root->cost(), data->peak()->heapTree()->cost());
+    unsigned long sum = 0;
+    QSet<QString> functions;
+    foreach (CallerTreeItem* item, root->children()) {
+        sum += item->cost();
+        QVERIFY(!functions.contains(item->function()));
+        functions << item->function();
+        if (item->row() > 0) {
+            QVERIFY(item->cost() <= root->children().at(item->row() - 1)->cost());
+        }
+    }
+    unsigned long expected = 0;
+    foreach (TreeLeafItem* node, data->peak()->heapTree()->children()) {
+        expected += node->cost();
+    }
+    QCOMPARE(sum, expected);
+    QVERIFY(root->children().size() <= data->peak()->heapTree()->children().size());
+
+    CallerTreeModel* model = new CallerTreeModel(this);
+    new ModelTest(model, this);
+    model->setSource(root, data->peak(), data->peak());
+    QCOMPARE(model->rowCount(), root->children().size());
+
+    // all snapshots: costs are averaged
+    CallerTreeGenerator generator(handle, data->snapshots());
+    generator.run();
+    root = generator.takeResult();
+    QVERIFY(root);
+    quint64 total = 0;
+    foreach (SnapshotItem* snapshot, generator.snapshots()) {
+        total += snapshot->heapTree()->cost();
+    }
+    QCOMPARE(root->cost(), (unsigned long)(total / generator.snapshots().size()));
+    model->setSource(root, generator.snapshots().first(), generator.snapshots().last());
+    model->setSource(0, 0, 0);
+}
+
+void DataModelTest::heatMap()
+{
+    FileData* data = parseKate();
+    QVERIFY(data);
+    const FileDataHandle handle(data);
+
+    TrendAnalyzer analyzer(handle);
+    analyzer.run();
+    TimeSeriesIndex* index = analyzer.takeIndex();
+    QVERIFY(index);
+
+    HeatMap map;
+    map.setSource(index, analyzer.trends(), HeatMap::ByPeak);
+    QCOMPARE(map.rowCount(), index->labelCount());
+    QCOMPARE(map.columnCount(), index->snapshotCount());
+    QCOMPARE(map.image().size(), QSize(map.columnCount(), map.rowCount()));
+
+    quint64 lastPeak = Q_UINT64_C(0xffffffffffffffff);
+    for (int row = 0; row < map.rowCount(); ++row) {
+        const int label = map.labelForRow(row);
+        QCOMPARE(map.rowForLabel(label), row);
+        quint64 peak = 0;
+        for (int column = 0; column < map.columnCount(); ++column) {
+            QCOMPARE(map.cost(row, column), index->cost(label, column));
+            // cells without cost are transparent
+            QCOMPARE(qAlpha(map.image().pixel(column, row)) == 0, map.cost(row, column) == 0);
+            peak = qMax(peak, map.cost(row, column));
+        }
+        QVERIFY(peak <= lastPeak);
+        lastPeak = peak;
+    }
+
+    map.setSource(index, analyzer.trends(), HeatMap::ByGrowth);
+    foreach (const Trend& trend, analyzer.trends()) {
+        if (trend.label == map.labelForRow(0)) {
+            QCOMPARE(trend.score, analyzer.trends().first().score);
+        }
+    }
+
+    map.setSource(0, QVector<Trend>(), HeatMap::ByPeak);
+    QCOMPARE(map.rowCount(), 0);
+    QVERIFY(map.image().isNull());
+
+    delete index;
+}
+
+void DataModelTest::sparklines()
+{
+    FileData* data = parseKate();
+    QVERIFY(data);
+
+    DataTreeModel* model = new DataTreeModel(this);
+    model->setSource(data);
+    const QModelIndex peak = model->indexForSnapshot(data->peak());
+    QVERIFY(!peak.data(DataTreeModel::TreeItemRole).isValid());
+    const QModelIndex child = model->index(0, 0, peak);
+    QCOMPARE(child.data(DataTreeModel::TreeItemRole).value<TreeLeafItem*>(),
+             data->peak()->heapTree()->children().first());
+
+    TimeSeriesIndex index(data);
+    SparklineDelegate delegate;
+    delegate.setSeriesIndex(&index);
+    const int label = index.labelId(data->peak()->heapTree()->children().first()->label());
+    QVERIFY(label != -1);
+    const QPixmap sparkline = delegate.sparkline(label, QSize(60, 16), Qt::black);
+    QCOMPARE(sparkline.size(), QSize(60, 16));
+    // rendered only once
+    QCOMPARE(delegate.sparkline(label, QSize(60, 16), Qt::black).cacheKey(), sparkline.cacheKey());
+    QVERIFY(delegate.sparkline(label, QSize(60, 16), Qt::white).cacheKey() != sparkline.cacheKey());
+
+    delegate.setSeriesIndex(0);
+    model->setSource(0);
+    delete data;
+}
+
+void DataModelTest::treeMap()
+{
+    FileData* data = parseKate();
+    QVERIFY(data);
+
+    TreeLeafItem* root = data->peak()->heapTree();
+    QVERIFY(root);
+    QList<TreeLeafItem*> children = root->children();
+    unsigned long total = 0;
+    foreach (TreeLeafItem* child, children) {
+        total += child->cost();
+    }
+    QVERIFY(total);
+
+    const QRectF rect(0, 0, 400, 300);
+    QVector<TreeMapTile> tiles;
+    TreeMapLayouter::squarify(children, rect, 0, tiles);
+    QVERIFY(!tiles.isEmpty());
+    QVERIFY(tiles.size() <= children.size());
+
+    qreal area = 0;
+    foreach (const TreeMapTile& tile, tiles) {
+        QCOMPARE(tile.depth, 0);
+        QVERIFY(tile.node->cost());
+        // allow for rounding errors at the borders
+        QVERIFY(rect.adjusted(-0.01, -0.01, 0.01, 0.01).contains(tile.rect));
+        const qreal tileArea = tile.rect.width() * tile.rect.height();
+        // area proportional to cost
+        QVERIFY(qAbs(tileArea - qreal(tile.node->cost()) / total * rect.width() * rect.height()) < 0.1);
+        area += tileArea;
+    }
+    QVERIFY(qAbs(area - rect.width() * rect.height()) < 1);
+
+    // synchronous layout, level by level
+    TreeMapLayouter layouter(root, rect, 3, 16);
+    layouter.run();
+    tiles = layouter.takeTiles();
+    QVERIFY(!tiles.isEmpty());
+    int lastDepth = 0;
+    foreach (const TreeMapTile& tile, tiles) {
+        QVERIFY(tile.depth >= lastDepth);
+        QVERIFY(tile.depth < 3);
+        lastDepth = tile.depth;
+    }
+    QVERIFY(layouter.takeTiles().isEmpty());
+
+    delete data;
+}
+
+void DataModelTest::timeWindow()
+{
+    // three series over seven snapshots
+    QVector<double> times;
+    times << 0 << 10 << 20 << 30 << 40 << 50 << 60;
+    QVector<quint64> costs;
+    costs << 1 << 2 << 3 << 4 << 5 << 6 << 7
+          << 9 << 0 << 0 << 0 << 0 << 0 << 9
+          << 0 << 0 << 5 << 5 << 5 << 0 << 0;
+    TimeWindowIndex index;
+    index.build(times, costs);
+    QCOMPARE(index.seriesCount(), 3);
+    QCOMPARE(index.snapshotCount(), 7);
+
+    QCOMPARE(index.snapshotRange(15, 45), qMakePair(2, 4));
+    QCOMPARE(index.snapshotRange(45, 15), qMakePair(2, 4));
+    QCOMPARE(index.snapshotRange(20, 20), qMakePair(2, 2));
+    QCOMPARE(index.snapshotRange(21, 29), qMakePair(-1, -1));
+    QCOMPARE(index.snapshotRange(-10, 100), qMakePair(0, 6));
+
+    // compare against brute force
+    for (int series = 0; series < 3; ++series) {
+        for (int first = 0; first < 7; ++first) {
+            for (int last = first; last < 7; ++last) {
+                quint64 max = 0;
+                quint64 sum = 0;
+                for (int i = first; i <= last; ++i) {
+                    max = qMax(max, costs.at(series * 7 + i));
+                    sum += costs.at(series * 7 + i);
+                }
+                QCOMPARE(index.maximum(series, first, last), max);
+                QCOMPARE(index.average(series, first, last), double(sum) / (last - first + 1));
+            }
+        }
+    }
+
+    // long ranges are looked up in the segment tree
+    QVector<double> longTimes;
+    QVector<quint64> longCosts;
+    for (int i = 0; i < 301; ++i) {
+        longTimes << i;
+        longCosts << quint64((i * 7919) % 1009);
+    }
+    TimeWindowIndex longIndex;
+    longIndex.build(longTimes, longCosts);
+    for (int first = 0; first < 301; first += 13) {
+        for (int last = first; last < 301; last += 17) {
+            QCOMPARE(longIndex.maximum(0, first, last), maxCost(longCosts.constData() + first, last - first + 1));
+        }
+    }
+
+    QCOMPARE(index.topK(3, 0, 6, TimeWindowIndex::ByMaximum), QVector<int>() << 1 << 0 << 2);
+    QCOMPARE(index.topK(3, 2, 4, TimeWindowIndex::ByMaximum), QVector<int>() << 2 << 0);
+    QCOMPARE(index.topK(1, 2, 4, TimeWindowIndex::ByAverage), QVector<int>() << 2);
+    QCOMPARE(index.topK(3, 0, 6, TimeWindowIndex::ByAverage), QVector<int>() << 0 << 1 << 2);
+    QCOMPARE(index.topK(3, 1, 1, TimeWindowIndex::ByAverage), QVector<int>() << 0);
+
+    // re-rank the stacked functions of a real file
+    FileData* data = parseKate();
+    QVERIFY(data);
+
+    DetailedCostModel* model = new DetailedCostModel(this);
+    new ModelTest(model, this);
+    model->setSource(data);
+    model->setMaximumDatasetCount(INT_MAX);
+    const int columns = model->columnCount();
+    QVERIFY(columns > 4);
+    QStringList globalOrder;
+    for (int column = 0; column < columns; column += 2) {
+        globalOrder << model->headerData(column, Qt::Horizontal).toString();
+    }
+
+    const int rows = model->rowCount();
+    const double t0 = model->index(1, 0).data().toDouble();
+    const double t1 = model->index(rows / 3, 0).data().toDouble();
+    QSignalSpy resets(model, SIGNAL(modelReset()));
+    const QPersistentModelIndex second = model->index(1, 2);
+    QVERIFY(model->rankByTimeWindow(t0, t1, TimeWindowIndex::ByMaximum));
+    QCOMPARE(model->columnCount(), columns);
+    // the columns are only reordered
+    QCOMPARE(resets.count(), 0);
+    QVERIFY(second.isValid());
+    QCOMPARE(model->headerData(second.column(), Qt::Horizontal).toString(), globalOrder.at(1));
+    QStringList rankedOrder;
+    for (int column = 0; column < columns; column += 2) {
+        rankedOrder << model->headerData(column, Qt::Horizontal).toString();
+    }
+    double lastMax = -1;
+    // skip the other functions
+    for (int column = 1; column < columns - 2; column += 2) {
+        double max = 0;
+        for (int row = 1; row <= rows / 3; ++row) {
+            max = qMax(max, model->index(row, column).data().toDouble());
+        }
+        if (lastMax != -1) {
+            QVERIFY(max <= lastMax);
+        }
+        lastMax = max;
+    }
+
+    model->resetRanking();
+    for (int column = 0; column < columns; column += 2) {
+        QCOMPARE(model->headerData(column, Qt::Horizontal).toString(), globalOrder.at(column / 2));
+    }
+
+    // only the shown datasets get ranked
+    model->setMaximumDatasetCount(2);
+    QVERIFY(model->rankByTimeWindow(t0, t1, TimeWindowIndex::ByMaximum));
+    for (int column = 0; column < 4; column += 2) {
+        QCOMPARE(model->headerData(column, Qt::Horizontal).toString(), rankedOrder.at(column / 2));
+    }
+    QCOMPARE(resets.count(), 0);
+
+    model->setSource(0);
+    delete data;
+}
+
+void DataModelTest::otherDataset()
+{
+    FileData* data = parseKate();
+    QVERIFY(data);
+
+    DetailedCostModel* model = new DetailedCostModel(this);
+    new ModelTest(model, this);
+    model->setSource(data);
+
+    QList<SnapshotItem*> snapshots;
+    foreach (SnapshotItem* snapshot, data->snapshots()) {
+        if (snapshot->heapTree()) {
+            snapshots << snapshot;
+        }
+    }
+    QCOMPARE(model->rowCount(), snapshots.size() + 1);
+
+    qRegisterMetaType<QModelIndex>("QModelIndex");
+    for (int count = 0; count < 4; ++count) {
+        QSignalSpy spy(model, SIGNAL(dataChanged(QModelIndex,QModelIndex)));
+        model->setMaximumDatasetCount(count);
+        QCOMPARE(model->columnCount(), (count + 1) * 2);
+        // the costs of the other functions changed
+        QCOMPARE(spy.count(), 1);
+        QCOMPARE(spy.first().first().value<QModelIndex>().column(), count * 2);
+        QVERIFY(model->isOtherColumn(count * 2));
+        QVERIFY(model->isOtherColumn(count * 2 + 1));
+        QVERIFY(!model->isOtherColumn(0) || count == 0);
+        QCOMPARE(model->headerData(count * 2, Qt::Horizontal).toString(), i18n("other"));
+
+        // the stacked costs add up to the heap size
+        for (int row = 1; row < model->rowCount(); ++row) {
+            double sum = 0;
+            for (int column = 1; column < model->columnCount(); column += 2) {
+                const double cost = model->index(row, column).data().toDouble();
+                QVERIFY(cost >= 0);
+                sum += cost;
+            }
+            QCOMPARE(sum, double(snapshots.at(row - 1)->memHeap()));
+        }
+    }
+
+    // hidden functions end up in the other dataset
+    model->setMaximumDatasetCount(3);
+    const QModelIndex first = model->index(1, 1);
+    TreeLeafItem* node = model->itemForIndex(first).first;
+    if (!node) {
+        node = model->itemForIndex(model->index(model->rowCount() - 1, 1)).first;
+    }
+    QVERIFY(node);
+    model->hideFunction(node);
+    QCOMPARE(model->columnCount(), 8);
+    for (int row = 1; row < model->rowCount(); ++row) {
+        double sum = 0;
+        for (int column = 1; column < model->columnCount(); column += 2) {
+            sum += model->index(row, column).data().toDouble();
+        }
+        QCOMPARE(sum, double(snapshots.at(row - 1)->memHeap()));
+    }
+
+    model->setSource(0);
+    delete data;
+}
+
+void DataModelTest::mergeFiles()
+{
+    FileData* data = parseKate();
+    QVERIFY(data);
+
+    // parse in parallel and merge
+    QFile file(kateFile());
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QFile file2(kateFile());
+    QVERIFY(file2.open(QIODevice::ReadOnly));
+    FileMerger merger;
+    FileData* merged = merger.merge(QList<QIODevice*>() << &file << &file2);
+    QVERIFY(merged);
+    QCOMPARE(merger.errorFile(), -1);
+    QCOMPARE(merged->timeUnit(), data->timeUnit());
+    QCOMPARE(merged->cmd(), data->cmd());
+    QCOMPARE(merged->snapshots().size(), data->snapshots().size());
+    QCOMPARE(merged->snapshots().last()->time(), data->snapshots().last()->time());
+    QVERIFY(merged->peak());
+    QVERIFY(merged->peak()->heapTree());
+    QVERIFY(merged->peak()->memHeap() <= data->peak()->memHeap() * 2);
+
+    double lastTime = -1;
+    foreach (SnapshotItem* snapshot, merged->snapshots()) {
+        QVERIFY(snapshot->time() > lastTime);
+        lastTime = snapshot->time();
+        if (!snapshot->heapTree()) {
+            continue;
+        }
+        // the heap tree matches the heap size
+        QCOMPARE(snapshot->heapTree()->cost(), snapshot->memHeap());
+
+        // the same file merged twice, hence every node costs twice as much as the original
+        SnapshotItem* source = 0;
+        foreach (SnapshotItem* original, data->snapshots()) {
+            if (original->time() > snapshot->time()) {
+                break;
+            }
+            if (original->heapTree()) {
+                source = original;
+            }
+        }
+        QVERIFY(source);
+        QCOMPARE(snapshot->heapTree()->cost(), source->heapTree()->cost() * 2);
+        foreach (TreeLeafItem* child, snapshot->heapTree()->children()) {
+            QCOMPARE(child->parent(), snapshot->heapTree());
+        }
+        QCOMPARE(snapshot->heapTree()->children().size(), source->heapTree()->children().size());
+        QSet<QString> labels;
+        foreach (TreeLeafItem* child, snapshot->heapTree()->children()) {
+            // merged by call path
+            QVERIFY(!labels.contains(child->label()));
+            labels << child->label();
+            // all snapshots share the symbols of the merged file
+            QCOMPARE(child->symbol(), merged->symbols()->find(child->label()));
+            if (isBelowThreshold(child->label())) {
+                continue;
+            }
+            foreach (TreeLeafItem* original, source->heapTree()->children()) {
+                if (original->label() == child->label()) {
+                    QCOMPARE(child->cost(), original->cost() * 2);
+                    QCOMPARE(child->children().size(), original->children().size());
+                }
+            }
+        }
+    }
+    delete merged;
+
+    // different time units can't be merged
+    FileData* other = new FileData;
+    other->setTimeUnit(data->timeUnit() + "x");
+    QVERIFY(!merger.merge(QList<FileData*>() << data << other));
+    QCOMPARE(merger.errorFile(), 1);
+    delete other;
+
+    // merging a single file keeps its data
+    merged = merger.merge(QList<FileData*>() << data);
+    QVERIFY(merged);
+    QCOMPARE(merged->snapshots().size(), data->snapshots().size());
+    delete merged;
+
+    delete data;
+
+    // symbol tables filled concurrently are merged afterwards
+    SymbolTable symbols;
+    const Symbol* foo = symbols.symbol("0x1: foo() (a.cpp:1)");
+    SymbolTable other;
+    const Symbol* otherFoo = other.symbol("0x1: foo() (a.cpp:1)");
+    const Symbol* bar = other.symbol("0x2: bar() (a.cpp:2)");
+    const QHash<const Symbol*, const Symbol*> replaced = symbols.merge(&other);
+    QCOMPARE(other.size(), 0);
+    QCOMPARE(symbols.size(), 2);
+    QCOMPARE(replaced.size(), 1);
+    QCOMPARE(replaced.value(otherFoo), foo);
+    QCOMPARE(symbols.find(bar->label()), bar);
+}
+
+void DataModelTest::recursionFolding()
+{
+    // root -> f -> f -> g
+    //               -> k
+    //           -> k
+    TreeLeafItem* root = addLeaf(0, "(heap allocation functions) malloc/new/new[], --alloc-fns, etc.", 110);
+    TreeLeafItem* f = addLeaf(root, "0x1: f() (a.cpp:1)", 110);
+    TreeLeafItem* recursive = addLeaf(f, "0x2: f() (a.cpp:2)", 70);
+    addLeaf(recursive, "0x3: g() (b.cpp:1)", 50);
+    addLeaf(recursive, "0x4: k() (c.cpp:1)", 20);
+    addLeaf(f, "0x4: k() (c.cpp:1)", 40);
+
+    int frames = 0;
+    SymbolTable symbols;
+    TreeLeafItem* folded = RecursionFolder::fold(root, &symbols, &frames);
+    QCOMPARE(frames, 1);
+    QCOMPARE(folded->cost(), root->cost());
+    QCOMPARE(folded->children().size(), 1);
+    TreeLeafItem* foldedF = folded->children().first();
+    QCOMPARE(foldedF->parent(), folded);
+    QCOMPARE(foldedF->label(), f->label());
+    QCOMPARE(foldedF->cost(), f->cost());
+    QCOMPARE(foldedF->recursionDepth(), 2u);
+    QCOMPARE(foldedF->children().size(), 2);
+    // merged and sorted by cost
+    QCOMPARE(foldedF->children().at(0)->label(), QString("0x4: k() (c.cpp:1)"));
+    QCOMPARE(foldedF->children().at(0)->cost(), 60ul);
+    QCOMPARE(foldedF->children().at(0)->recursionDepth(), 1u);
+    QCOMPARE(foldedF->children().at(1)->label(), QString("0x3: g() (b.cpp:1)"));
+    QCOMPARE(foldedF->children().at(1)->cost(), 50ul);
+    QCOMPARE(foldedF->children().at(1)->parent(), foldedF);
+    QCOMPARE(symbols.find(foldedF->label()), foldedF->symbol());
+    delete folded;
+    delete root;
+
+    // toggling on a real file
+    FileData* data = parseKate();
+    QVERIFY(data);
+
+    QList<TreeLeafItem*> originals;
+    foreach (SnapshotItem* snapshot, data->snapshots()) {
+        originals << snapshot->heapTree();
+    }
+
+    const FileDataHandle handle(data);
+    RecursionFolder* folder = new RecursionFolder(handle);
+    QCOMPARE(folder->data(false), handle);
+    // nothing is folded before it is needed
+    QCOMPARE(folder->foldedFrames(), 0);
+    FileDataHandle folded = folder->data(true);
+    QVERIFY(folded && folded != handle);
+    QCOMPARE(folder->data(true), folded);
+    QVERIFY(folder->foldedFrames() >= 0);
+    QCOMPARE(folded->snapshots().size(), data->snapshots().size());
+    QCOMPARE(folded->snapshots().indexOf(folded->peak()), data->snapshots().indexOf(data->peak()));
+    for (int i = 0; i < data->snapshots().size(); ++i) {
+        // the original data is left alone
+        QCOMPARE(data->snapshots().at(i)->heapTree(), originals.at(i));
+        const SnapshotItem* snapshot = folded->snapshots().at(i);
+        QCOMPARE(snapshot->memHeap(), data->snapshots().at(i)->memHeap());
+        QCOMPARE(snapshot->time(), data->snapshots().at(i)->time());
+        QCOMPARE(!snapshot->heapTree(), !originals.at(i));
+        if (snapshot->heapTree()) {
+            QCOMPARE(snapshot->heapTree()->cost(), originals.at(i)->cost());
+            QCOMPARE(snapshot->heapTree()->snapshot(), snapshot);
+            // the symbols are owned by the folded data
+            QCOMPARE(folded->symbols()->find(snapshot->heapTree()->label()), snapshot->heapTree()->symbol());
+        }
+    }
+
+    // the folded data outlives the folder while it is used
+    const QWeakPointer<const FileData> guard(folded);
+    delete folder;
+    QVERIFY(!guard.isNull());
+    folded.clear();
+    QVERIFY(guard.isNull());
+}
+
+static void verifyChains(TreeLeafItem* node)
+{
+    TreeLeafItem* end = node;
+    while (end->children().size() == 1 && end->children().first()->cost() == end->cost()) {
+        end = end->children().first();
+    }
+    QCOMPARE(node->chainEnd(), end);
+    foreach (TreeLeafItem* child, node->children()) {
+        verifyChains(child);
+    }
+}
+
+void DataModelTest::chainCompression()
+{
+    TreeLeafItem* root = addLeaf(0, "(heap allocation functions) malloc/new/new[], --alloc-fns, etc.", 100);
+    TreeLeafItem* f = addLeaf(root, "0x1: f() (a.cpp:1)", 100);
+    TreeLeafItem* g = addLeaf(f, "0x2: g() (a.cpp:2)", 100);
+    TreeLeafItem* h = addLeaf(g, "0x3: h() (a.cpp:3)", 60);
+    addLeaf(g, "0x4: k() (a.cpp:4)", 40);
+    TreeLeafItem* l = addLeaf(h, "0x5: l() (a.cpp:5)", 50);
+
+    // not computed yet
+    QCOMPARE(root->chainEnd(), root);
+    root->updateChains();
+    QCOMPARE(root->chainEnd(), g);
+    QCOMPARE(f->chainEnd(), g);
+    QCOMPARE(g->chainEnd(), g);
+    // different cost, no chain
+    QCOMPARE(h->chainEnd(), h);
+    QCOMPARE(l->chainEnd(), l);
+    delete root;
+
+    // the parser computes the chains of all heap trees
+    FileData* data = parseKate();
+    QVERIFY(data);
+
+    foreach (SnapshotItem* snapshot, data->snapshots()) {
+        if (snapshot->heapTree()) {
+            verifyChains(snapshot->heapTree());
+        }
+    }
+    delete data;
+}
+
+static void verifySymbols(const FileData* data, const TreeLeafItem* node)
+{
+    QVERIFY(node->symbol());
+    QCOMPARE(node->symbol()->label(), node->label());
+    QCOMPARE(data->symbols()->find(node->label()), node->symbol());
+    QCOMPARE(prettyLabel(node), prettyLabel(node->label()));
+    QCOMPARE(functionInLabel(node), functionInLabel(node->label()));
+    foreach (const TreeLeafItem* child, node->children()) {
+        verifySymbols(data, child);
+    }
+}
+
+void DataModelTest::symbols()
+{
+    {
+    Symbol symbol("0x6F675AB: QByteArray::resize(int) (in /usr/lib/libQtCore.so.4.5.2)");
+    QCOMPARE(symbol.address(), QString("0x6F675AB"));
+    QCOMPARE(symbol.name(), QString("QByteArray::resize(int) (in /usr/lib/libQtCore.so.4.5.2)"));
+    QCOMPARE(symbol.function(), QString("QByteArray::resize(int)"));
+    QCOMPARE(symbol.location(), QString("in /usr/lib/libQtCore.so.4.5.2"));
+    QVERIFY(!symbol.isBelowThreshold());
+    }
+    {
+    Symbol symbol("0x4C2: QList<QString>::append(QString const&) (qlist.h:512)");
+    QCOMPARE(symbol.function(), QString("QList<QString>::append(QString const&)"));
+    QCOMPARE(symbol.shortFunction(), QString("QList<>::append(QString const&)"));
+    QCOMPARE(symbol.shortName(), QString("QList<>::append(QString const&) (qlist.h:512)"));
+    QCOMPARE(symbol.location(), QString("qlist.h:512"));
+    }
+    {
+    Symbol symbol("in 803 places, all below massif's threshold (01.00%)");
+    QVERIFY(symbol.isBelowThreshold());
+    QVERIFY(symbol.address().isEmpty());
+    QVERIFY(symbol.location().isEmpty());
+    }
+    {
+    Symbol symbol("(heap allocation functions) malloc/new/new[], --alloc-fns, etc.");
+    QVERIFY(symbol.address().isEmpty());
+    QVERIFY(symbol.location().isEmpty());
+    QCOMPARE(symbol.function(), symbol.label());
+    }
+
+    SymbolTable table;
+    const Symbol* symbol = table.symbol("0x1: f() (a.cpp:1)");
+    QCOMPARE(table.symbol("0x1: f() (a.cpp:1)"), symbol);
+    QCOMPARE(table.find("0x1: f() (a.cpp:1)"), symbol);
+    QVERIFY(!table.find("0x2: g() (a.cpp:2)"));
+    QCOMPARE(table.size(), 1);
+
+    // the parser parses every unique label once
+    FileData* data = parseKate();
+    QVERIFY(data);
+    QVERIFY(data->symbols()->size() > 0);
+
+    foreach (SnapshotItem* snapshot, data->snapshots()) {
+        if (snapshot->heapTree()) {
+            verifySymbols(data, snapshot->heapTree());
+        }
+    }
+    delete data;
+}
+
+void DataModelTest::costKernels()
+{
+    // odd sizes to cover the remainders of the unrolled loops
+    QVector<quint64> costs;
+    for (int i = 0; i < 37; ++i) {
+        costs << quint64((i * 7919) % 101);
+    }
+    costs[23] = 1000;
+    costs[30] = 1000;
+
+    quint64 sum = 0;
+    quint64 max = 0;
+    foreach (quint64 cost, costs) {
+        sum += cost;
+        max = qMax(max, cost);
+    }
+    QCOMPARE(sumCosts(costs.constData(), costs.size()), sum);
+    QCOMPARE(maxCost(costs.constData(), costs.size()), max);
+    QCOMPARE(argMaxCost(costs.constData(), costs.size()), 23);
+    QCOMPARE(argMaxCost(costs.constData(), 0), -1);
+    QCOMPARE(sumCosts(costs.constData(), 3), costs.at(0) + costs.at(1) + costs.at(2));
+
+    QVector<quint64> sums(costs.size());
+    prefixSums(costs.constData(), costs.size(), sums.data());
+    QCOMPARE(sums.last(), sum);
+    QCOMPARE(sums.at(5), sumCosts(costs.constData(), 6));
+
+    QCOMPARE(firstAtLeast(costs.constData(), costs.size(), 1000), 23);
+    QCOMPARE(firstAtLeast(costs.constData(), costs.size(), 1001), costs.size());
+    QCOMPARE(firstAtLeast(costs.constData(), costs.size(), 0), 0);
+
+    // the parser picks the detailed peak through the columns
+    FileData* data = parseKate();
+    QVERIFY(data);
+
+    const SnapshotColumns& columns = data->columns();
+    QCOMPARE(columns.size(), data->snapshots().size());
+    SnapshotItem* peak = 0;
+    for (int i = 0; i < data->snapshots().size(); ++i) {
+        SnapshotItem* snapshot = data->snapshots().at(i);
+        QCOMPARE(columns.times().at(i), snapshot->time());
+        QCOMPARE(columns.heap().at(i), quint64(snapshot->memHeap()));
+        QCOMPARE(columns.heapExtra().at(i), quint64(snapshot->memHeapExtra()));
+        QCOMPARE(columns.stacks().at(i), quint64(snapshot->memStacks()));
+        if (snapshot->heapTree() && (!peak || snapshot->memHeap() > peak->memHeap())) {
+            peak = snapshot;
+        }
+    }
+    QVERIFY(peak);
+    QCOMPARE(data->peak(), peak);
+
+    double firstTime = 0;
+    foreach (SnapshotItem* snapshot, data->snapshots()) {
+        if (snapshot->memHeap() >= peak->memHeap() * 0.001) {
+            break;
+        }
+        firstTime = snapshot->time();
+    }
+    QCOMPARE(columns.timeBefore(std::ceil(peak->memHeap() * 0.001)), firstTime);
+
+    delete data;
+}
+
+static void countItems(const TreeLeafItem* node, int& items)
+{
+    ++items;
+    foreach (const TreeLeafItem* child, node->children()) {
+        countItems(child, items);
+    }
+}
+
+static void verifyPruned(const TreeLeafItem* node, unsigned long minimum)
+{
+    unsigned long childCost = 0;
+    int belowThreshold = 0;
+    for (int i = 0; i < node->children().size(); ++i) {
+        const TreeLeafItem* child = node->children().at(i);
+        childCost += child->cost();
+        if (i > 0) {
+            QVERIFY(node->children().at(i - 1)->cost() >= child->cost());
+        }
+        if (isBelowThreshold(child->label())) {
+            ++belowThreshold;
+            QVERIFY(child->symbol());
+        } else {
+            QVERIFY(child->cost() >= minimum);
+        }
+        verifyPruned(child, minimum);
+    }
+    QVERIFY(belowThreshold <= 1);
+    QVERIFY(childCost <= node->cost());
+}
+
+void DataModelTest::pruneBelowMinimumCost()
+{
+    FileData* data = parseKate();
+    QVERIFY(data);
+
+    Parser pruningParser;
+    const double percentage = 5;
+    pruningParser.setMinimumCost(1024, percentage);
+    FileData* pruned = parseKate(&pruningParser);
+    QVERIFY(pruned);
+
+    QCOMPARE(pruned->snapshots().size(), data->snapshots().size());
+    int items = 0;
+    int prunedItems = 0;
+    for (int i = 0; i < data->snapshots().size(); ++i) {
+        const SnapshotItem* snapshot = data->snapshots().at(i);
+        const SnapshotItem* prunedSnapshot = pruned->snapshots().at(i);
+        QCOMPARE(prunedSnapshot->memHeap(), snapshot->memHeap());
+        if (!snapshot->heapTree()) {
+            QVERIFY(!prunedSnapshot->heapTree());
+            continue;
+        }
+        const TreeLeafItem* root = snapshot->heapTree();
+        const TreeLeafItem* prunedRoot = prunedSnapshot->heapTree();
+        QCOMPARE(prunedRoot->cost(), root->cost());
+
+        // the costs of pruned call sites end up in the "below threshold" nodes
+        unsigned long childCost = 0;
+        foreach (const TreeLeafItem* child, root->children()) {
+            childCost += child->cost();
+        }
+        unsigned long prunedChildCost = 0;
+        foreach (const TreeLeafItem* child, prunedRoot->children()) {
+            prunedChildCost += child->cost();
+        }
+        QCOMPARE(prunedChildCost, childCost);
+
+        verifyPruned(prunedRoot, qMax(1024ul, static_cast<unsigned long>(snapshot->memHeap() * percentage / 100)));
+        countItems(root, items);
+        countItems(prunedRoot, prunedItems);
+    }
+    QVERIFY(prunedItems < items);
+
+    delete pruned;
+    delete data;
+}
+
+void DataModelTest::sharedData()
+{
+    FileData* data = parseKate();
+    QVERIFY(data);
+    QPointer<FileData> guard(data);
+
+    FileDataHandle handle(data);
+    CallerTreeGenerator* generator = new CallerTreeGenerator(handle, data->snapshots());
+
+    // the worker keeps the data alive after the file got closed
+    handle.clear();
+    QVERIFY(guard);
+    generator->run();
+    CallerTreeItem* root = generator->takeResult();
+    QVERIFY(root);
+    delete root;
+
+    // the last reader releases it
+    delete generator;
+    QVERIFY(!guard);
+}
+
+static void verifyStackedCosts(DetailedCostModel* model, const QList<SnapshotItem*>& detailed)
+{
+    QCOMPARE(model->rowCount(), detailed.size() + 1);
+    for (int row = 1; row < model->rowCount(); ++row) {
+        double cost = 0;
+        for (int column = 1; column < model->columnCount(); column += 2) {
+            cost += model->data(model->index(row, column)).toDouble();
+        }
+        QCOMPARE(cost, double(detailed.at(row - 1)->memHeap()));
+    }
+}
+
+static TreeLeafItem* findLabel(TreeLeafItem* node, const QString& label)
+{
+    if (node->label() == label) {
+        return node;
+    }
+    foreach (TreeLeafItem* child, node->children()) {
+        if (TreeLeafItem* found = findLabel(child, label)) {
+            return found;
+        }
+    }
+    return 0;
+}
+
+static QStringList shownLabels(DetailedCostModel* model)
+{
+    QVector<QString> labels(model->columnCount() / 2 - 1);
+    const QMap<QModelIndex, TreeLeafItem*> peaks = model->peaks();
+    QMap<QModelIndex, TreeLeafItem*>::const_iterator it = peaks.constBegin();
+    for (; it != peaks.constEnd(); ++it) {
+        labels[it.key().column() / 2] = it.value()->label();
+    }
+    return labels.toList();
+}
+
+void DataModelTest::hideFunctions()
+{
+    FileData* data = parseKate();
+    QVERIFY(data);
+    QList<SnapshotItem*> detailed;
+    foreach (SnapshotItem* snapshot, data->snapshots()) {
+        if (snapshot->heapTree()) {
+            detailed << snapshot;
+        }
+    }
+
+    DetailedCostModel* model = new DetailedCostModel(this);
+    new ModelTest(model, this);
+    model->setSource(data);
+    model->setMaximumDatasetCount(3);
+    QCOMPARE(model->columnCount(), 8);
+    verifyStackedCosts(model, detailed);
+    QVERIFY(!model->hasHiddenFunctions());
+    QVERIFY(!model->undoHide());
+    QSignalSpy resets(model, SIGNAL(modelReset()));
+
+    const QStringList labels = shownLabels(model);
+    TreeLeafItem* second = 0;
+    foreach (const QModelIndex& index, model->peaks().keys()) {
+        if (index.column() == 2) {
+            second = model->peaks().value(index);
+        }
+    }
+    QVERIFY(second);
+
+    // the next function moves up, the other functions keep their place
+    model->hideFunction(second);
+    QVERIFY(model->hasHiddenFunctions());
+    QCOMPARE(model->columnCount(), 8);
+    QStringList shown = shownLabels(model);
+    QCOMPARE(shown.first(), labels.at(0));
+    QCOMPARE(shown.at(1), labels.at(2));
+    QVERIFY(!shown.contains(second->label()));
+    QVERIFY(!model->indexForTreeLeaf(second).isValid());
+    verifyStackedCosts(model, detailed);
+
+    QVERIFY(model->undoHide());
+    QVERIFY(!model->hasHiddenFunctions());
+    QCOMPARE(shownLabels(model), labels);
+    verifyStackedCosts(model, detailed);
+
+    model->hideOtherFunctions(second);
+    QCOMPARE(model->columnCount(), 4);
+    QCOMPARE(shownLabels(model), QStringList(second->label()));
+    verifyStackedCosts(model, detailed);
+    model->hideFunction(second);
+    QCOMPARE(model->columnCount(), 2);
+    verifyStackedCosts(model, detailed);
+
+    // shown again at its original place
+    model->showFunction(second->label());
+    QCOMPARE(model->columnCount(), 4);
+    QVERIFY(model->undoHide());
+    QCOMPARE(shownLabels(model), labels);
+    QVERIFY(!model->undoHide());
+
+    model->hideFunction(second);
+    model->hideOtherFunctions(second);
+    model->showAllFunctions();
+    QVERIFY(!model->hasHiddenFunctions());
+    QCOMPARE(shownLabels(model), labels);
+    verifyStackedCosts(model, detailed);
+
+    // a function found anywhere in the heap trees, e.g. by the trend analysis
+    TreeLeafItem* leaf = data->peak()->heapTree();
+    while (!leaf->children().isEmpty()) {
+        leaf = leaf->children().last();
+    }
+    QMap<SnapshotItem*, TreeLeafItem*> leafNodes;
+    foreach (SnapshotItem* snapshot, detailed) {
+        if (TreeLeafItem* node = findLabel(snapshot->heapTree(), leaf->label())) {
+            leafNodes[snapshot] = node;
+        }
+    }
+    // the series for such functions is reused
+    for (int i = 0; i < 2; ++i) {
+        model->showOnlyFunction(leaf->label(), leafNodes);
+        QCOMPARE(model->columnCount(), 4);
+        QCOMPARE(shownLabels(model), QStringList(leaf->label()));
+        verifyStackedCosts(model, detailed);
+    }
+    // functions with a dataset of their own keep it
+    model->showOnlyFunction(second->label(), leafNodes);
+    QCOMPARE(model->columnCount(), 4);
+    QCOMPARE(model->peaks().values(), QList<TreeLeafItem*>() << second);
+    QCOMPARE(model->indexForTreeLeaf(second).column(), 0);
+
+    // the other functions can be shown again, without the added one
+    QVERIFY(model->hasHiddenFunctions());
+    QVERIFY(model->undoHide());
+    QCOMPARE(shownLabels(model), labels);
+    verifyStackedCosts(model, detailed);
+    QVERIFY(!model->hasHiddenFunctions());
+
+    model->showOnlyFunction(leaf->label(), leafNodes);
+    QVERIFY(model->undoHide());
+    QCOMPARE(shownLabels(model), labels);
+    verifyStackedCosts(model, detailed);
+
+    model->showOnlyFunction(leaf->label(), leafNodes);
+    model->resetRanking();
+    QCOMPARE(shownLabels(model), QStringList(leaf->label()));
+    model->showFunction(labels.first());
+    QCOMPARE(shownLabels(model), QStringList(labels.first()));
+    verifyStackedCosts(model, detailed);
+    model->showAllFunctions();
+    QVERIFY(!model->hasHiddenFunctions());
+    QCOMPARE(shownLabels(model), labels);
+    verifyStackedCosts(model, detailed);
+    // datasets only get removed and inserted
+    QCOMPARE(resets.count(), 0);
+
+    model->setSource(0);
+    delete data;
+}
+
+static void verifyRows(const TreeLeafItem* node, const SnapshotItem* snapshot)
+{
+    QCOMPARE(node->snapshot(), snapshot);
+    for (int i = 0; i < node->children().size(); ++i) {
+        QCOMPARE(node->children().at(i)->row(), i);
+        QCOMPARE(node->children().at(i)->parent(), node);
+        verifyRows(node->children().at(i), snapshot);
+    }
+}
+
+void DataModelTest::fetchTreeLeafs()
+{
+    FileData* data = parseKate();
+    QVERIFY(data);
+    foreach (SnapshotItem* snapshot, data->snapshots()) {
+        if (snapshot->heapTree()) {
+            verifyRows(snapshot->heapTree(), snapshot);
+        }
+    }
+
+    DataTreeModel* model = new DataTreeModel(this);
+    model->setFetchBatchSize(2);
+    new ModelTest(model, this);
+    model->setSource(data);
+
+    TreeLeafItem* root = data->peak()->heapTree();
+    QVERIFY(root->children().size() > 4);
+    const QModelIndex peak = model->indexForSnapshot(data->peak());
+    QCOMPARE(model->rowCount(peak), 2);
+    QVERIFY(model->canFetchMore(peak));
+    model->fetchMore(peak);
+    QCOMPARE(model->rowCount(peak), 4);
+
+    // the children get fetched as needed
+    TreeLeafItem* last = root->children().last();
+    const QModelIndex index = model->indexForTreeLeaf(last);
+    QVERIFY(index.isValid());
+    QCOMPARE(index.row(), root->children().size() - 1);
+    QCOMPARE(model->parent(index), peak);
+    QCOMPARE(model->rowCount(peak), root->children().size());
+    QVERIFY(!model->canFetchMore(peak));
+    QCOMPARE(model->snapshotForTreeLeaf(last), data->peak());
+    QCOMPARE(model->itemForIndex(index).first, last);
+
+    model->setSource(0);
+    delete data;
+}
+
+void DataModelTest::formatCache()
+{
+    KConfigGroup conf = KGlobal::config()->group(QLatin1String("Settings"));
+    conf.writeEntry(QLatin1String("prettyCostPrecision"), 1);
+    reloadFormatSettings();
+    const QString cost = prettyCost(123456);
+    QCOMPARE(prettyCost(123456), cost);
+
+    // cached until the settings get reloaded
+    conf.writeEntry(QLatin1String("prettyCostPrecision"), 3);
+    QCOMPARE(prettyCost(123456), cost);
+    reloadFormatSettings();
+    QVERIFY(prettyCost(123456) != cost);
+    QCOMPARE(prettyCostPrecision(), 3);
+
+    // the texts of tree nodes are cached per node and settings
+    FileData* data = new FileData;
+    SnapshotItem* snapshot = new SnapshotItem;
+    snapshot->setMemHeap(123456);
+    snapshot->setHeapTree(addLeaf(0, "0x1: f() (a.cpp:1)", 123456));
+    data->addSnapshot(snapshot);
+    DataTreeModel model;
+    model.setSource(data);
+    const QString text = model.textForTreeLeaf(snapshot->heapTree());
+    QCOMPARE(model.textForTreeLeaf(snapshot->heapTree()), text);
+
+    conf.writeEntry(QLatin1String("prettyCostPrecision"), 1);
+    reloadFormatSettings();
+    QCOMPARE(prettyCost(123456), cost);
+    QVERIFY(model.textForTreeLeaf(snapshot->heapTree()) != text);
+    QVERIFY(model.textForTreeLeaf(snapshot->heapTree()).startsWith(cost));
+    model.setSource(0);
+    delete data;
+
+    const QString label("0x6F675AB: KDevelop::IndexedIdentifier::IndexedIdentifier(KDevelop::Identifier const&) (identifier.cpp:1050)");
+    QCOMPARE(prettyLabel(label), prettyLabel(Symbol(label)));
+    QCOMPARE(prettyLabel(label), prettyLabel(label));
+    QCOMPARE(functionInLabel(label), QString("KDevelop::IndexedIdentifier::IndexedIdentifier(KDevelop::Identifier const&)"));
+}
+
+static bool labelMatches(const TreeLeafItem* node, const QString& needle)
+{
+    const Symbol symbol(node->label());
+    return symbol.name().contains(needle, Qt::CaseInsensitive)
+        || symbol.shortName().contains(needle, Qt::CaseInsensitive)
+        || symbol.address().contains(needle, Qt::CaseInsensitive);
+}
+
+/// collects the nodes below @p node that match @p needle, including their ancestors
+static bool collectMatches(const TreeLeafItem* node, const QString& needle, QSet<const TreeLeafItem*>& nodes)
+{
+    bool found = node->parent() && labelMatches(node, needle);
+    foreach (const TreeLeafItem* child, node->children()) {
+        if (collectMatches(child, needle, nodes)) {
+            found = true;
+        }
+    }
+    if (found) {
+        nodes.insert(node);
+    }
+    return found;
+}
+
+void DataModelTest::dataTreeSearch()
+{
+    FileData* data = parseKate();
+    QVERIFY(data);
+
+    const LabelSearchIndexHandle index(new LabelSearchIndex(data));
+    QCOMPARE(index->snapshotCount(), data->snapshots().size());
+    QVERIFY(!index->isComplete());
+    QCOMPARE(index->indexedSnapshotCount(), 0);
+
+    // the first search completes the index while reporting its results
+    QStringList needles;
+    needles << "q" << "kate" << "QString" << "malloc" << "0x4" << "doesnotexist";
+    foreach (const QString& needle, needles) {
+        QSet<const TreeLeafItem*> expected;
+        foreach (SnapshotItem* snapshot, data->snapshots()) {
+            if (snapshot->heapTree()) {
+                collectMatches(snapshot->heapTree(), needle, expected);
+            }
+        }
+
+        DataTreeSearch search(index, needle);
+        search.run();
+        QVERIFY(search.isDone());
+        QCOMPARE(search.takeResults(), expected);
+        QVERIFY(search.takeResults().isEmpty());
+        QCOMPARE(search.labels(), index->find(needle));
+        QCOMPARE(search.labels().isEmpty(), expected.isEmpty());
+        QVERIFY(index->isComplete());
+    }
+    QVERIFY(index->labelCount() > 0);
+
+    // refining a search for a substring yields the same labels
+    const QVector<int> labels = index->find("q");
+    QVERIFY(!labels.isEmpty());
+    QCOMPARE(index->find("qstring", &labels), index->find("QString"));
+    QVERIFY(index->find("qstring").size() <= labels.size());
+
+    // the filter keeps showing the last matches until the new search reported some
+    DataTreeModel* model = new DataTreeModel(this);
+    model->setSource(data);
+    FilteredDataTreeModel* filter = new FilteredDataTreeModel(model);
+    const int snapshots = filter->rowCount();
+    filter->setFilter("kate");
+    QCOMPARE(filter->rowCount(), snapshots);
+    for (int i = 0; i < 500 && filter->rowCount() == snapshots; ++i) {
+        QTest::qWait(10);
+    }
+    const int matches = filter->rowCount();
+    QVERIFY(matches > 0 && matches < snapshots);
+    filter->setFilter("doesnotexist");
+    filter->setFilter("doesnotexist2");
+    QCOMPARE(filter->rowCount(), matches);
+    for (int i = 0; i < 500 && filter->rowCount(); ++i) {
+        QTest::qWait(10);
+    }
+    QCOMPARE(filter->rowCount(), 0);
+    filter->setFilter(QString());
+    QCOMPARE(filter->rowCount(), snapshots);
+
+    delete filter;
+    model->setSource(0);
+    delete model;
+    delete data;
+}
+
+void DataModelTest::dotGraphGenerator()
+{
+    const FileDataHandle data(parseKate());
+    QVERIFY(data);
+    SnapshotItem* peak = data->peak();
+    QVERIFY(peak->heapTree());
+    const TreeLeafItem* node = peak->heapTree()->children().first();
+
+    DotGraphGenerator generator;
+    generator.setDebounceInterval(50);
+    generator.start();
+
+    QByteArray graph;
+    QString costlyId;
+    QVERIFY(!generator.takeGraph(&graph, &costlyId));
+
+    // requests in quick succession get coalesced to the last one
+    generator.requestGraph(data, peak, data->timeUnit());
+    generator.requestGraph(data, node, data->timeUnit());
+    for (int i = 0; i < 500 && !generator.takeGraph(&graph, &costlyId); ++i) {
+        QTest::qWait(10);
+    }
+    QVERIFY(graph.startsWith("digraph callgraph {"));
+    QVERIFY(graph.endsWith("}\n"));
+    QVERIFY(!graph.contains("snapshot #"));
+    QVERIFY(!costlyId.isEmpty());
+    QVERIFY(graph.contains(costlyId.toLatin1()));
+    QTest::qWait(100);
+    QVERIFY(!generator.takeGraph(&graph, &costlyId));
+
+    generator.requestGraph(data, peak, data->timeUnit());
+    for (int i = 0; i < 500 && !generator.takeGraph(&graph, &costlyId); ++i) {
+        QTest::qWait(10);
+    }
+    QVERIFY(graph.contains("snapshot #"));
+
+    // canceled requests are never reported
+    generator.requestGraph(data, node, data->timeUnit());
+    generator.cancel();
+    QTest::qWait(100);
+    QVERIFY(!generator.takeGraph(&graph, &costlyId));
+
+    generator.stop();
+    QVERIFY(generator.isFinished());
+}
+
+void DataModelTest::flameGraph()
+{
+    FileData* data = parseKate();
+    QVERIFY(data);
+
+    TreeLeafItem* root = data->peak()->heapTree();
+    QVERIFY(root && root->cost());
+
+    FlameGraphLayouter layouter;
+    layouter.layout(root, 800, 10000, 10);
+    QVector<FlameGraphFrame> frames = layouter.frames();
+    QVERIFY(frames.size() > 1);
+    QCOMPARE(frames.first().node, root);
+    QCOMPARE(frames.first().rect, QRectF(0, 0, 800, 9));
+
+    QHash<const TreeLeafItem*, const FlameGraphFrame*> frameForNode;
+    for (int i = 0; i < frames.size(); ++i) {
+        const FlameGraphFrame& frame = frames.at(i);
+        frameForNode.insert(frame.node, &frame);
+        QVERIFY(frame.rect.width() >= 1);
+        QCOMPARE(frame.rect.top(), qreal(frame.depth * 10));
+        QCOMPARE(layouter.frameAt(frame.rect.center())->node, frame.node);
+        if (frame.node == root) {
+            continue;
+        }
+        // children are placed below their parent, with a width proportional to their cost
+        const FlameGraphFrame* parent = frameForNode.value(frame.node->parent());
+        QVERIFY(parent);
+        QCOMPARE(frame.depth, parent->depth + 1);
+        QVERIFY(frame.rect.left() >= parent->rect.left() - 0.01);
+        QVERIFY(frame.rect.right() <= parent->rect.right() + 0.01);
+        QVERIFY(qAbs(frame.rect.width() - parent->rect.width() * frame.node->cost() / parent->node->cost()) < 0.01);
+    }
+    QVERIFY(!layouter.frameAt(QPointF(400, 10000)));
+
+    // narrow frames and rows below the visible area are culled
+    layouter.layout(root, 20, 30, 10);
+    QVERIFY(layouter.frames().size() < frames.size());
+    foreach (const FlameGraphFrame& frame, layouter.frames()) {
+        QVERIFY(frame.rect.width() >= 1);
+        QVERIFY(frame.depth <= 3);
+    }
+
+    // the parents of the zoomed node span the whole width
+    TreeLeafItem* zoom = root->children().first();
+    layouter.layout(zoom, 800, 10000, 10);
+    frames = layouter.frames();
+    QCOMPARE(frames.at(0).node, root);
+    QVERIFY(!frames.at(0).recursive);
+    QCOMPARE(frames.at(1).node, zoom);
+    QCOMPARE(frames.at(1).rect, QRectF(0, 10, 800, 9));
+    QVERIFY(frames.at(1).recursive);
+    foreach (const FlameGraphFrame& frame, frames) {
+        QVERIFY(frame.depth > 0 || frame.node == root);
+    }
+
+    layouter.clear();
+    QVERIFY(layouter.frames().isEmpty());
+    delete data;
+}
@@ -36,6 +36,28 @@ private slots:
     void testUtils();
     void shortenTemplates_data();
     void shortenTemplates();
+    void deltaTree();
+    void trends();
+    void componentGrouping();
+    void callerTree();
+    void heatMap();
+    void sparklines();
+    void treeMap();
+    void timeWindow();
+    void otherDataset();
+    void mergeFiles();
+    void recursionFolding();
+    void chainCompression();
+    void symbols();
+    void costKernels();
+    void pruneBelowMinimumCost();
+    void sharedData();
+    void hideFunctions();
+    void fetchTreeLeafs();
+    void formatCache();
+    void dataTreeSearch();
+    void dotGraphGenerator();
+    void flameGraph();
 
 private:
     Massif::DataModel* m_model;
@@ -0,0 +1,180 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "callertreegenerator.h"
+
+#include "massifdata/snapshotitem.h"
+#include "massifdata/symbol.h"
+#include "massifdata/treeleafitem.h"
+
+#include "callertreeitem.h"
+#include "componentgrouper.h"
+#include "util.h"
+
+#include <KDebug>
+#include <KLocalizedString>
+
+using namespace Massif;
+
+CallerTreeGenerator::CallerTreeGenerator(const FileDataHandle& data, const QList<SnapshotItem*>& snapshots,
+                                         QObject* parent)
+    : QThread(parent), m_data(data), m_grouper(0), m_result(0), m_canceled(false)
+{
+    foreach (SnapshotItem* snapshot, snapshots) {
+        if (snapshot->heapTree()) {
+            m_snapshots << snapshot;
+        }
+    }
+}
+
+CallerTreeGenerator::~CallerTreeGenerator()
+{
+    delete m_result;
+    delete m_grouper;
+}
+
+void CallerTreeGenerator::setGrouper(const ComponentGrouper& grouper)
+{
+    Q_ASSERT(!isRunning());
+    delete m_grouper;
+    m_grouper = new ComponentGrouper(grouper);
+}
+
+void CallerTreeGenerator::cancel()
+{
+    m_canceled = true;
+}
+
+void CallerTreeGenerator::run()
+{
+    if (m_canceled || m_snapshots.isEmpty()) {
+        return;
+    }
+
+    kDebug() << "merging allocating functions of" << m_snapshots.size() << "snapshots";
+
+    CallerTreeItem* root = new CallerTreeItem(QString());
+    foreach (SnapshotItem* snapshot, m_snapshots) {
+        const TreeLeafItem* tree = snapshot->heapTree();
+        root->addCost(tree->cost());
+        if (m_grouper) {
+            unsigned long childCost = 0;
+            foreach (const TreeLeafItem* child, tree->children()) {
+                mergeComponents(root, child);
+                childCost += child->cost();
+            }
+            if (tree->cost() > childCost) {
+                root->child(i18n("other"))->addCost(tree->cost() - childCost);
+            }
+        } else {
+            // massif's heap tree already starts at the allocating frames
+            foreach (const TreeLeafItem* child, tree->children()) {
+                merge(root, child);
+            }
+        }
+        if (m_canceled) {
+            delete root;
+            return;
+        }
+    }
+    root->finish(m_snapshots.size());
+
+    m_result = root;
+}
+
+void CallerTreeGenerator::merge(CallerTreeItem* parent, const TreeLeafItem* node)
+{
+    CallerTreeItem* item = parent->child(functionKey(node));
+    item->addCost(node->cost());
+    foreach (const TreeLeafItem* child, node->children()) {
+        merge(item, child);
+    }
+}
+
+void CallerTreeGenerator::mergeComponents(CallerTreeItem* root, const TreeLeafItem* node)
+{
+    const int id = m_grouper->classify(node->label());
+    if (id != -1) {
+        CallerTreeItem* component = root->child(m_grouper->component(id));
+        component->addCost(node->cost());
+        merge(component, node);
+        return;
+    }
+
+    // not part of any component, look at the callers instead
+    unsigned long childCost = 0;
+    foreach (const TreeLeafItem* child, node->children()) {
+        mergeComponents(root, child);
+        childCost += child->cost();
+    }
+    if (node->cost() > childCost) {
+        root->child(i18n("other"))->addCost(node->cost() - childCost);
+    }
+}
+
+QString CallerTreeGenerator::functionKey(const QString& label)
+{
+    // "below threshold" nodes are merged regardless of their place count
+    if (isBelowThreshold(label)) {
+        return QString();
+    }
+
+    // 0x6F675AB: QByteArray::resize(int) (in /usr/lib/libQtCore.so.4.5.2)
+    const int colonPos = label.indexOf(": ");
+    QString function = colonPos == -1 ? label : label.mid(colonPos + 2);
+    // unknown functions can only be told apart by their object
+    if (function.startsWith(QLatin1String("???"))) {
+        return function;
+    }
+    const int locationPos = function.lastIndexOf(" (");
+    if (locationPos != -1) {
+        function.truncate(locationPos);
+    }
+    return function;
+}
+
+QString CallerTreeGenerator::functionKey(const TreeLeafItem* node)
+{
+    const Symbol* symbol = node->symbol();
+    if (!symbol) {
+        return functionKey(node->label());
+    }
+    if (symbol->isBelowThreshold()) {
+        return QString();
+    }
+    if (symbol->function().startsWith(QLatin1String("???"))) {
+        return symbol->name();
+    }
+    return symbol->function();
+}
+
+CallerTreeItem* CallerTreeGenerator::takeResult()
+{
+    CallerTreeItem* ret = m_result;
+    m_result = 0;
+    return ret;
+}
+
+QList<SnapshotItem*> CallerTreeGenerator::snapshots() const
+{
+    return m_snapshots;
+}
+
+#include "callertreegenerator.moc"
@@ -0,0 +1,108 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MASSIF_CALLERTREEGENERATOR_H
+#define MASSIF_CALLERTREEGENERATOR_H
+
+#include <QThread>
+#include <QtCore/QList>
+
+#include "visualizer_export.h"
+
+#include "massifdata/filedata.h"
+
+namespace Massif {
+
+class SnapshotItem;
+class TreeLeafItem;
+class CallerTreeItem;
+class ComponentGrouper;
+
+/**
+ * Merges the heap trees of one or more snapshots into a tree of
+ * allocating functions and their callers.
+ *
+ * Call sites are merged per function on every level, costs of multiple
+ * snapshots are averaged. Each node of the heap trees is visited once.
+ */
+class VISUALIZER_EXPORT CallerTreeGenerator : public QThread
+{
+    Q_OBJECT
+public:
+    /**
+     * Merges the heap trees of all detailed snapshots in @p snapshots.
+     *
+     * @p data owns the snapshots and is kept alive while the generator exists.
+     */
+    CallerTreeGenerator(const FileDataHandle& data, const QList<SnapshotItem*>& snapshots, QObject* parent = 0);
+    ~CallerTreeGenerator();
+
+    /**
+     * Groups the tree by the components of @p grouper, must be called before the generator is started.
+     *
+     * The top level nodes are the components then, followed by the allocating functions whose
+     * cost got attributed to them as in ComponentGrouper::aggregate(), and their callers.
+     */
+    void setGrouper(const ComponentGrouper& grouper);
+
+    /**
+     * Stops computing the caller tree.
+     */
+    void cancel();
+
+    virtual void run();
+
+    /**
+     * @return The root of the caller tree or zero if none could be computed.
+     *
+     * @note The caller takes ownership.
+     */
+    CallerTreeItem* takeResult();
+
+    /**
+     * @return The detailed snapshots that got merged.
+     */
+    QList<SnapshotItem*> snapshots() const;
+
+    /**
+     * @return The key under which call sites of @p label get merged,
+     *         i.e. the function without address and location.
+     */
+    static QString functionKey(const QString& label);
+    /**
+     * @return The key under which call sites of @p node get merged,
+     *         uses the parsed label of the node if available.
+     */
+    static QString functionKey(const TreeLeafItem* node);
+
+private:
+    void merge(CallerTreeItem* parent, const TreeLeafItem* node);
+    void mergeComponents(CallerTreeItem* root, const TreeLeafItem* node);
+
+    FileDataHandle m_data;
+    ComponentGrouper* m_grouper;
+    QList<SnapshotItem*> m_snapshots;
+    CallerTreeItem* m_result;
+    bool m_canceled;
+};
+
+}
+
+#endif // MASSIF_CALLERTREEGENERATOR_H
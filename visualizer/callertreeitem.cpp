@@ -0,0 +1,102 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "callertreeitem.h"
+
+#include <QtCore/qalgorithms.h>
+
+using namespace Massif;
+
+CallerTreeItem::CallerTreeItem(const QString& function)
+    : m_function(function), m_cost(0), m_callSites(0), m_parent(0), m_row(0)
+{
+}
+
+CallerTreeItem::~CallerTreeItem()
+{
+    qDeleteAll(m_children);
+}
+
+QString CallerTreeItem::function() const
+{
+    return m_function;
+}
+
+unsigned long CallerTreeItem::cost() const
+{
+    return m_cost;
+}
+
+int CallerTreeItem::callSites() const
+{
+    return m_callSites;
+}
+
+void CallerTreeItem::addCost(unsigned long cost)
+{
+    m_cost += cost;
+    ++m_callSites;
+}
+
+CallerTreeItem* CallerTreeItem::child(const QString& function)
+{
+    CallerTreeItem*& item = m_childIndex[function];
+    if (!item) {
+        item = new CallerTreeItem(function);
+        item->m_parent = this;
+        item->m_row = m_children.size();
+        m_children << item;
+    }
+    return item;
+}
+
+static bool sortByCost(const CallerTreeItem* l, const CallerTreeItem* r)
+{
+    return l->cost() > r->cost();
+}
+
+void CallerTreeItem::finish(int snapshots)
+{
+    Q_ASSERT(snapshots > 0);
+    m_cost /= snapshots;
+    m_childIndex.clear();
+    foreach (CallerTreeItem* child, m_children) {
+        child->finish(snapshots);
+    }
+    qSort(m_children.begin(), m_children.end(), sortByCost);
+    for (int i = 0; i < m_children.size(); ++i) {
+        m_children.at(i)->m_row = i;
+    }
+}
+
+QList< CallerTreeItem* > CallerTreeItem::children() const
+{
+    return m_children;
+}
+
+CallerTreeItem* CallerTreeItem::parent() const
+{
+    return m_parent;
+}
+
+int CallerTreeItem::row() const
+{
+    return m_row;
+}
@@ -0,0 +1,106 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MASSIF_CALLERTREEITEM_H
+#define MASSIF_CALLERTREEITEM_H
+
+#include <QtCore/QString>
+#include <QtCore/QList>
+#include <QtCore/QHash>
+
+#include "visualizer_export.h"
+
+namespace Massif {
+
+/**
+ * A node in the bottom-up tree of allocating functions.
+ *
+ * Top level nodes are the functions that allocate memory, their children
+ * are the callers of these functions and so forth. All call sites of a
+ * function are merged into a single node per level.
+ */
+class VISUALIZER_EXPORT CallerTreeItem
+{
+public:
+    explicit CallerTreeItem(const QString& function);
+    ~CallerTreeItem();
+
+    /**
+     * @return The function this node stands for, or an empty string for
+     *         the aggregated nodes below massif's threshold.
+     */
+    QString function() const;
+
+    /**
+     * @return The cost of this node, averaged over all merged snapshots.
+     */
+    unsigned long cost() const;
+
+    /**
+     * @return Number of massif tree nodes merged into this one.
+     */
+    int callSites() const;
+
+    /**
+     * Adds @p cost of a single call site to this node.
+     */
+    void addCost(unsigned long cost);
+
+    /**
+     * @return The child for @p function, which gets created on demand.
+     */
+    CallerTreeItem* child(const QString& function);
+
+    /**
+     * Divides all costs by @p snapshots, then sorts the children by their
+     * cost, recursively.
+     */
+    void finish(int snapshots);
+
+    /**
+     * @return The children of this node.
+     */
+    QList<CallerTreeItem*> children() const;
+
+    /**
+     * @return The parent item or zero, if this is the root node.
+     */
+    CallerTreeItem* parent() const;
+
+    /**
+     * @return The row of this item in its parent's children.
+     */
+    int row() const;
+
+private:
+    QString m_function;
+    // summed up over all snapshots until finish() is called
+    quint64 m_cost;
+    int m_callSites;
+    QList<CallerTreeItem*> m_children;
+    // only used while building the tree
+    QHash<QString, CallerTreeItem*> m_childIndex;
+    CallerTreeItem* m_parent;
+    int m_row;
+};
+
+}
+
+#endif // MASSIF_CALLERTREEITEM_H
@@ -0,0 +1,152 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "callertreemodel.h"
+
+#include "massifdata/snapshotitem.h"
+
+#include "callertreeitem.h"
+#include "util.h"
+
+#include <KLocalizedString>
+
+#include <QtGui/QTextDocument>
+
+using namespace Massif;
+
+CallerTreeModel::CallerTreeModel(QObject* parent)
+    : QAbstractItemModel(parent), m_root(0), m_first(0), m_last(0)
+{
+}
+
+CallerTreeModel::~CallerTreeModel()
+{
+    delete m_root;
+}
+
+void CallerTreeModel::setSource(CallerTreeItem* root, const SnapshotItem* first, const SnapshotItem* last)
+{
+    beginResetModel();
+    delete m_root;
+    m_root = root;
+    m_first = root ? first : 0;
+    m_last = root ? last : 0;
+    endResetModel();
+}
+
+CallerTreeItem* CallerTreeModel::itemForIndex(const QModelIndex& idx) const
+{
+    if (!m_root || !idx.isValid()) {
+        return 0;
+    }
+    return static_cast<CallerTreeItem*>(idx.internalPointer());
+}
+
+QVariant CallerTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (section == 0 && orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        if (m_first && m_last && m_first != m_last) {
+            return i18n("Allocating functions, averaged over snapshots #%1 to #%2", m_first->number(), m_last->number());
+        } else if (m_first) {
+            return i18n("Allocating functions in snapshot #%1", m_first->number());
+        }
+        return i18n("Allocating functions");
+    }
+    return QAbstractItemModel::headerData(section, orientation, role);
+}
+
+QVariant CallerTreeModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+
+    Q_ASSERT(index.row() >= 0 && index.row() < rowCount(index.parent()));
+    Q_ASSERT(index.column() >= 0 && index.column() < columnCount(index.parent()));
+    Q_ASSERT(m_root);
+
+    CallerTreeItem* item = static_cast<CallerTreeItem*>(index.internalPointer());
+    Q_ASSERT(item);
+
+    const QString function = item->function().isEmpty()
+                                ? i18n("all below massif's threshold")
+                                : prettyLabel(item->function());
+
+    if (role == Qt::ToolTipRole) {
+        QString tooltip = "<html><head><style>dt{font-weight:bold;} dd {font-family:monospace;}</style></head><body><dl>\n";
+        tooltip += i18n("<dt>cost:</dt><dd>%1, i.e. %2% of the heap</dd>", prettyCost(item->cost()),
+                        // yeah nice how I round to two decimals, right? :D
+                        m_root->cost() ? double(int(double(item->cost())/m_root->cost()*10000))/100 : 0.0);
+        if (m_first == m_last) {
+            tooltip += i18n("<dt>call sites:</dt><dd>%1</dd>", item->callSites());
+        }
+        tooltip += i18n("<dt>function:</dt><dd>%1</dd>", Qt::escape(function));
+        tooltip += "</dl></body></html>";
+        return tooltip;
+    }
+
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    return i18nc("%1: cost, %2: function name", "%1: %2", prettyCost(item->cost()), function);
+}
+
+int CallerTreeModel::columnCount(const QModelIndex&) const
+{
+    return 1;
+}
+
+int CallerTreeModel::rowCount(const QModelIndex& parent) const
+{
+    if (!m_root || (parent.isValid() && parent.column() != 0)) {
+        return 0;
+    }
+
+    if (parent.isValid()) {
+        return static_cast<CallerTreeItem*>(parent.internalPointer())->children().size();
+    } else {
+        // the root itself is not shown, its children are the allocating functions
+        return m_root->children().size();
+    }
+}
+
+QModelIndex CallerTreeModel::index(int row, int column, const QModelIndex& parent) const
+{
+    if (row < 0 || row >= rowCount(parent) || column < 0 || column >= columnCount(parent)) {
+        // invalid
+        return QModelIndex();
+    }
+
+    CallerTreeItem* parentItem = parent.isValid() ? static_cast<CallerTreeItem*>(parent.internalPointer()) : m_root;
+    return createIndex(row, column, static_cast<void*>(parentItem->children().at(row)));
+}
+
+QModelIndex CallerTreeModel::parent(const QModelIndex& child) const
+{
+    if (!child.isValid()) {
+        return QModelIndex();
+    }
+    CallerTreeItem* item = static_cast<CallerTreeItem*>(child.internalPointer());
+    if (!item->parent() || item->parent() == m_root) {
+        return QModelIndex();
+    }
+    return createIndex(item->parent()->row(), 0, static_cast<void*>(item->parent()));
+}
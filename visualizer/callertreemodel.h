@@ -0,0 +1,69 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MASSIF_CALLERTREEMODEL_H
+#define MASSIF_CALLERTREEMODEL_H
+
+#include <QtCore/QAbstractItemModel>
+
+#include "visualizer_export.h"
+
+namespace Massif {
+
+class CallerTreeItem;
+class SnapshotItem;
+
+/**
+ * A model for the bottom-up tree of allocating functions, i.e. the result
+ * of a CallerTreeGenerator.
+ */
+class VISUALIZER_EXPORT CallerTreeModel : public QAbstractItemModel
+{
+public:
+    CallerTreeModel(QObject* parent = 0);
+    virtual ~CallerTreeModel();
+
+    /**
+     * Set the caller tree @p root, merged from the snapshots @p first up
+     * to and including @p last. The model takes ownership of @p root.
+     */
+    void setSource(CallerTreeItem* root, const SnapshotItem* first, const SnapshotItem* last);
+
+    /**
+     * @return Item for given index or zero if it's invalid.
+     */
+    CallerTreeItem* itemForIndex(const QModelIndex& idx) const;
+
+    virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
+    virtual int rowCount(const QModelIndex& parent = QModelIndex()) const;
+    virtual int columnCount(const QModelIndex& parent = QModelIndex()) const;
+    virtual QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const;
+    virtual QModelIndex parent(const QModelIndex& child) const;
+    virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+
+private:
+    CallerTreeItem* m_root;
+    const SnapshotItem* m_first;
+    const SnapshotItem* m_last;
+};
+
+}
+
+#endif // MASSIF_CALLERTREEMODEL_H
@@ -0,0 +1,231 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "componentcostmodel.h"
+
+#include "massifdata/filedata.h"
+#include "massifdata/snapshotitem.h"
+#include "massifdata/treeleafitem.h"
+
+#include "KDChartGlobal"
+#include "KDChartLineAttributes"
+
+#include "util.h"
+
+#include <QtGui/QColor>
+#include <QtGui/QPen>
+#include <QtGui/QBrush>
+#include <QtGui/QTextDocument>
+
+#include <QtCore/QMultiMap>
+#include <QtCore/qalgorithms.h>
+
+#include <KLocalizedString>
+
+#include <cmath>
+
+using namespace Massif;
+
+ComponentCostModel::ComponentCostModel(QObject* parent)
+    : QAbstractTableModel(parent), m_data(0), m_firstTime(0)
+{
+}
+
+ComponentCostModel::~ComponentCostModel()
+{
+}
+
+void ComponentCostModel::setSource(const FileData* data, const ComponentGrouper& grouper)
+{
+    beginResetModel();
+    m_data = 0;
+    m_columns.clear();
+    m_rows.clear();
+    m_costs.clear();
+    m_firstTime = 0;
+    m_selection = QModelIndex();
+
+    if (data) {
+        // one aggregation pass per detailed snapshot
+        ComponentGrouper classifier(grouper);
+        QList< QVector<unsigned long> > costs;
+        foreach (SnapshotItem* snapshot, data->snapshots()) {
+            if (snapshot->heapTree()) {
+                m_rows << snapshot;
+                costs << classifier.aggregate(snapshot->heapTree());
+            }
+        }
+
+        // sort components by their peak cost
+        QVector<unsigned long> peaks(classifier.componentCount(), 0);
+        foreach (const QVector<unsigned long>& snapshotCosts, costs) {
+            for (int i = 0; i < snapshotCosts.size(); ++i) {
+                peaks[i] = qMax(peaks.at(i), snapshotCosts.at(i));
+            }
+        }
+        QMultiMap<unsigned long, int> sortColumnMap;
+        for (int i = 0; i < peaks.size(); ++i) {
+            if (peaks.at(i)) {
+                sortColumnMap.insert(peaks.at(i), i);
+            }
+        }
+        QList<int> order = sortColumnMap.values();
+        QAlgorithmsPrivate::qReverse(order.begin(), order.end());
+        foreach (int id, order) {
+            m_columns << classifier.component(id);
+        }
+
+        // dense rows x columns matrix
+        m_costs.fill(0, m_rows.size() * m_columns.size());
+        for (int row = 0; row < costs.size(); ++row) {
+            const QVector<unsigned long>& snapshotCosts = costs.at(row);
+            for (int column = 0; column < order.size(); ++column) {
+                const int id = order.at(column);
+                if (id < snapshotCosts.size()) {
+                    m_costs[row * m_columns.size() + column] = snapshotCosts.at(id);
+                }
+            }
+        }
+
+        // get x-coordinate of the last snapshot with cost below 0.1% of peak cost
+        m_firstTime = data->columns().timeBefore(std::ceil(data->peak()->memHeap() * 0.001));
+
+        if (!m_rows.isEmpty()) {
+            m_data = data;
+        }
+    }
+    endResetModel();
+}
+
+unsigned long ComponentCostModel::cost(int row, int component) const
+{
+    return m_costs.at(row * m_columns.size() + component);
+}
+
+QVariant ComponentCostModel::data(const QModelIndex& index, int role) const
+{
+    // FIXME kdchart queries (-1, -1) for empty models
+    if ( index.row() == -1 || index.column() == -1 ) {
+        return QVariant();
+    }
+
+    Q_ASSERT(index.row() >= 0 && index.row() < rowCount(index.parent()));
+    Q_ASSERT(index.column() >= 0 && index.column() < columnCount(index.parent()));
+    Q_ASSERT(m_data);
+    Q_ASSERT(!index.parent().isValid());
+
+    if ( role == KDChart::LineAttributesRole ) {
+        static KDChart::LineAttributes attributes;
+        attributes.setDisplayArea(true);
+        if (index == m_selection) {
+            attributes.setTransparency(255);
+        } else if (index.column() == m_selection.column()) {
+            attributes.setTransparency(152);
+        } else {
+            attributes.setTransparency(127);
+        }
+        return QVariant::fromValue(attributes);
+    }
+
+    if (role == KDChart::DatasetBrushRole || role == KDChart::DatasetPenRole) {
+        QColor c = QColor::fromHsv(double(index.column() + 1) / columnCount() * 255, 255, 255);
+        if (role == KDChart::DatasetBrushRole) {
+            return QBrush(c);
+        } else {
+            return QPen(c);
+        }
+    }
+
+    if ( role != Qt::DisplayRole && role != Qt::ToolTipRole ) {
+        return QVariant();
+    }
+
+    if (index.row() == 0) {
+        if (role == Qt::ToolTipRole) {
+            return QVariant();
+        } else if (index.column() % 2 == 0) {
+            return m_firstTime;
+        } else {
+            // cost to 0
+            return 0;
+        }
+    }
+
+    // hack: the ToolTip will only be queried by KDChart and that one uses the
+    // left index, but we want it to query the right one
+    const int row = role == Qt::ToolTipRole ? index.row() : index.row() - 1;
+    if (row >= m_rows.size()) {
+        return QVariant();
+    }
+    SnapshotItem* snapshot = m_rows.at(row);
+    const int component = index.column() / 2;
+
+    if (role == Qt::ToolTipRole) {
+        return i18n("<dl><dt>component:</dt><dd>%1</dd>"
+                    "<dt>cost:</dt><dd>%2, i.e. %3% of snapshot #%4</dd></dl>",
+                    Qt::escape(m_columns.at(component)),
+                    prettyCost(cost(row, component)),
+                    // yeah nice how I round to two decimals, right? :D
+                    double(int(double(cost(row, component))/snapshot->memHeap()*10000))/100,
+                    snapshot->number());
+    } else if (index.column() % 2 == 0) {
+        return snapshot->time();
+    } else {
+        return double(cost(row, component));
+    }
+}
+
+QVariant ComponentCostModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section % 2 == 0 && section < columnCount()) {
+        return m_columns.at(section / 2);
+    }
+    return QAbstractItemModel::headerData(section, orientation, role);
+}
+
+int ComponentCostModel::columnCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_columns.size() * 2;
+}
+
+int ComponentCostModel::rowCount(const QModelIndex& parent) const
+{
+    if (!m_data || parent.isValid()) {
+        return 0;
+    }
+    // +1 to get a zero row first
+    return m_rows.count() + 1;
+}
+
+SnapshotItem* ComponentCostModel::snapshotForRow(int row) const
+{
+    if (row <= 0 || row > m_rows.size()) {
+        return 0;
+    }
+    return m_rows.at(row - 1);
+}
+
+void ComponentCostModel::setSelection(const QModelIndex& index)
+{
+    m_selection = index;
+}
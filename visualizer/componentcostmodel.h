@@ -0,0 +1,87 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MASSIF_COMPONENTCOSTMODEL_H
+#define MASSIF_COMPONENTCOSTMODEL_H
+
+#include <QtCore/QAbstractTableModel>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+#include "componentgrouper.h"
+#include "visualizer_export.h"
+
+namespace Massif {
+
+class FileData;
+class SnapshotItem;
+
+/**
+ * A model that gives tabular access to the costs in a massif output file,
+ * aggregated per component, e.g. per shared library.
+ *
+ * The layout is the same as in DetailedCostModel, i.e. a zero row first and
+ * two columns per component for time and cost.
+ */
+class VISUALIZER_EXPORT ComponentCostModel : public QAbstractTableModel
+{
+public:
+    ComponentCostModel(QObject* parent = 0);
+    virtual ~ComponentCostModel();
+
+    /**
+     * Set the source data and the @p grouper used to aggregate it.
+     */
+    void setSource(const FileData* data, const ComponentGrouper& grouper = ComponentGrouper());
+
+    virtual int columnCount(const QModelIndex& parent = QModelIndex()) const;
+    virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
+    virtual int rowCount(const QModelIndex& parent = QModelIndex()) const;
+    virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+
+    /**
+     * @return The snapshot shown in @p row or zero for the zero row.
+     */
+    SnapshotItem* snapshotForRow(int row) const;
+
+    /**
+     * Select @p index, which changes the graphical representation of its data.
+     */
+    void setSelection(const QModelIndex& index);
+
+private:
+    unsigned long cost(int row, int component) const;
+
+    const FileData* m_data;
+    // columns => component name, sorted by peak cost
+    QStringList m_columns;
+    // only detailed snapshots
+    QList<SnapshotItem*> m_rows;
+    // rows x columns
+    QVector<unsigned long> m_costs;
+    // x-coordinate of the zero row
+    double m_firstTime;
+    // selected item
+    QModelIndex m_selection;
+};
+
+}
+
+#endif // MASSIF_COMPONENTCOSTMODEL_H
@@ -0,0 +1,169 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "componentgrouper.h"
+
+#include "massifdata/symbol.h"
+#include "massifdata/treeleafitem.h"
+
+#include "util.h"
+
+#include <KLocalizedString>
+
+using namespace Massif;
+
+ComponentGrouper::ComponentGrouper(Mode mode, const QList<Rule>& rules)
+    : m_mode(mode)
+{
+    foreach (const Rule& rule, rules) {
+        const QRegExp pattern(rule.first, Qt::CaseSensitive, QRegExp::RegExp2);
+        if (pattern.isValid()) {
+            m_rules << qMakePair(pattern, rule.second);
+        }
+    }
+}
+
+ComponentGrouper::~ComponentGrouper()
+{
+}
+
+ComponentGrouper::Mode ComponentGrouper::mode() const
+{
+    return m_mode;
+}
+
+int ComponentGrouper::componentCount() const
+{
+    return m_components.size();
+}
+
+QString ComponentGrouper::component(int id) const
+{
+    return m_components.at(id);
+}
+
+int ComponentGrouper::componentId(const QString& name)
+{
+    QHash<QString, int>::const_iterator it = m_componentIds.constFind(name);
+    if (it != m_componentIds.constEnd()) {
+        return it.value();
+    }
+    const int id = m_components.size();
+    m_components << name;
+    m_componentIds.insert(name, id);
+    return id;
+}
+
+int ComponentGrouper::classify(const QString& label)
+{
+    QHash<QString, int>::const_iterator it = m_labelComponents.constFind(label);
+    if (it != m_labelComponents.constEnd()) {
+        return it.value();
+    }
+    const QString name = componentForLabel(label);
+    const int id = name.isEmpty() ? -1 : componentId(name);
+    m_labelComponents.insert(label, id);
+    return id;
+}
+
+QString ComponentGrouper::componentForLabel(const QString& label) const
+{
+    if (isBelowThreshold(label)) {
+        return i18n("below threshold");
+    }
+
+    const Symbol symbol(label);
+    const QString function = symbol.function();
+    QString location = symbol.location();
+
+    switch (m_mode) {
+        case ByObject: {
+            if (!location.startsWith(QLatin1String("in "))) {
+                return i18n("unknown object");
+            }
+            return location.mid(location.lastIndexOf('/') + 1);
+        }
+        case BySourceDirectory: {
+            if (location.isEmpty() || location.startsWith(QLatin1String("in "))) {
+                return i18n("unknown source");
+            }
+            // strip line number
+            const int linePos = location.lastIndexOf(':');
+            if (linePos != -1) {
+                location.truncate(linePos);
+            }
+            const int dirPos = location.lastIndexOf('/');
+            return dirPos == -1 ? location : location.left(dirPos);
+        }
+        case ByRules: {
+            for (int i = 0; i < m_rules.size(); ++i) {
+                const QRegExp& pattern = m_rules.at(i).first;
+                if (pattern.indexIn(function) != -1 || (!location.isEmpty() && pattern.indexIn(location) != -1)) {
+                    return m_rules.at(i).second;
+                }
+            }
+            return QString();
+        }
+    }
+    return QString();
+}
+
+QVector<unsigned long> ComponentGrouper::aggregate(const TreeLeafItem* root)
+{
+    QVector<unsigned long> costs;
+    if (root) {
+        unsigned long childCost = 0;
+        foreach (const TreeLeafItem* child, root->children()) {
+            aggregate(child, costs);
+            childCost += child->cost();
+        }
+        if (root->cost() > childCost) {
+            addCost(costs, componentId(i18n("other")), root->cost() - childCost);
+        }
+    }
+    return costs;
+}
+
+void ComponentGrouper::aggregate(const TreeLeafItem* node, QVector<unsigned long>& costs)
+{
+    const int id = classify(node->label());
+    if (id != -1) {
+        addCost(costs, id, node->cost());
+        return;
+    }
+
+    // not part of any component, look at the callers instead
+    unsigned long childCost = 0;
+    foreach (const TreeLeafItem* child, node->children()) {
+        aggregate(child, costs);
+        childCost += child->cost();
+    }
+    if (node->cost() > childCost) {
+        addCost(costs, componentId(i18n("other")), node->cost() - childCost);
+    }
+}
+
+void ComponentGrouper::addCost(QVector<unsigned long>& costs, int id, unsigned long cost)
+{
+    if (id >= costs.size()) {
+        costs.resize(id + 1);
+    }
+    costs[id] += cost;
+}
@@ -0,0 +1,110 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MASSIF_COMPONENTGROUPER_H
+#define MASSIF_COMPONENTGROUPER_H
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QPair>
+#include <QtCore/QRegExp>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+#include "visualizer_export.h"
+
+namespace Massif {
+
+class TreeLeafItem;
+
+/**
+ * Classifies tree nodes into components, e.g. shared libraries, and
+ * aggregates the heap cost of a snapshot per component.
+ *
+ * Every unique label is classified only once, the result is memoized.
+ */
+class VISUALIZER_EXPORT ComponentGrouper
+{
+public:
+    enum Mode {
+        /// group by the shared object a function lives in, e.g. libQtCore.so.4.5.2
+        ByObject,
+        /// group by the directory of the source file, or the file itself if no directory is known
+        BySourceDirectory,
+        /// group by user defined regular expressions, matched against function name and location,
+        /// the first matching rule wins
+        ByRules
+    };
+
+    /**
+     * A rule maps a regular expression, e.g. "^KDevelop::", to a component name, e.g. "kdevplatform".
+     * The expression matches if it is found anywhere in the function name or location.
+     */
+    typedef QPair<QString, QString> Rule;
+
+    explicit ComponentGrouper(Mode mode = ByObject, const QList<Rule>& rules = QList<Rule>());
+    ~ComponentGrouper();
+
+    Mode mode() const;
+
+    /**
+     * @return The component id for @p label or -1 if it does not belong to any component.
+     */
+    int classify(const QString& label);
+
+    /**
+     * @return Number of components known so far.
+     */
+    int componentCount() const;
+    /**
+     * @return The name of component @p id.
+     */
+    QString component(int id) const;
+
+    /**
+     * Attributes the cost of the heap tree @p root to components, in a single pass.
+     *
+     * Each allocation is attributed to the first frame on its stack, starting at
+     * the allocation site, that belongs to a component. Allocations without such
+     * a frame are attributed to an "other" component, hence the costs always add
+     * up to the cost of @p root.
+     *
+     * @return The cost per component id, might be shorter than @c componentCount().
+     */
+    QVector<unsigned long> aggregate(const TreeLeafItem* root);
+
+private:
+    int componentId(const QString& name);
+    QString componentForLabel(const QString& label) const;
+    void aggregate(const TreeLeafItem* node, QVector<unsigned long>& costs);
+    void addCost(QVector<unsigned long>& costs, int id, unsigned long cost);
+
+    Mode m_mode;
+    QList< QPair<QRegExp, QString> > m_rules;
+
+    QStringList m_components;
+    QHash<QString, int> m_componentIds;
+    // memoized: label => component id
+    QHash<QString, int> m_labelComponents;
+};
+
+}
+
+#endif // MASSIF_COMPONENTGROUPER_H
@@ -35,7 +35,7 @@
 using namespace Massif;
 
 DataTreeModel::DataTreeModel(QObject* parent)
-    : QAbstractItemModel(parent), m_data(0)
+    : QAbstractItemModel(parent), m_data(0), m_fetchBatchSize(256), m_leafTexts(5000)
 {
 }
 
@@ -48,33 +48,71 @@ void DataTreeModel::setSource(const FileData* data)
     if (m_data) {
         beginRemoveRows(QModelIndex(), 0, rowCount() - 1);
         m_data = 0;
-        m_nodeToRow.clear();
-        m_heapRootToSnapshot.clear();
+        m_snapshotRows.clear();
+        m_fetched.clear();
+        m_leafTexts.clear();
         endRemoveRows();
     }
     if (data) {
         beginInsertRows(QModelIndex(), 0, data->snapshots().size() - 1);
         m_data = data;
-        int row = 0;
-        foreach(SnapshotItem* item, m_data->snapshots()) {
-            if (item->heapTree()) {
-                mapNodeToRow(item->heapTree(), row++);
-                m_heapRootToSnapshot[item->heapTree()] = item;
-            } else {
-                row++;
-            }
+        // the rows of the heap tree items are known by the items themselves
+        m_snapshotRows.reserve(data->snapshots().size());
+        for (int row = 0; row < data->snapshots().size(); ++row) {
+            m_snapshotRows.insert(data->snapshots().at(row), row);
         }
         endInsertRows();
     }
 }
 
-void DataTreeModel::mapNodeToRow(TreeLeafItem* node, const int row)
+const FileData* DataTreeModel::source() const
+{
+    return m_data;
+}
+
+void DataTreeModel::setFetchBatchSize(int size)
 {
-    m_nodeToRow[node] = row;
-    int r = 0;
-    foreach(TreeLeafItem* child, node->children()) {
-        mapNodeToRow(child, r++);
+    Q_ASSERT(size > 0);
+    m_fetchBatchSize = size;
+}
+
+int DataTreeModel::fetchedChildren(const TreeLeafItem* node) const
+{
+    const int children = node->children().size();
+    if (children <= m_fetchBatchSize) {
+        return children;
     }
+    return m_fetched.value(node, m_fetchBatchSize);
+}
+
+int DataTreeModel::rowForTreeLeaf(const TreeLeafItem* node) const
+{
+    if (node->parent()) {
+        return node->row();
+    }
+    return m_snapshotRows.value(node->snapshot(), -1);
+}
+
+bool DataTreeModel::canFetchMore(const QModelIndex& parent) const
+{
+    if (!m_data || !parent.isValid() || !parent.internalPointer()) {
+        return false;
+    }
+    const TreeLeafItem* node = static_cast<TreeLeafItem*>(parent.internalPointer());
+    return fetchedChildren(node) < node->children().size();
+}
+
+void DataTreeModel::fetchMore(const QModelIndex& parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
+    }
+    const TreeLeafItem* node = static_cast<TreeLeafItem*>(parent.internalPointer());
+    const int fetched = fetchedChildren(node);
+    const int count = qMin(node->children().size(), fetched + m_fetchBatchSize);
+    beginInsertRows(parent, fetched, count - 1);
+    m_fetched.insert(node, count);
+    endInsertRows();
 }
 
 QVariant DataTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
@@ -130,6 +168,13 @@ QVariant DataTreeModel::data(const QModelIndex& index, int role) const
         }
     }
 
+    if (role == TreeItemRole) {
+        if (!index.parent().isValid()) {
+            return QVariant();
+        }
+        return QVariant::fromValue(static_cast<TreeLeafItem*>(index.internalPointer()));
+    }
+
     if ( role != Qt::DisplayRole && role != Qt::ToolTipRole ) {
         return QVariant();
     }
@@ -157,12 +202,30 @@ QVariant DataTreeModel::data(const QModelIndex& index, int role) const
         if (role == Qt::ToolTipRole) {
             return tooltipForTreeLeaf(item, snapshotForTreeLeaf(item), item->label());
         }
-        return i18nc("%1: cost, %2: snapshot label (i.e. func name etc.)", "%1: %2",
-                     prettyCost(item->cost()), prettyLabel(item->label()));
+        return textForTreeLeaf(item);
     }
     return QVariant();
 }
 
+QString DataTreeModel::textForTreeLeaf(const TreeLeafItem* node) const
+{
+    // texts for outdated settings are never hit again and get dropped eventually
+    const LeafTextKey key(node, qMakePair(prettyCostPrecision(), int(shortenTemplates())));
+    if (const QString* cached = m_leafTexts.object(key)) {
+        return *cached;
+    }
+    QString text;
+    if (node->recursionDepth() > 1) {
+        text = i18nc("%1: cost, %2: snapshot label (i.e. func name etc.), %3: recursion depth", "%1: %2 (%3 recursive calls)",
+                     prettyCost(node->cost()), prettyLabel(node), node->recursionDepth());
+    } else {
+        text = i18nc("%1: cost, %2: snapshot label (i.e. func name etc.)", "%1: %2",
+                     prettyCost(node->cost()), prettyLabel(node));
+    }
+    m_leafTexts.insert(key, new QString(text));
+    return text;
+}
+
 int DataTreeModel::columnCount(const QModelIndex& parent) const
 {
     return 1;
@@ -179,7 +242,7 @@ int DataTreeModel::rowCount(const QModelIndex& parent) const
             // snapshot without detailed heaptree
             return 0;
         }
-        return static_cast<TreeLeafItem*>(parent.internalPointer())->children().size();
+        return fetchedChildren(static_cast<TreeLeafItem*>(parent.internalPointer()));
     } else {
         return m_data->snapshots().size();
     }
@@ -210,9 +273,8 @@ QModelIndex DataTreeModel::parent(const QModelIndex& child) const
     if (child.internalPointer()) {
         TreeLeafItem* item = static_cast<TreeLeafItem*>(child.internalPointer());
         if (item->parent()) {
-            Q_ASSERT(m_nodeToRow.contains(item));
             // somewhere in the detailed heap tree
-            return createIndex(m_nodeToRow[item->parent()], 0, static_cast<void*>(item->parent()));
+            return createIndex(rowForTreeLeaf(item->parent()), 0, static_cast<void*>(item->parent()));
         } else {
             // snapshot item with heap tree
             return QModelIndex();
@@ -225,19 +287,33 @@ QModelIndex DataTreeModel::parent(const QModelIndex& child) const
 
 QModelIndex DataTreeModel::indexForSnapshot(SnapshotItem* snapshot) const
 {
-    int idx = m_data->snapshots().indexOf(snapshot);
+    if (!m_data) {
+        return QModelIndex();
+    }
+    const int idx = m_snapshotRows.value(snapshot, -1);
     if ( idx == -1 ) {
         return QModelIndex();
     }
     return index(idx, 0);
 }
 
-QModelIndex DataTreeModel::indexForTreeLeaf(TreeLeafItem* node) const
+QModelIndex DataTreeModel::indexForTreeLeaf(TreeLeafItem* node)
 {
-    if (!m_data || !m_nodeToRow.contains(node)) {
+    SnapshotItem* snapshot = node->snapshot();
+    if (!m_data || !snapshot || !m_snapshotRows.contains(snapshot)) {
         return QModelIndex();
     }
-    return createIndex(m_nodeToRow[node], 0, static_cast<void*>(node));
+    if (!node->parent()) {
+        return snapshot->heapTree() == node ? createIndex(rowForTreeLeaf(node), 0, static_cast<void*>(node)) : QModelIndex();
+    }
+    const QModelIndex parent = indexForTreeLeaf(node->parent());
+    if (!parent.isValid()) {
+        return QModelIndex();
+    }
+    while (node->row() >= rowCount(parent)) {
+        fetchMore(parent);
+    }
+    return createIndex(node->row(), 0, static_cast<void*>(node));
 }
 
 QPair< TreeLeafItem*, SnapshotItem* > DataTreeModel::itemForIndex(const QModelIndex& idx) const
@@ -253,7 +329,7 @@ QPair< TreeLeafItem*, SnapshotItem* > DataTreeModel::itemForIndex(const QModelIn
     }
 }
 
-QModelIndex DataTreeModel::indexForItem(const QPair< TreeLeafItem*, SnapshotItem* >& item) const
+QModelIndex DataTreeModel::indexForItem(const QPair< TreeLeafItem*, SnapshotItem* >& item)
 {
     if (!item.first && !item.second) {
         return QModelIndex();
@@ -268,8 +344,5 @@ QModelIndex DataTreeModel::indexForItem(const QPair< TreeLeafItem*, SnapshotItem
 
 SnapshotItem* DataTreeModel::snapshotForTreeLeaf(TreeLeafItem* node) const
 {
-    while (node->parent()) {
-        node = node->parent();
-    }
-    return m_heapRootToSnapshot.value(node);
+    return node->snapshot();
 }
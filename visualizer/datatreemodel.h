@@ -24,6 +24,8 @@
 #include <QBrush>
 #include <QPair>
 #include <QtCore/QAbstractItemModel>
+#include <QtCore/QCache>
+#include <QtCore/QHash>
 
 #include "visualizer_export.h"
 
@@ -35,10 +37,18 @@ class SnapshotItem;
 
 /**
  * A model that gives a tree representation of the full Massif data. Useful for e.g. ListViews.
+ *
+ * The rows of the heap tree items are stored in the items themselves, hence setting the
+ * source is cheap. Long lists of children are exposed in batches, see @c fetchMore().
  */
 class VISUALIZER_EXPORT DataTreeModel : public QAbstractItemModel
 {
 public:
+    enum Roles {
+        /// the TreeLeafItem of a row in a heap tree, invalid for snapshot rows
+        TreeItemRole = Qt::UserRole + 1
+    };
+
     DataTreeModel(QObject* parent = 0);
     virtual ~DataTreeModel();
 
@@ -46,6 +56,21 @@ public:
      * That the source data for this model.
      */
     void setSource(const FileData* data);
+    /**
+     * @return The source data of this model or zero.
+     */
+    const FileData* source() const;
+
+    /**
+     * Sets the number of children that are exposed at once to @p size.
+     * Only affects items whose children were not fetched yet.
+     */
+    void setFetchBatchSize(int size);
+
+    /**
+     * @return The text shown for @p node, which is cached for the current format settings.
+     */
+    QString textForTreeLeaf(const TreeLeafItem* node) const;
 
     /**
      * @return Item for given index. At maximum one of the pointers in the pair will be valid.
@@ -55,7 +80,7 @@ public:
     /**
      * @return Index for given item. At maximum one of the pointers should be valid in the input pair.
      */
-    QModelIndex indexForItem(const QPair<TreeLeafItem*, SnapshotItem*>& item) const;
+    QModelIndex indexForItem(const QPair<TreeLeafItem*, SnapshotItem*>& item);
 
     /**
      * @return Index for given snapshot, or invalid if it's not a detailed snapshot.
@@ -64,8 +89,10 @@ public:
 
     /**
      * @return Index for given TreeLeafItem, or invalid if it's not covered by this model.
+     *
+     * The children of its parents get fetched as far as needed.
      */
-    QModelIndex indexForTreeLeaf(TreeLeafItem* node) const;
+    QModelIndex indexForTreeLeaf(TreeLeafItem* node);
 
     virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
     virtual int rowCount(const QModelIndex& parent = QModelIndex()) const;
@@ -73,14 +100,25 @@ public:
     virtual QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const;
     virtual QModelIndex parent(const QModelIndex& child) const;
     virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+    virtual bool canFetchMore(const QModelIndex& parent) const;
+    virtual void fetchMore(const QModelIndex& parent);
 
     SnapshotItem* snapshotForTreeLeaf(TreeLeafItem* node) const;
 private:
-    const FileData* m_data;
+    /// @return The number of children of @p node that are exposed already.
+    int fetchedChildren(const TreeLeafItem* node) const;
+    /// @return The row of @p node, i.e. the one of its snapshot for heap tree roots.
+    int rowForTreeLeaf(const TreeLeafItem* node) const;
 
-    void mapNodeToRow(TreeLeafItem* node, const int row);
-    QMap<TreeLeafItem*, int> m_nodeToRow;
-    QMap<TreeLeafItem*, SnapshotItem*> m_heapRootToSnapshot;
+    const FileData* m_data;
+    // snapshot => row
+    QHash<const SnapshotItem*, int> m_snapshotRows;
+    // node with more children than the batch size => number of exposed children
+    QHash<const TreeLeafItem*, int> m_fetched;
+    int m_fetchBatchSize;
+    // node, cost precision and shortened templates => text of recently shown nodes
+    typedef QPair<const TreeLeafItem*, QPair<int, int> > LeafTextKey;
+    mutable QCache<LeafTextKey, QString> m_leafTexts;
 };
 
 }
@@ -0,0 +1,143 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "datatreesearch.h"
+
+#include <QtCore/QMutexLocker>
+
+#include <KDebug>
+
+using namespace Massif;
+
+DataTreeSearch::DataTreeSearch(const LabelSearchIndexHandle& index, const QString& needle,
+                               const QVector<int>* candidates, QObject* parent)
+    : QThread(parent), m_index(index), m_needle(needle), m_refine(candidates != 0)
+    , m_done(false), m_canceled(false)
+{
+    if (candidates) {
+        m_candidates = *candidates;
+    }
+}
+
+DataTreeSearch::~DataTreeSearch()
+{
+}
+
+void DataTreeSearch::cancel()
+{
+    m_canceled = true;
+}
+
+void DataTreeSearch::run()
+{
+    QMutexLocker indexLock(m_index->mutex());
+    if (m_canceled) {
+        return;
+    }
+
+    // the labels indexed so far are matched at once, new ones whenever a snapshot gets indexed
+    QVector<int> labels = m_index->find(m_needle, m_refine ? &m_candidates : 0);
+    QVector<bool> matches(m_index->labelCount(), false);
+    foreach (int label, labels) {
+        matches[label] = true;
+    }
+
+    // report the results every few snapshots, at most ten times
+    const int batchSize = qMax(1, m_index->snapshotCount() / 10);
+    QVector<bool> marked(m_index->nodeCount(), false);
+    QList<const TreeLeafItem*> nodes;
+    for (int snapshot = 0; snapshot < m_index->snapshotCount(); ++snapshot) {
+        if (m_canceled) {
+            return;
+        }
+        if (snapshot == m_index->indexedSnapshotCount()) {
+            const int firstLabel = m_index->labelCount();
+            m_index->indexNextSnapshot();
+            matches.resize(m_index->labelCount());
+            marked.resize(m_index->nodeCount());
+            // refined searches only run on a complete index, all their candidates are known already
+            if (!m_refine) {
+                QVector<int> fresh;
+                fresh.reserve(m_index->labelCount() - firstLabel);
+                for (int label = firstLabel; label < m_index->labelCount(); ++label) {
+                    fresh << label;
+                }
+                const QVector<int> found = m_index->find(m_needle, &fresh);
+                // ids of new labels are bigger than the ones found before, hence this stays sorted
+                labels += found;
+                foreach (int label, found) {
+                    matches[label] = true;
+                }
+            }
+        }
+        m_index->collectNodes(snapshot, matches, &marked, &nodes);
+        const bool last = snapshot + 1 == m_index->snapshotCount();
+        if (!last && (nodes.isEmpty() || (snapshot + 1) % batchSize)) {
+            continue;
+        }
+        {
+            QMutexLocker lock(&m_mutex);
+            foreach (const TreeLeafItem* node, nodes) {
+                m_results.insert(node);
+            }
+            if (last) {
+                kDebug() << labels.size() << "labels match" << m_needle;
+                m_labels = labels;
+                m_done = true;
+            }
+        }
+        nodes.clear();
+        emit resultsReady();
+    }
+    if (!m_index->snapshotCount()) {
+        {
+            QMutexLocker lock(&m_mutex);
+            m_done = true;
+        }
+        emit resultsReady();
+    }
+}
+
+QSet<const TreeLeafItem*> DataTreeSearch::takeResults()
+{
+    QMutexLocker lock(&m_mutex);
+    QSet<const TreeLeafItem*> ret = m_results;
+    m_results.clear();
+    return ret;
+}
+
+bool DataTreeSearch::isDone() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_done;
+}
+
+QString DataTreeSearch::needle() const
+{
+    return m_needle;
+}
+
+QVector<int> DataTreeSearch::labels() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_labels;
+}
+
+#include "datatreesearch.moc"
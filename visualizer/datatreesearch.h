@@ -0,0 +1,107 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MASSIF_DATATREESEARCH_H
+#define MASSIF_DATATREESEARCH_H
+
+#include <QThread>
+#include <QtCore/QMutex>
+#include <QtCore/QSet>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+#include "labelsearchindex.h"
+
+#include "visualizer_export.h"
+
+namespace Massif {
+
+class TreeLeafItem;
+
+/**
+ * Finds all heap tree nodes whose label contains a search string, together with their ancestors.
+ *
+ * The results are reported in batches of snapshots, such that they can be shown
+ * before the whole file was searched.
+ */
+class VISUALIZER_EXPORT DataTreeSearch : public QThread
+{
+    Q_OBJECT
+public:
+    /**
+     * Searches for @p needle in @p index, which is completed one snapshot at a time
+     * along the search if required. The index is locked while the search runs, a search
+     * that is still busy with it delays the next one until it noticed that it got canceled.
+     *
+     * If @p candidates is given, only those labels are considered, e.g. the labels
+     * found by a previous search for a substring of @p needle.
+     */
+    DataTreeSearch(const LabelSearchIndexHandle& index, const QString& needle,
+                   const QVector<int>* candidates = 0, QObject* parent = 0);
+    ~DataTreeSearch();
+
+    /**
+     * Stops the search.
+     */
+    void cancel();
+
+    virtual void run();
+
+    /**
+     * @return The nodes found since the last call.
+     */
+    QSet<const TreeLeafItem*> takeResults();
+
+    /**
+     * @return True if the search finished, i.e. all results were reported.
+     */
+    bool isDone() const;
+
+    /**
+     * @return The search string.
+     */
+    QString needle() const;
+
+    /**
+     * @return The ids of all matching labels, once the search is done.
+     */
+    QVector<int> labels() const;
+
+signals:
+    /**
+     * Emitted whenever new results can be taken.
+     */
+    void resultsReady();
+
+private:
+    LabelSearchIndexHandle m_index;
+    QString m_needle;
+    QVector<int> m_candidates;
+    bool m_refine;
+    QVector<int> m_labels;
+    mutable QMutex m_mutex;
+    QSet<const TreeLeafItem*> m_results;
+    bool m_done;
+    bool m_canceled;
+};
+
+}
+
+#endif // MASSIF_DATATREESEARCH_H
@@ -0,0 +1,145 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "deltatreegenerator.h"
+
+#include "massifdata/snapshotitem.h"
+#include "massifdata/treeleafitem.h"
+
+#include "deltatreeitem.h"
+#include "util.h"
+
+#include <QtCore/QHash>
+
+#include <KDebug>
+
+using namespace Massif;
+
+DeltaTreeGenerator::DeltaTreeGenerator(const FileDataHandle& data, const SnapshotItem* before,
+                                       const SnapshotItem* after, QObject* parent)
+    : QThread(parent), m_data(data), m_before(before), m_after(after), m_result(0), m_canceled(false)
+{
+}
+
+DeltaTreeGenerator::~DeltaTreeGenerator()
+{
+    delete m_result;
+}
+
+void DeltaTreeGenerator::cancel()
+{
+    m_canceled = true;
+}
+
+void DeltaTreeGenerator::run()
+{
+    if (m_canceled || !m_before || !m_after) {
+        return;
+    }
+
+    const TreeLeafItem* beforeTree = m_before->heapTree();
+    const TreeLeafItem* afterTree = m_after->heapTree();
+    if (!beforeTree && !afterTree) {
+        return;
+    }
+
+    kDebug() << "computing delta tree between snapshot" << m_before->number() << "and" << m_after->number();
+
+    // the root is always shown, even if the total heap cost did not change
+    DeltaTreeItem* root = new DeltaTreeItem(afterTree ? afterTree->label() : beforeTree->label(),
+                                            m_before->memHeap(), m_after->memHeap());
+    mergeChildren(root, beforeTree, afterTree);
+
+    if (m_canceled) {
+        delete root;
+        return;
+    }
+    m_result = root;
+}
+
+DeltaTreeItem* DeltaTreeGenerator::diff(const TreeLeafItem* before, const TreeLeafItem* after)
+{
+    Q_ASSERT(before || after);
+
+    if (m_canceled) {
+        return 0;
+    }
+
+    const unsigned long costBefore = before ? before->cost() : 0;
+    const unsigned long costAfter = after ? after->cost() : 0;
+
+    DeltaTreeItem* item = new DeltaTreeItem(after ? after->label() : before->label(), costBefore, costAfter);
+    mergeChildren(item, before, after);
+    if (costBefore == costAfter && item->children().isEmpty()) {
+        // the cost might just have moved between the callers, only drop unchanged subtrees
+        delete item;
+        return 0;
+    }
+    return item;
+}
+
+static inline QString mergeKey(const TreeLeafItem* node)
+{
+    // "below threshold" nodes are merged regardless of their place count
+    return isBelowThreshold(node->label()) ? QString() : node->label();
+}
+
+void DeltaTreeGenerator::mergeChildren(DeltaTreeItem* item, const TreeLeafItem* before, const TreeLeafItem* after)
+{
+    QHash<QString, const TreeLeafItem*> beforeChildren;
+    if (before) {
+        foreach (const TreeLeafItem* child, before->children()) {
+            beforeChildren.insert(mergeKey(child), child);
+        }
+    }
+    if (after) {
+        foreach (const TreeLeafItem* child, after->children()) {
+            if (DeltaTreeItem* childItem = diff(beforeChildren.take(mergeKey(child)), child)) {
+                item->addChild(childItem);
+            }
+        }
+    }
+    // whatever is left was released completely
+    foreach (const TreeLeafItem* child, beforeChildren) {
+        if (DeltaTreeItem* childItem = diff(child, 0)) {
+            item->addChild(childItem);
+        }
+    }
+    item->sortChildren();
+}
+
+DeltaTreeItem* DeltaTreeGenerator::takeResult()
+{
+    DeltaTreeItem* ret = m_result;
+    m_result = 0;
+    return ret;
+}
+
+const SnapshotItem* DeltaTreeGenerator::before() const
+{
+    return m_before;
+}
+
+const SnapshotItem* DeltaTreeGenerator::after() const
+{
+    return m_after;
+}
+
+#include "deltatreegenerator.moc"
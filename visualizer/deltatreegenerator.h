@@ -0,0 +1,85 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MASSIF_DELTATREEGENERATOR_H
+#define MASSIF_DELTATREEGENERATOR_H
+
+#include <QThread>
+
+#include "visualizer_export.h"
+
+#include "massifdata/filedata.h"
+
+namespace Massif {
+
+class SnapshotItem;
+class TreeLeafItem;
+class DeltaTreeItem;
+
+/**
+ * Computes the difference between the heap trees of two snapshots.
+ *
+ * Both trees are merged by call path, subtrees in which no cost changed
+ * are dropped and the remaining children are sorted by their delta.
+ */
+class VISUALIZER_EXPORT DeltaTreeGenerator : public QThread
+{
+    Q_OBJECT
+public:
+    /**
+     * Compares the heap tree of @p after against the one of @p before.
+     *
+     * @p data owns the snapshots and is kept alive while the generator exists.
+     */
+    DeltaTreeGenerator(const FileDataHandle& data, const SnapshotItem* before, const SnapshotItem* after,
+                       QObject* parent = 0);
+    ~DeltaTreeGenerator();
+
+    /**
+     * Stops computing the delta tree.
+     */
+    void cancel();
+
+    virtual void run();
+
+    /**
+     * @return The root of the delta tree or zero if none could be computed.
+     *
+     * @note The caller takes ownership.
+     */
+    DeltaTreeItem* takeResult();
+
+    const SnapshotItem* before() const;
+    const SnapshotItem* after() const;
+
+private:
+    DeltaTreeItem* diff(const TreeLeafItem* before, const TreeLeafItem* after);
+    void mergeChildren(DeltaTreeItem* item, const TreeLeafItem* before, const TreeLeafItem* after);
+
+    FileDataHandle m_data;
+    const SnapshotItem* m_before;
+    const SnapshotItem* m_after;
+    DeltaTreeItem* m_result;
+    bool m_canceled;
+};
+
+}
+
+#endif // MASSIF_DELTATREEGENERATOR_H
@@ -0,0 +1,90 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "deltatreeitem.h"
+
+#include <QtCore/qalgorithms.h>
+
+using namespace Massif;
+
+DeltaTreeItem::DeltaTreeItem(const QString& label, unsigned long before, unsigned long after)
+    : m_label(label), m_before(before), m_after(after), m_parent(0), m_row(0)
+{
+}
+
+DeltaTreeItem::~DeltaTreeItem()
+{
+    qDeleteAll(m_children);
+}
+
+QString DeltaTreeItem::label() const
+{
+    return m_label;
+}
+
+unsigned long DeltaTreeItem::costBefore() const
+{
+    return m_before;
+}
+
+unsigned long DeltaTreeItem::costAfter() const
+{
+    return m_after;
+}
+
+long DeltaTreeItem::delta() const
+{
+    return long(m_after) - long(m_before);
+}
+
+void DeltaTreeItem::addChild(DeltaTreeItem* item)
+{
+    item->m_parent = this;
+    item->m_row = m_children.size();
+    m_children << item;
+}
+
+bool sortByAbsoluteDelta(const DeltaTreeItem* l, const DeltaTreeItem* r)
+{
+    return qAbs(l->delta()) > qAbs(r->delta());
+}
+
+void DeltaTreeItem::sortChildren()
+{
+    qSort(m_children.begin(), m_children.end(), sortByAbsoluteDelta);
+    for (int i = 0; i < m_children.size(); ++i) {
+        m_children.at(i)->m_row = i;
+    }
+}
+
+QList< DeltaTreeItem* > DeltaTreeItem::children() const
+{
+    return m_children;
+}
+
+DeltaTreeItem* DeltaTreeItem::parent() const
+{
+    return m_parent;
+}
+
+int DeltaTreeItem::row() const
+{
+    return m_row;
+}
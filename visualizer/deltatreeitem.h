@@ -0,0 +1,96 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MASSIF_DELTATREEITEM_H
+#define MASSIF_DELTATREEITEM_H
+
+#include <QtCore/QString>
+#include <QtCore/QList>
+
+#include "visualizer_export.h"
+
+namespace Massif {
+
+/**
+ * A node in the difference tree of two heap trees.
+ *
+ * Nodes are matched by their call path, i.e. the labels of all parents.
+ */
+class VISUALIZER_EXPORT DeltaTreeItem
+{
+public:
+    DeltaTreeItem(const QString& label, unsigned long before, unsigned long after);
+    ~DeltaTreeItem();
+
+    /**
+     * @return The label of this node.
+     */
+    QString label() const;
+
+    /**
+     * @return The cost of this node in the base snapshot.
+     */
+    unsigned long costBefore() const;
+    /**
+     * @return The cost of this node in the compared snapshot.
+     */
+    unsigned long costAfter() const;
+    /**
+     * @return The change in cost, negative if memory got released.
+     */
+    long delta() const;
+
+    /**
+     * Adds @p item as child of this node and takes ownership.
+     */
+    void addChild(DeltaTreeItem* item);
+
+    /**
+     * Sorts the children by their absolute delta, biggest change first.
+     */
+    void sortChildren();
+
+    /**
+     * @return The children of this node.
+     */
+    QList<DeltaTreeItem*> children() const;
+
+    /**
+     * @return The parent item or zero, if this is the root node.
+     */
+    DeltaTreeItem* parent() const;
+
+    /**
+     * @return The row of this item in its parent's children.
+     */
+    int row() const;
+
+private:
+    QString m_label;
+    unsigned long m_before;
+    unsigned long m_after;
+    QList<DeltaTreeItem*> m_children;
+    DeltaTreeItem* m_parent;
+    int m_row;
+};
+
+}
+
+#endif // MASSIF_DELTATREEITEM_H
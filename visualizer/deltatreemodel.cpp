@@ -0,0 +1,166 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "deltatreemodel.h"
+
+#include "massifdata/snapshotitem.h"
+
+#include "deltatreeitem.h"
+#include "util.h"
+
+#include <KLocalizedString>
+
+#include <QtGui/QBrush>
+#include <QtGui/QTextDocument>
+
+using namespace Massif;
+
+DeltaTreeModel::DeltaTreeModel(QObject* parent)
+    : QAbstractItemModel(parent), m_root(0), m_before(0), m_after(0)
+{
+}
+
+DeltaTreeModel::~DeltaTreeModel()
+{
+    delete m_root;
+}
+
+void DeltaTreeModel::setSource(DeltaTreeItem* root, const SnapshotItem* before, const SnapshotItem* after)
+{
+    if (m_root) {
+        beginRemoveRows(QModelIndex(), 0, 0);
+        delete m_root;
+        m_root = 0;
+        m_before = 0;
+        m_after = 0;
+        endRemoveRows();
+    }
+    if (root) {
+        beginInsertRows(QModelIndex(), 0, 0);
+        m_root = root;
+        m_before = before;
+        m_after = after;
+        endInsertRows();
+    }
+}
+
+DeltaTreeItem* DeltaTreeModel::itemForIndex(const QModelIndex& idx) const
+{
+    if (!m_root || !idx.isValid()) {
+        return 0;
+    }
+    return static_cast<DeltaTreeItem*>(idx.internalPointer());
+}
+
+QVariant DeltaTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (section == 0 && orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        if (m_before && m_after) {
+            return i18n("Changes from snapshot #%1 to #%2", m_before->number(), m_after->number());
+        }
+        return i18n("Changes");
+    }
+    return QAbstractItemModel::headerData(section, orientation, role);
+}
+
+QVariant DeltaTreeModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+
+    Q_ASSERT(index.row() >= 0 && index.row() < rowCount(index.parent()));
+    Q_ASSERT(index.column() >= 0 && index.column() < columnCount(index.parent()));
+    Q_ASSERT(m_root);
+
+    DeltaTreeItem* item = static_cast<DeltaTreeItem*>(index.internalPointer());
+    Q_ASSERT(item);
+
+    if (role == Qt::ForegroundRole) {
+        if (item->delta() > 0) {
+            return QBrush(Qt::darkRed);
+        } else if (item->delta() < 0) {
+            return QBrush(Qt::darkGreen);
+        }
+        return QVariant();
+    }
+
+    if (role == Qt::ToolTipRole) {
+        QString tooltip = "<html><head><style>dt{font-weight:bold;} dd {font-family:monospace;}</style></head><body><dl>\n";
+        tooltip += i18n("<dt>change:</dt><dd>%1</dd>", prettyCostDelta(item->delta()));
+        tooltip += i18n("<dt>cost in snapshot #%1:</dt><dd>%2</dd>", m_before->number(), prettyCost(item->costBefore()));
+        tooltip += i18n("<dt>cost in snapshot #%1:</dt><dd>%2</dd>", m_after->number(), prettyCost(item->costAfter()));
+        tooltip += i18n("<dt>label:</dt><dd>%1</dd>", Qt::escape(prettyLabel(item->label())));
+        tooltip += "</dl></body></html>";
+        return tooltip;
+    }
+
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    return i18nc("%1: change in cost, %2: snapshot label (i.e. func name etc.)", "%1: %2",
+                 prettyCostDelta(item->delta()), prettyLabel(item->label()));
+}
+
+int DeltaTreeModel::columnCount(const QModelIndex&) const
+{
+    return 1;
+}
+
+int DeltaTreeModel::rowCount(const QModelIndex& parent) const
+{
+    if (!m_root || (parent.isValid() && parent.column() != 0)) {
+        return 0;
+    }
+
+    if (parent.isValid()) {
+        return static_cast<DeltaTreeItem*>(parent.internalPointer())->children().size();
+    } else {
+        return 1;
+    }
+}
+
+QModelIndex DeltaTreeModel::index(int row, int column, const QModelIndex& parent) const
+{
+    if (row < 0 || row >= rowCount(parent) || column < 0 || column >= columnCount(parent)) {
+        // invalid
+        return QModelIndex();
+    }
+
+    if (parent.isValid()) {
+        DeltaTreeItem* parentItem = static_cast<DeltaTreeItem*>(parent.internalPointer());
+        return createIndex(row, column, static_cast<void*>(parentItem->children().at(row)));
+    } else {
+        return createIndex(row, column, static_cast<void*>(m_root));
+    }
+}
+
+QModelIndex DeltaTreeModel::parent(const QModelIndex& child) const
+{
+    if (!child.isValid()) {
+        return QModelIndex();
+    }
+    DeltaTreeItem* item = static_cast<DeltaTreeItem*>(child.internalPointer());
+    if (!item->parent()) {
+        return QModelIndex();
+    }
+    return createIndex(item->parent()->row(), 0, static_cast<void*>(item->parent()));
+}
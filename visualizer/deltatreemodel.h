@@ -0,0 +1,68 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MASSIF_DELTATREEMODEL_H
+#define MASSIF_DELTATREEMODEL_H
+
+#include <QtCore/QAbstractItemModel>
+
+#include "visualizer_export.h"
+
+namespace Massif {
+
+class DeltaTreeItem;
+class SnapshotItem;
+
+/**
+ * A model that shows the changes in cost between two snapshots.
+ */
+class VISUALIZER_EXPORT DeltaTreeModel : public QAbstractItemModel
+{
+public:
+    DeltaTreeModel(QObject* parent = 0);
+    virtual ~DeltaTreeModel();
+
+    /**
+     * Set the delta tree @p root, computed between @p before and @p after.
+     * The model takes ownership of @p root.
+     */
+    void setSource(DeltaTreeItem* root, const SnapshotItem* before, const SnapshotItem* after);
+
+    /**
+     * @return Item for given index or zero if the index is invalid.
+     */
+    DeltaTreeItem* itemForIndex(const QModelIndex& idx) const;
+
+    virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
+    virtual int rowCount(const QModelIndex& parent = QModelIndex()) const;
+    virtual int columnCount(const QModelIndex& parent = QModelIndex()) const;
+    virtual QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const;
+    virtual QModelIndex parent(const QModelIndex& child) const;
+    virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+
+private:
+    DeltaTreeItem* m_root;
+    const SnapshotItem* m_before;
+    const SnapshotItem* m_after;
+};
+
+}
+
+#endif // MASSIF_DELTATREEMODEL_H
@@ -24,6 +24,8 @@
 
 #include "massifdata/filedata.h"
 #include "massifdata/snapshotitem.h"
+#include "massifdata/symbol.h"
+#include "massifdata/symboltable.h"
 #include "massifdata/treeleafitem.h"
 
 #include "KDChartGlobal"
@@ -36,15 +38,60 @@
 #include <QtGui/QPen>
 #include <QtGui/QBrush>
 
-#include <QtCore/QMultiMap>
+#include <QtCore/QHash>
+#include <QtCore/QSet>
+#include <QtCore/QtConcurrentMap>
 #include <QtCore/qalgorithms.h>
 
 #include <KLocalizedString>
 
+#include <cmath>
+
 using namespace Massif;
 
+namespace {
+
+/**
+ * Finds the cost intensive nodes of @p snapshot, i.e. its top level call sites
+ * followed down until their first fork.
+ */
+QList<TreeLeafItem*> interestingNodes(SnapshotItem* snapshot)
+{
+    QList<TreeLeafItem*> nodes;
+    foreach (TreeLeafItem* node, snapshot->heapTree()->children()) {
+        if (isBelowThreshold(node->label())) {
+            continue;
+        }
+        TreeLeafItem* end = node->chainEnd();
+        // when we traverse the tree down until the end (i.e. no forks),
+        // we end up in main() most probably, and that's uninteresting
+        nodes << (end->children().isEmpty() ? node : end);
+    }
+    return nodes;
+}
+
+struct ColumnPeak
+{
+    QString label;
+    unsigned long cost;
+    TreeLeafItem* node;
+    int row;
+    // when the peak was found, columns with equal peaks keep that order
+    int found;
+};
+
+bool sortByPeak(const ColumnPeak& l, const ColumnPeak& r)
+{
+    if (l.cost != r.cost) {
+        return l.cost > r.cost;
+    }
+    return l.found < r.found;
+}
+
+}
+
 DetailedCostModel::DetailedCostModel(QObject* parent)
-    : QAbstractTableModel(parent), m_data(0), m_maxDatasetCount(10)
+    : QAbstractTableModel(parent), m_data(0), m_shownCount(0), m_maxDatasetCount(10), m_firstTime(0)
 {
 }
 
@@ -58,57 +105,98 @@ void DetailedCostModel::setSource(const FileData* data)
         beginRemoveRows(QModelIndex(), 0, rowCount() - 1);
         m_data = 0;
         m_columns.clear();
+        m_order.clear();
+        m_hidden.clear();
+        m_hideHistory.clear();
+        m_shownCount = 0;
         m_rows.clear();
+        m_windowIndex.clear();
+        m_windowSeries.clear();
+        m_costs.clear();
         m_nodes.clear();
         m_peaks.clear();
+        m_seriesIds.clear();
+        m_nodeIndex.clear();
+        m_columnSeries.clear();
+        m_seriesColumns.clear();
+        m_shownCosts.clear();
+        m_singleLabel.clear();
+        m_firstTime = 0;
         endRemoveRows();
     }
     if (data) {
-        // get top cost points:
-        // we traverse the detailed heap trees until the first fork
-        QMultiMap<int, QString> sortColumnMap;
         foreach (SnapshotItem* snapshot, data->snapshots()) {
             if (snapshot->heapTree()) {
-                QList<TreeLeafItem*> nodes;
-                foreach (TreeLeafItem* node, snapshot->heapTree()->children()) {
-                    if (isBelowThreshold(node->label())) {
-                        continue;
-                    }
-                    // find interesting node, i.e. until first fork
-                    TreeLeafItem* firstNode = node;
-                    while (node->children().size() == 1 && node->children().first()->cost() == node->cost()) {
-                        node = node->children().first();
-                    }
-                    if (node->children().isEmpty()) {
-                        // when we traverse the tree down until the end (i.e. no forks),
-                        // we end up in main() most probably, and that's uninteresting
-                        node = firstNode;
-                    }
-                    if (!sortColumnMap.values().contains(node->label())) {
-                        sortColumnMap.insert(node->cost(), node->label());
-                        m_peaks[node->label()] = qMakePair(node, snapshot);
-                    } else {
-                        unsigned int cost = sortColumnMap.key(node->label());
-                        if (node->cost() > cost) {
-                            sortColumnMap.remove(cost, node->label());
-                            cost = node->cost();
-                            sortColumnMap.insert(cost, node->label());
-                            m_peaks[node->label()].first = node;
-                            m_peaks[node->label()].second = snapshot;
-                        }
-                    }
-                    nodes << node;
-                }
                 m_rows << snapshot;
-                m_nodes[snapshot] = nodes;
             }
         }
-        m_columns = sortColumnMap.values();
-        QAlgorithmsPrivate::qReverse(m_columns.begin(), m_columns.end());
-
         if (m_rows.isEmpty()) {
             return;
         }
+
+        // get top cost points: the snapshots are independent of each other,
+        // hence their heap trees are traversed until the first fork in parallel
+        const QList< QList<TreeLeafItem*> > nodes = QtConcurrent::blockingMapped< QList< QList<TreeLeafItem*> > >(m_rows, interestingNodes);
+
+        // every label becomes a column, ordered by its peak cost
+        QHash<QString, int> peakIds;
+        QVector<ColumnPeak> peaks;
+        int found = 0;
+        for (int row = 0; row < m_rows.size(); ++row) {
+            foreach (TreeLeafItem* node, nodes.at(row)) {
+                QHash<QString, int>::const_iterator it = peakIds.constFind(node->label());
+                if (it == peakIds.constEnd()) {
+                    const ColumnPeak peak = { node->label(), node->cost(), node, row, found };
+                    peakIds.insert(node->label(), peaks.size());
+                    peaks << peak;
+                } else if (node->cost() > peaks.at(it.value()).cost) {
+                    ColumnPeak& peak = peaks[it.value()];
+                    peak.cost = node->cost();
+                    peak.node = node;
+                    peak.row = row;
+                    peak.found = found;
+                }
+                ++found;
+            }
+        }
+        qSort(peaks.begin(), peaks.end(), sortByPeak);
+        m_columns.reserve(peaks.size());
+        m_seriesIds.reserve(peaks.size());
+        m_peaks.reserve(peaks.size());
+        for (int i = 0; i < peaks.size(); ++i) {
+            const ColumnPeak& peak = peaks.at(i);
+            m_columns << peak.label;
+            m_seriesIds.insert(peak.label, i);
+            m_peaks << qMakePair(peak.node, peak.row);
+        }
+
+        // cost series of all columns, for the datasets and ranking within time windows
+        QVector<double> times;
+        times.reserve(m_rows.size());
+        m_costs.fill(0, m_columns.size() * m_rows.size());
+        m_nodes.fill(0, m_columns.size() * m_rows.size());
+        m_nodeIndex.reserve(found);
+        for (int row = 0; row < m_rows.size(); ++row) {
+            times << m_rows.at(row)->time();
+            foreach (TreeLeafItem* node, nodes.at(row)) {
+                const int series = m_seriesIds.value(node->label());
+                m_nodeIndex.insert(node, qMakePair(row, series));
+                const int offset = series * m_rows.size() + row;
+                // only take the first node with a given label into account
+                if (!m_nodes.at(offset)) {
+                    m_nodes[offset] = node;
+                    m_costs[offset] = node->cost();
+                }
+            }
+        }
+        m_windowIndex.build(times, m_costs);
+        m_windowSeries = m_columns;
+        m_order = m_columns;
+        updateColumns();
+
+        // get x-coordinate of the last snapshot with cost below 0.1% of peak cost
+        m_firstTime = data->columns().timeBefore(std::ceil(data->peak()->memHeap() * 0.001));
+
         // +1 for the offset (+0 would be m_rows.size() -1)
         beginInsertRows(QModelIndex(), 0, m_rows.size());
         m_data = data;
@@ -119,9 +207,10 @@ void DetailedCostModel::setSource(const FileData* data)
 void DetailedCostModel::setMaximumDatasetCount(int count)
 {
     Q_ASSERT(count >= 0);
-    const int currentCols = qMin(m_columns.size(), m_maxDatasetCount);
+    const int currentCols = m_shownCount;
     const int newCols = qMin(m_columns.size(), count);
     if (currentCols == newCols) {
+        m_maxDatasetCount = count;
         return;
     }
     if (newCols < currentCols) {
@@ -129,13 +218,18 @@ void DetailedCostModel::setMaximumDatasetCount(int count)
     } else {
         beginInsertColumns(QModelIndex(), currentCols * 2, newCols * 2 - 1);
     }
+    for (int column = qMin(currentCols, newCols); column < qMax(currentCols, newCols); ++column) {
+        updateShownCosts(m_columnSeries.at(column), newCols > currentCols);
+    }
     m_maxDatasetCount = count;
+    m_shownCount = newCols;
     if (newCols < currentCols) {
         endRemoveColumns();
     } else {
         endInsertColumns();
     }
-    Q_ASSERT(columnCount() == newCols * 2);
+    Q_ASSERT(columnCount() == (newCols + 1) * 2);
+    otherCostChanged();
 }
 
 int DetailedCostModel::maximumDatasetCount() const
@@ -170,7 +264,8 @@ QVariant DetailedCostModel::data(const QModelIndex& index, int role) const
     }
 
     if (role == KDChart::DatasetBrushRole || role == KDChart::DatasetPenRole) {
-        QColor c = QColor::fromHsv(double(index.column() + 1) / columnCount() * 255, 255, 255);
+        QColor c = isOtherColumn(index.column()) ? QColor(Qt::gray)
+                 : QColor::fromHsv(double(index.column() + 1) / columnCount() * 255, 255, 255);
         if (role == KDChart::DatasetBrushRole) {
             return QBrush(c);
         } else {
@@ -187,14 +282,7 @@ QVariant DetailedCostModel::data(const QModelIndex& index, int role) const
             return QVariant();
         } else {
             if (index.column() % 2 == 0) {
-                // get x-coordinate of the last snapshot with cost below 0.1% of peak cost
-                QList< SnapshotItem* >::const_iterator it = m_data->snapshots().constBegin();
-                double time = 0;
-                while (it != m_data->snapshots().constEnd() && (*it)->memHeap() < m_data->peak()->memHeap() * 0.001) {
-                    time = (*it)->time();
-                    ++it;
-                }
-                return time;
+                return m_firstTime;
             } else {
                 // cost to 0
                 return 0;
@@ -214,36 +302,40 @@ QVariant DetailedCostModel::data(const QModelIndex& index, int role) const
 
     if (index.column() % 2 == 0 && role != Qt::ToolTipRole) {
         return snapshot->time();
-    } else {
-        TreeLeafItem* node = 0;
-        const QString needle = m_columns.at(index.column() / 2);
-        foreach(TreeLeafItem* n, m_nodes[snapshot]) {
-            if (n->label() == needle) {
-                node = n;
-                break;
-            }
-        }
+    } else if (isOtherColumn(index.column())) {
+        const int row = role == Qt::ToolTipRole ? index.row() : index.row() - 1;
+        const unsigned long cost = otherCost(row);
         if (role == Qt::ToolTipRole) {
-            return tooltipForTreeLeaf(node, snapshot, needle);
+            return i18n("<dl><dt>other functions:</dt>"
+                        "<dd>%1, i.e. %2% of snapshot #%3</dd></dl>",
+                        prettyCost(cost),
+                        double(int(double(cost)/snapshot->memHeap()*10000))/100,
+                        snapshot->number());
         } else {
-            return double(node ? node->cost() : 0);
+            return double(cost);
         }
+    } else if (role != Qt::ToolTipRole) {
+        return double(cost(index.row() - 1, index.column() / 2));
+    } else {
+        const int column = index.column() / 2;
+        return tooltipForTreeLeaf(node(index.row(), column), snapshot, m_columns.at(column));
     }
 }
 
 QVariant DetailedCostModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
     if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section % 2 == 0 && section < columnCount()) {
-        // only show name without memory address or location
-        QString label = prettyLabel(m_columns.at(section / 2));
-        if (label.indexOf("???") != -1) {
-            return label;
+        if (isOtherColumn(section)) {
+            return i18n("other");
         }
-        int endPos = label.lastIndexOf('(');
-        if (endPos == -1) {
-            return label;
+        // only show name without memory address or location
+        const QString& column = m_columns.at(section / 2);
+        const Symbol* symbol = m_data ? m_data->symbols()->find(column) : 0;
+        const Symbol parsed = symbol ? *symbol : Symbol(column);
+        if (parsed.function().startsWith(QLatin1String("???"))) {
+            return prettyLabel(parsed);
         }
-        label = label.mid(0, endPos - 1);
+        QString label = functionInLabel(parsed);
         const int maxLen = 40;
         if (label.length() > maxLen) {
             label.resize(maxLen - 3);
@@ -256,7 +348,174 @@ QVariant DetailedCostModel::headerData(int section, Qt::Orientation orientation,
 
 int DetailedCostModel::columnCount(const QModelIndex&) const
 {
-    return qMin(m_maxDatasetCount, m_columns.size()) * 2;
+    if (m_rows.isEmpty()) {
+        return 0;
+    }
+    // +1 for the other functions
+    return (shownColumns() + 1) * 2;
+}
+
+int DetailedCostModel::shownColumns() const
+{
+    return m_shownCount;
+}
+
+bool DetailedCostModel::isOtherColumn(int column) const
+{
+    return column / 2 == shownColumns();
+}
+
+quint64 DetailedCostModel::cost(int row, int column) const
+{
+    const int series = m_columnSeries.at(column);
+    if (series == -1) {
+        return 0;
+    }
+    return m_costs.at(series * m_rows.size() + row);
+}
+
+TreeLeafItem* DetailedCostModel::node(int row, int column) const
+{
+    const int series = m_columnSeries.at(column);
+    if (series == -1) {
+        return 0;
+    }
+    return m_nodes.at(series * m_rows.size() + row);
+}
+
+unsigned long DetailedCostModel::otherCost(int row) const
+{
+    const quint64 shown = m_shownCosts.at(row);
+    const quint64 total = m_rows.at(row)->memHeap();
+    return total > shown ? total - shown : 0;
+}
+
+void DetailedCostModel::updateColumns()
+{
+    updateColumnSeries();
+
+    m_shownCount = qMin(m_maxDatasetCount, m_columns.size());
+    m_shownCosts.fill(0, m_rows.size());
+    for (int column = 0; column < m_shownCount; ++column) {
+        updateShownCosts(m_columnSeries.at(column), true);
+    }
+}
+
+void DetailedCostModel::updateColumnSeries()
+{
+    m_columnSeries.resize(m_columns.size());
+    m_seriesColumns.fill(-1, m_peaks.size());
+    for (int column = 0; column < m_columns.size(); ++column) {
+        const int series = m_seriesIds.value(m_columns.at(column), -1);
+        m_columnSeries[column] = series;
+        if (series != -1) {
+            m_seriesColumns[series] = column;
+        }
+    }
+}
+
+void DetailedCostModel::setColumns(const QList<QString>& columns)
+{
+    const int newCount = qMin(m_maxDatasetCount, columns.size());
+    const QSet<QString> kept = columns.mid(0, newCount).toSet();
+
+    // remove the datasets that are gone, last run first such that the earlier ones keep their place
+    int column = m_shownCount;
+    while (column > 0) {
+        if (kept.contains(m_columns.at(column - 1))) {
+            --column;
+            continue;
+        }
+        const int last = column - 1;
+        while (column > 0 && !kept.contains(m_columns.at(column - 1))) {
+            --column;
+        }
+        beginRemoveColumns(QModelIndex(), column * 2, last * 2 + 1);
+        for (int i = last; i >= column; --i) {
+            updateShownCosts(m_columnSeries.at(i), false);
+            eraseColumn(i);
+        }
+        m_shownCount -= last - column + 1;
+        endRemoveColumns();
+    }
+
+    // the functions without a dataset of their own are taken from @p columns at the end
+    const QSet<QString> shown = m_columns.mid(0, m_shownCount).toSet();
+    m_columns = m_columns.mid(0, m_shownCount);
+    updateColumnSeries();
+
+    column = 0;
+    while (column < newCount) {
+        if (shown.contains(columns.at(column))) {
+            Q_ASSERT(m_columns.at(column) == columns.at(column));
+            ++column;
+            continue;
+        }
+        const int first = column;
+        while (column < newCount && !shown.contains(columns.at(column))) {
+            ++column;
+        }
+        beginInsertColumns(QModelIndex(), first * 2, column * 2 - 1);
+        for (int i = first; i < column; ++i) {
+            const int series = m_seriesIds.value(columns.at(i), -1);
+            restoreColumn(i, columns.at(i), series);
+            updateShownCosts(series, true);
+        }
+        m_shownCount += column - first;
+        endInsertColumns();
+    }
+    Q_ASSERT(m_shownCount == newCount);
+
+    m_columns = columns;
+    updateColumnSeries();
+    otherCostChanged();
+}
+
+void DetailedCostModel::eraseColumn(int column)
+{
+    const int series = m_columnSeries.at(column);
+    if (series != -1) {
+        m_seriesColumns[series] = -1;
+    }
+    m_columns.removeAt(column);
+    m_columnSeries.remove(column);
+    for (int i = column; i < m_columnSeries.size(); ++i) {
+        if (m_columnSeries.at(i) != -1) {
+            m_seriesColumns[m_columnSeries.at(i)] = i;
+        }
+    }
+}
+
+void DetailedCostModel::restoreColumn(int column, const QString& label, int series)
+{
+    m_columns.insert(column, label);
+    m_columnSeries.insert(column, series);
+    for (int i = column; i < m_columnSeries.size(); ++i) {
+        if (m_columnSeries.at(i) != -1) {
+            m_seriesColumns[m_columnSeries.at(i)] = i;
+        }
+    }
+}
+
+void DetailedCostModel::updateShownCosts(int series, bool shown)
+{
+    if (series == -1) {
+        return;
+    }
+    const quint64* costs = m_costs.constData() + series * m_rows.size();
+    for (int row = 0; row < m_rows.size(); ++row) {
+        if (shown) {
+            m_shownCosts[row] += costs[row];
+        } else {
+            m_shownCosts[row] -= costs[row];
+        }
+    }
+}
+
+void DetailedCostModel::otherCostChanged()
+{
+    const int column = shownColumns() * 2;
+    emit dataChanged(index(1, column), index(m_rows.size(), column + 1));
 }
 
 int DetailedCostModel::rowCount(const QModelIndex& parent) const
@@ -276,20 +535,14 @@ int DetailedCostModel::rowCount(const QModelIndex& parent) const
 QMap< QModelIndex, TreeLeafItem* > DetailedCostModel::peaks() const
 {
     QMap< QModelIndex, TreeLeafItem* > peaks;
-    QMap< QString, QPair<TreeLeafItem*,SnapshotItem*> >::const_iterator it = m_peaks.constBegin();
-    while (it != m_peaks.end()) {
-        int row = m_rows.indexOf(it->second);
-        Q_ASSERT(row >= 0);
-        int column = m_columns.indexOf(it->first->label());
-        if (column >= m_maxDatasetCount || column == -1) {
-            ++it;
+    for (int column = 0; column < shownColumns(); ++column) {
+        const int series = m_columnSeries.at(column);
+        if (series == -1 || !m_peaks.at(series).first) {
             continue;
         }
-        Q_ASSERT(column >= 0);
-        peaks[index(row + 1, column*2)] = it->first;
-        ++it;
+        const QPair<TreeLeafItem*, int>& peak = m_peaks.at(series);
+        peaks.insert(index(peak.second + 1, column * 2), peak.first);
     }
-    Q_ASSERT(peaks.size() == qMin(m_maxDatasetCount, m_columns.size()));
     return peaks;
 }
 
@@ -304,18 +557,15 @@ QModelIndex DetailedCostModel::indexForSnapshot(SnapshotItem* snapshot) const
 
 QModelIndex DetailedCostModel::indexForTreeLeaf(TreeLeafItem* node) const
 {
-    int column = m_columns.indexOf(node->label());
-    if (column == -1 || column >= m_maxDatasetCount) {
+    QHash<const TreeLeafItem*, QPair<int, int> >::const_iterator it = m_nodeIndex.constFind(node);
+    if (it == m_nodeIndex.constEnd()) {
         return QModelIndex();
     }
-    QMap< SnapshotItem*, QList< TreeLeafItem* > >::const_iterator it = m_nodes.constBegin();
-    while (it != m_nodes.constEnd()) {
-        if (it->contains(node)) {
-            return index(m_rows.indexOf(it.key()), column * 2);
-        }
-        ++it;
+    const int column = m_seriesColumns.at(it->second);
+    if (column == -1 || column >= m_maxDatasetCount) {
+        return QModelIndex();
     }
-    return QModelIndex();
+    return index(it->first, column * 2);
 }
 
 QPair< TreeLeafItem*, SnapshotItem* > DetailedCostModel::itemForIndex(const QModelIndex& idx) const
@@ -323,16 +573,13 @@ QPair< TreeLeafItem*, SnapshotItem* > DetailedCostModel::itemForIndex(const QMod
     if (!idx.isValid() || idx.parent().isValid() || idx.row() > rowCount() || idx.column() > columnCount()) {
         return QPair< TreeLeafItem*, SnapshotItem* >(0, 0);
     }
-    if (idx.row() == 0) {
+    if (idx.row() == 0 || isOtherColumn(idx.column())) {
         return QPair< TreeLeafItem*, SnapshotItem* >(0, 0);
     }
-    const QString needle = m_columns.at(idx.column() / 2);
     for (int i = 1; i < 3 && idx.row() - i >= 0; ++i) {
-        SnapshotItem* snapshot = m_rows.at(idx.row() - i);
-        foreach(TreeLeafItem* n, m_nodes[snapshot]) {
-            if (n->label() == needle) {
-                return QPair< TreeLeafItem*, SnapshotItem* >(n, 0);
-            }
+        TreeLeafItem* n = node(idx.row() - i, idx.column() / 2);
+        if (n) {
+            return QPair< TreeLeafItem*, SnapshotItem* >(n, 0);
         }
     }
     return QPair< TreeLeafItem*, SnapshotItem* >(0, 0);
@@ -358,44 +605,316 @@ void DetailedCostModel::setSelection(const QModelIndex& index)
 
 void DetailedCostModel::hideFunction(TreeLeafItem* node)
 {
-    beginResetModel();
-    QMap< SnapshotItem*, QList< TreeLeafItem* > >::iterator it = m_nodes.begin();
-    const QMap< SnapshotItem*, QList< TreeLeafItem* > >::iterator end = m_nodes.end();
-    while (it != end) {
-        QList< TreeLeafItem* >::iterator it2 = it.value().begin();
-        const QList< TreeLeafItem* >::iterator end2 = it.value().end();
-        while (it2 != end2) {
-            if ((*it2)->label() == node->label()) {
-                it2 = it.value().erase(it2);
-            } else {
-                ++it2;
+    const QString& label = node->label();
+    const int series = m_seriesIds.value(label, -1);
+    const int column = series == -1 ? m_columns.indexOf(label) : m_seriesColumns.at(series);
+    if (column == -1) {
+        return;
+    }
+    m_hidden.insert(label);
+    m_hideHistory << QStringList(label);
+
+    if (column >= shownColumns()) {
+        // no dataset of its own
+        eraseColumn(column);
+        return;
+    }
+
+    beginRemoveColumns(QModelIndex(), column * 2, column * 2 + 1);
+    updateShownCosts(series, false);
+    eraseColumn(column);
+    --m_shownCount;
+    endRemoveColumns();
+
+    // the next function gets a dataset of its own instead
+    if (m_shownCount < qMin(m_maxDatasetCount, m_columns.size())) {
+        beginInsertColumns(QModelIndex(), m_shownCount * 2, m_shownCount * 2 + 1);
+        updateShownCosts(m_columnSeries.at(m_shownCount), true);
+        ++m_shownCount;
+        endInsertColumns();
+    }
+    otherCostChanged();
+}
+
+void DetailedCostModel::hideOtherFunctions(TreeLeafItem* node)
+{
+    if (!m_singleLabel.isEmpty() && node->label() != m_singleLabel) {
+        // it must not be shown along with this function when this gets undone
+        releaseSingleFunction();
+    }
+    QStringList hidden;
+    foreach (const QString& label, m_columns) {
+        if (label != node->label()) {
+            hidden << label;
+            m_hidden.insert(label);
+        }
+    }
+    if (hidden.isEmpty()) {
+        return;
+    }
+    m_hideHistory << hidden;
+    m_hidden.remove(node->label());
+
+    setColumns(QList<QString>() << node->label());
+}
+
+void DetailedCostModel::showFunction(const QString& label)
+{
+    if (!m_hidden.contains(label)) {
+        return;
+    }
+    if (!m_singleLabel.isEmpty() && label != m_singleLabel) {
+        // the costs of the function shown by showOnlyFunction() overlap with the others
+        releaseSingleFunction();
+        m_hidden.remove(label);
+        setColumns(visibleColumns());
+        return;
+    }
+    m_hidden.remove(label);
+
+    // the place of the function among the shown ones, in the current order
+    int column = 0;
+    foreach (const QString& other, m_order) {
+        if (other == label) {
+            break;
+        } else if (!m_hidden.contains(other)) {
+            ++column;
+        }
+    }
+    const int series = m_seriesIds.value(label, -1);
+
+    if (column >= m_maxDatasetCount) {
+        // no dataset of its own
+        restoreColumn(column, label, series);
+        return;
+    }
+
+    beginInsertColumns(QModelIndex(), column * 2, column * 2 + 1);
+    restoreColumn(column, label, series);
+    updateShownCosts(series, true);
+    ++m_shownCount;
+    endInsertColumns();
+
+    // the last function loses its dataset instead
+    if (m_shownCount > m_maxDatasetCount) {
+        beginRemoveColumns(QModelIndex(), (m_shownCount - 1) * 2, m_shownCount * 2 - 1);
+        --m_shownCount;
+        updateShownCosts(m_columnSeries.at(m_shownCount), false);
+        endRemoveColumns();
+    }
+    otherCostChanged();
+}
+
+bool DetailedCostModel::undoHide()
+{
+    // skip functions that got shown again in the meantime
+    QStringList labels;
+    while (labels.isEmpty() && !m_hideHistory.isEmpty()) {
+        foreach (const QString& label, m_hideHistory.takeLast()) {
+            if (m_hidden.contains(label)) {
+                labels << label;
             }
         }
-        ++it;
     }
-    m_columns.removeOne(node->label());
-    endResetModel();
+    if (labels.isEmpty()) {
+        return false;
+    }
+    if (labels.size() == 1) {
+        showFunction(labels.first());
+        return true;
+    }
+
+    if (!labels.contains(m_singleLabel)) {
+        releaseSingleFunction();
+    }
+    foreach (const QString& label, labels) {
+        m_hidden.remove(label);
+    }
+    setColumns(visibleColumns());
+    return true;
 }
 
-void DetailedCostModel::hideOtherFunctions(TreeLeafItem* node)
+void DetailedCostModel::showAllFunctions()
 {
-    beginResetModel();
-    m_columns.clear();
-    m_columns << node->label();
-
-    QMap< SnapshotItem*, QList< TreeLeafItem* > >::iterator it = m_nodes.begin();
-    const QMap< SnapshotItem*, QList< TreeLeafItem* > >::iterator end = m_nodes.end();
-    while (it != end) {
-        QList< TreeLeafItem* >::iterator it2 = it.value().begin();
-        while (it2 != it.value().end()) {
-            if ((*it2)->label() != node->label()) {
-                it2 = it.value().erase(it2);
-            } else {
-                ++it2;
+    if (m_hidden.isEmpty()) {
+        return;
+    }
+    releaseSingleFunction();
+    m_hidden.clear();
+    m_hideHistory.clear();
+    setColumns(visibleColumns());
+}
+
+bool DetailedCostModel::hasHiddenFunctions() const
+{
+    return !m_hidden.isEmpty();
+}
+
+void DetailedCostModel::showOnlyFunction(const QString& label, const QMap<SnapshotItem*, TreeLeafItem*>& nodes)
+{
+    Q_ASSERT(!nodes.isEmpty());
+
+    // it must not be shown along with the function shown now
+    releaseSingleFunction();
+    const bool single = !m_seriesIds.contains(label);
+
+    // hidden like by hideOtherFunctions(), such that this can be undone
+    QStringList hidden;
+    foreach (const QString& other, m_columns) {
+        if (other != label) {
+            hidden << other;
+            m_hidden.insert(other);
+        }
+    }
+    if (!hidden.isEmpty()) {
+        m_hideHistory << hidden;
+    }
+    m_hidden.remove(label);
+
+    if (single) {
+        setSingleFunction(label, nodes);
+        m_order << label;
+    }
+    setColumns(QList<QString>() << label);
+}
+
+void DetailedCostModel::setSingleFunction(const QString& label, const QMap<SnapshotItem*, TreeLeafItem*>& nodes)
+{
+    // the costs are taken from @p nodes instead, the series is reused for every such function
+    const int series = m_windowSeries.size();
+    const int rows = m_rows.size();
+    if (m_peaks.size() == series) {
+        m_costs += QVector<quint64>(rows, 0);
+        m_nodes += QVector<TreeLeafItem*>(rows, 0);
+        m_peaks << QPair<TreeLeafItem*, int>(0, -1);
+    }
+    QPair<TreeLeafItem*, int> peak(0, -1);
+    for (int row = 0; row < rows; ++row) {
+        TreeLeafItem* node = nodes.value(m_rows.at(row));
+        m_nodes[series * rows + row] = node;
+        m_costs[series * rows + row] = node ? node->cost() : 0;
+        if (node) {
+            // the label has no series of its own, hence neither have its nodes
+            m_nodeIndex.insert(node, qMakePair(row, series));
+            if (!peak.first || peak.first->cost() < node->cost()) {
+                peak = qMakePair(node, row);
             }
         }
-        ++it;
     }
+    m_peaks[series] = peak;
+    m_seriesIds.insert(label, series);
+    m_singleLabel = label;
+}
 
-    endResetModel();
+void DetailedCostModel::releaseSingleFunction()
+{
+    if (m_singleLabel.isEmpty()) {
+        return;
+    }
+    QList<QString> columns = m_columns;
+    if (columns.removeOne(m_singleLabel)) {
+        setColumns(columns);
+    }
+    const int series = m_windowSeries.size();
+    const int rows = m_rows.size();
+    for (int row = 0; row < rows; ++row) {
+        if (TreeLeafItem* node = m_nodes.at(series * rows + row)) {
+            m_nodeIndex.remove(node);
+        }
+    }
+    m_seriesIds.remove(m_singleLabel);
+    m_order.removeOne(m_singleLabel);
+    m_hidden.remove(m_singleLabel);
+    m_singleLabel.clear();
+}
+
+bool DetailedCostModel::rankByTimeWindow(double t0, double t1, TimeWindowIndex::Ranking ranking)
+{
+    const QPair<int, int> range = m_windowIndex.snapshotRange(t0, t1);
+    if (range.first == -1) {
+        return false;
+    }
+    // only the functions that can get a dataset of their own need to be ranked
+    const int k = qMin(m_maxDatasetCount, m_windowSeries.size()) + m_hidden.size();
+    setColumnOrder(m_windowIndex.topK(k, range.first, range.second, ranking));
+    return true;
+}
+
+void DetailedCostModel::resetRanking()
+{
+    QVector<int> series;
+    series.reserve(m_windowSeries.size());
+    for (int i = 0; i < m_windowSeries.size(); ++i) {
+        series << i;
+    }
+    setColumnOrder(series);
+}
+
+void DetailedCostModel::setColumnOrder(const QVector<int>& series)
+{
+    QSet<QString> remaining = m_order.toSet();
+    QList<QString> order;
+    foreach (int id, series) {
+        const QString& label = m_windowSeries.at(id);
+        if (remaining.remove(label)) {
+            order << label;
+        }
+    }
+    // functions without cost in the window, in their original order
+    foreach (const QString& label, m_windowSeries) {
+        if (remaining.remove(label)) {
+            order << label;
+        }
+    }
+    // functions added by showOnlyFunction()
+    foreach (const QString& label, m_order) {
+        if (remaining.remove(label)) {
+            order << label;
+        }
+    }
+
+    if (order == m_order) {
+        return;
+    }
+
+    // the number of columns stays the same, only the functions shown in them change
+    emit layoutAboutToBeChanged();
+    const QModelIndexList before = persistentIndexList();
+    QList<QString> labels;
+    foreach (const QModelIndex& index, before) {
+        labels << (isOtherColumn(index.column()) ? QString() : m_columns.at(index.column() / 2));
+    }
+
+    m_order = order;
+    m_columns = visibleColumns();
+    updateColumns();
+
+    QModelIndexList after;
+    for (int i = 0; i < before.size(); ++i) {
+        const QModelIndex& index = before.at(i);
+        if (labels.at(i).isEmpty()) {
+            after << index;
+            continue;
+        }
+        const int column = m_columns.indexOf(labels.at(i));
+        if (column == -1 || column >= shownColumns()) {
+            after << QModelIndex();
+        } else {
+            after << this->index(index.row(), column * 2 + index.column() % 2);
+        }
+    }
+    changePersistentIndexList(before, after);
+    emit layoutChanged();
+}
+
+QList<QString> DetailedCostModel::visibleColumns() const
+{
+    // keep hidden functions hidden
+    QList<QString> columns;
+    foreach (const QString& label, m_order) {
+        if (!m_hidden.contains(label)) {
+            columns << label;
+        }
+    }
+    return columns;
 }
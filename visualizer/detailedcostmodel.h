@@ -24,8 +24,11 @@
 #include <QBrush>
 #include <QPair>
 #include <QtCore/QAbstractTableModel>
+#include <QtCore/QHash>
+#include <QtCore/QSet>
 #include <QtCore/QStringList>
 
+#include "timewindowindex.h"
 #include "visualizer_export.h"
 
 namespace Massif {
@@ -36,6 +39,10 @@ class TreeLeafItem;
 
 /**
  * A model that gives a tabular access on the costs in a massif output file.
+ *
+ * Only the most expensive functions get a dataset of their own, the cost of
+ * all others is aggregated in a final "other" dataset. Hence the stacked costs
+ * of a snapshot always add up to its heap size.
  */
 class VISUALIZER_EXPORT DetailedCostModel : public QAbstractTableModel
 {
@@ -54,7 +61,8 @@ public:
     virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
 
     /**
-     * Sets the maximum number of datasets in this model to @p count.
+     * Sets the maximum number of datasets in this model to @p count,
+     * not counting the "other" dataset.
      */
     void setMaximumDatasetCount(int count);
 
@@ -91,28 +99,141 @@ public:
     void setSelection(const QModelIndex& index);
 
     /**
-     * Hide function @p func.
+     * Hide the function of @p node, only its own dataset gets removed.
      */
     void hideFunction(TreeLeafItem* node);
 
     /**
-     * Hide all functions except for @p func.
+     * Hide all functions except for the one of @p node.
      */
     void hideOtherFunctions(TreeLeafItem* node);
 
+    /**
+     * Show the hidden function @p label again, at its place in the current order.
+     */
+    void showFunction(const QString& label);
+
+    /**
+     * Show the functions hidden by the last call to @c hideFunction() or @c hideOtherFunctions() again.
+     *
+     * @return false if no function is hidden.
+     */
+    bool undoHide();
+
+    /**
+     * Show all hidden functions again.
+     */
+    void showAllFunctions();
+
+    /**
+     * @return True if any function is hidden.
+     */
+    bool hasHiddenFunctions() const;
+
+    /**
+     * Show only the cost of @p label. Contrary to @c hideOtherFunctions() the function
+     * does not need to be shown already.
+     *
+     * If the function has no dataset of its own, its cost is taken from @p nodes per snapshot.
+     * Such a function is removed again as soon as other functions are shown, since its cost
+     * overlaps with theirs. The other functions are hidden as by @c hideOtherFunctions().
+     */
+    void showOnlyFunction(const QString& label, const QMap<SnapshotItem*, TreeLeafItem*>& nodes);
+
+    /**
+     * Reorders the shown functions by their cost between the times @p t0 and @p t1,
+     * such that the most expensive ones in that window are stacked first.
+     * Only as many functions as can get a dataset of their own are ranked,
+     * the others keep their original order.
+     *
+     * @return false if there is no detailed snapshot in the given window.
+     */
+    bool rankByTimeWindow(double t0, double t1, TimeWindowIndex::Ranking ranking);
+
+    /**
+     * Reorders the shown functions by their global peak cost again.
+     */
+    void resetRanking();
+
+    /**
+     * @return True if @p column belongs to the dataset that aggregates all remaining functions.
+     */
+    bool isOtherColumn(int column) const;
+
 private:
+    /// shows the columns in the order of the given series, followed by those not in the index
+    void setColumnOrder(const QVector<int>& series);
+    /// number of functions with a dataset of their own
+    int shownColumns() const;
+    /// cost of function @p column in m_rows[@p row]
+    quint64 cost(int row, int column) const;
+    /// node of function @p column in m_rows[@p row], or null
+    TreeLeafItem* node(int row, int column) const;
+    /// cost of all functions without a dataset of their own in m_rows[@p row]
+    unsigned long otherCost(int row) const;
+    /// recomputes the column lookups and shown costs, needed whenever the columns get reset
+    void updateColumns();
+    /// recomputes the lookups between columns and series
+    void updateColumnSeries();
+    /**
+     * Shows @p columns instead of the current ones. The columns kept must be in the same order,
+     * datasets are removed and inserted per contiguous run.
+     */
+    void setColumns(const QList<QString>& columns);
+    /// removes @p column from m_columns, without any notification
+    void eraseColumn(int column);
+    /// inserts @p label with @p series at @p column into m_columns, without any notification
+    void restoreColumn(int column, const QString& label, int series);
+    /// adds the costs of @p series to the shown costs, or subtracts them if not @p shown
+    void updateShownCosts(int series, bool shown);
+    /// notifies about the changed costs in the dataset of the other functions
+    void otherCostChanged();
+    /// fills the series reserved for showOnlyFunction() with the costs of @p nodes
+    void setSingleFunction(const QString& label, const QMap<SnapshotItem*, TreeLeafItem*>& nodes);
+    /// removes the function added by showOnlyFunction(), if any
+    void releaseSingleFunction();
+    /// @return The functions in m_order that are not hidden
+    QList<QString> visibleColumns() const;
+
     const FileData* m_data;
-    // columns => label
+    // columns => label, not hidden
     QList<QString> m_columns;
+    // all functions in the current order, including hidden ones
+    QList<QString> m_order;
+    // labels of the hidden functions
+    QSet<QString> m_hidden;
+    // labels hidden by each call to hideFunction() or hideOtherFunctions()
+    QList<QStringList> m_hideHistory;
+    // number of columns with a dataset of their own
+    int m_shownCount;
     // only to sort snapshots by number
     QList<SnapshotItem*> m_rows;
-    // snapshot item => cost intensive nodes
-    QMap<SnapshotItem*, QList<TreeLeafItem*> > m_nodes;
-    // peaks: Label => TreeLeafItem,Snapshot
-    QMap<QString, QPair<TreeLeafItem*,SnapshotItem*> > m_peaks;
     // selected item
     QModelIndex m_selection;
     int m_maxDatasetCount;
+    // time of the zero row, before the heap gets significant
+    double m_firstTime;
+    // costs of the columns found in setSource, in their original order
+    TimeWindowIndex m_windowIndex;
+    QList<QString> m_windowSeries;
+    // series x rows, in the order of m_windowSeries followed by the one reserved for showOnlyFunction()
+    QVector<quint64> m_costs;
+    // series x rows, the cost intensive node of a series in a row, or null
+    QVector<TreeLeafItem*> m_nodes;
+    // series => peak node, row
+    QVector< QPair<TreeLeafItem*, int> > m_peaks;
+    // label => series
+    QHash<QString, int> m_seriesIds;
+    // cost intensive node => row, series
+    QHash<const TreeLeafItem*, QPair<int, int> > m_nodeIndex;
+    // column => series, or -1 if the label has no costs
+    QVector<int> m_columnSeries;
+    // series => column, or -1 if it is hidden
+    QVector<int> m_seriesColumns;
+    // rows => sum of the costs of the columns with a dataset of their own
+    QVector<quint64> m_shownCosts;
+    // the function shown by showOnlyFunction() that has no series of its own otherwise
+    QString m_singleLabel;
 };
 
 }
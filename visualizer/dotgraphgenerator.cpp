@@ -27,42 +27,155 @@
 #include "util.h"
 
 #include <QTextStream>
-#include <QFile>
 #include <QUuid>
 #include <QColor>
+#include <QtCore/QMutexLocker>
 
 #include <KLocalizedString>
-#include <KTemporaryFile>
 
 #include <KDebug>
 
 using namespace Massif;
 
-DotGraphGenerator::DotGraphGenerator(const SnapshotItem* snapshot, const QString& timeUnit, QObject* parent)
-    : QThread(parent), m_snapshot(snapshot), m_node(snapshot->heapTree()), m_canceled(false), m_timeUnit(timeUnit)
+DotGraphGenerator::Job::Job()
+    : snapshot(0), node(0)
 {
-    m_file.open();
 }
 
-DotGraphGenerator::DotGraphGenerator(const TreeLeafItem* node, const QString& timeUnit, QObject* parent)
-    : QThread(parent), m_snapshot(0), m_node(node), m_canceled(false), m_timeUnit(timeUnit)
+DotGraphGenerator::DotGraphGenerator(QObject* parent)
+    : QThread(parent), m_hasPending(false), m_stopped(false), m_canceled(0)
+    , m_debounceInterval(100), m_hasGraph(false), m_maxCost(0)
 {
-    m_file.open();
 }
 
 DotGraphGenerator::~DotGraphGenerator()
 {
-    kDebug() << "closing generator, file will get removed";
+    stop();
+}
+
+void DotGraphGenerator::setDebounceInterval(int msecs)
+{
+    QMutexLocker lock(&m_mutex);
+    m_debounceInterval = msecs;
+}
+
+void DotGraphGenerator::requestGraph(const FileDataHandle& data, const SnapshotItem* snapshot, const QString& timeUnit)
+{
+    Job job;
+    job.data = data;
+    job.snapshot = snapshot;
+    job.node = snapshot->heapTree();
+    job.timeUnit = timeUnit;
+    addRequest(job);
+}
+
+void DotGraphGenerator::requestGraph(const FileDataHandle& data, const TreeLeafItem* node, const QString& timeUnit)
+{
+    Job job;
+    job.data = data;
+    job.node = node;
+    job.timeUnit = timeUnit;
+    addRequest(job);
+}
+
+void DotGraphGenerator::addRequest(const Job& job)
+{
+    kDebug() << "new dot graph requested" << job.snapshot << job.node;
+    // replace the pending job outside the lock, the data might get deleted with it
+    Job replaced;
+    QMutexLocker lock(&m_mutex);
+    replaced = m_pending;
+    m_pending = job;
+    m_hasPending = true;
+    m_canceled = 1;
+    m_hasGraph = false;
+    m_graph.clear();
+    m_wakeUp.wakeAll();
 }
 
 void DotGraphGenerator::cancel()
 {
-    m_canceled = true;
+    Job replaced;
+    QMutexLocker lock(&m_mutex);
+    replaced = m_pending;
+    m_pending = Job();
+    m_hasPending = false;
+    m_canceled = 1;
+    m_hasGraph = false;
+    m_graph.clear();
+    m_wakeUp.wakeAll();
+}
+
+void DotGraphGenerator::stop()
+{
+    cancel();
+    {
+        QMutexLocker lock(&m_mutex);
+        m_stopped = true;
+        m_wakeUp.wakeAll();
+    }
+    wait();
+}
+
+void DotGraphGenerator::run()
+{
+    QMutexLocker lock(&m_mutex);
+    forever {
+        while (!m_stopped && !m_hasPending) {
+            m_wakeUp.wait(&m_mutex);
+        }
+        if (m_stopped) {
+            return;
+        }
+        if (m_debounceInterval > 0 && m_wakeUp.wait(&m_mutex, m_debounceInterval)) {
+            // another request came in quickly, wait for that one to settle
+            continue;
+        }
+
+        m_canceled = 0;
+        Job job = m_pending;
+        m_pending = Job();
+        m_hasPending = false;
+        lock.unlock();
+
+        QByteArray graph;
+        QTextStream out(&graph);
+        const bool done = generate(job, out);
+        out.flush();
+        // don't keep the data alive until the next request
+        job = Job();
+
+        lock.relock();
+        const bool ready = done && !m_canceled;
+        if (ready) {
+            m_graph = graph;
+            m_graphId = m_costlyGraphvizId;
+            m_hasGraph = true;
+        }
+        if (ready) {
+            lock.unlock();
+            emit graphReady();
+            lock.relock();
+        }
+    }
+}
+
+bool DotGraphGenerator::takeGraph(QByteArray* graph, QString* costlyGraphvizId)
+{
+    QMutexLocker lock(&m_mutex);
+    if (!m_hasGraph) {
+        return false;
+    }
+    *graph = m_graph;
+    *costlyGraphvizId = m_graphId;
+    m_graph.clear();
+    m_hasGraph = false;
+    return true;
 }
 
 QString getLabel(const TreeLeafItem* node)
 {
-    QString label = prettyLabel(node->label());
+    QString label = prettyLabel(node);
     const int lineWidth = 40;
     if (label.length() > lineWidth) {
         int lastPos = 0;
@@ -81,6 +194,9 @@ QString getLabel(const TreeLeafItem* node)
             }
         }
     }
+    if (node->recursionDepth() > 1) {
+        return i18n("%1\\ncost: %2\\nrecursion depth: %3", label, prettyCost(node->cost()), node->recursionDepth());
+    }
     return i18n("%1\\ncost: %2", label, prettyCost(node->cost()));
 }
 
@@ -91,54 +207,47 @@ QString getColor(unsigned long cost, unsigned long maxCost)
 //     return QColor::fromHsv(120 - ratio * 120, 255, 255).name();
 }
 
-void DotGraphGenerator::run()
+bool DotGraphGenerator::generate(const Job& job, QTextStream& out)
 {
-    if (!m_file.isOpen()) {
-        kWarning() << "could not create temp file for writing Dot-graph";
-        return;
-    }
-
     if (m_canceled) {
-        return;
+        return false;
     }
 
-    kDebug() << "creating new dot file in" << m_file.fileName();
-    QTextStream out(&m_file);
-
+    m_costlyGraphvizId.clear();
     out << "digraph callgraph {\n"
            "rankdir = BT;\n";
     if (m_canceled) {
-        return;
+        return false;
     }
     const QString id = QUuid::createUuid().toString();
     QString label;
-    if (m_snapshot) {
+    if (job.snapshot) {
         label = i18n("snapshot #%1 (taken at %2%4)\\nheap cost: %3",
-                                m_snapshot->number(), m_snapshot->time(), prettyCost(m_snapshot->memHeap()),
-                                m_timeUnit);
+                                job.snapshot->number(), job.snapshot->time(), prettyCost(job.snapshot->memHeap()),
+                                job.timeUnit);
 
-        m_maxCost = m_snapshot->memHeap();
-        if (m_node && m_node->children().isEmpty()) {
+        m_maxCost = job.snapshot->memHeap();
+        if (job.node && job.node->children().isEmpty()) {
             m_costlyGraphvizId = id;
         }
-    } else if (m_node) {
+    } else if (job.node) {
         m_costlyGraphvizId = id;
-        const TreeLeafItem* topMost = m_node;
+        const TreeLeafItem* topMost = job.node;
         while (topMost->parent()) {
             topMost = topMost->parent();
         }
         m_maxCost = topMost->cost();
-        label = getLabel(m_node);
+        label = getLabel(job.node);
     }
     out << '"' << id << "\" [shape=box,label=\"" << label << "\",fillcolor=white];\n";
 
-    if (m_node) {
-        foreach (TreeLeafItem* child, m_node->children()) {
+    if (job.node) {
+        foreach (TreeLeafItem* child, job.node->children()) {
             nodeToDot(child, out, id);
         }
     }
     out << "}\n";
-    m_file.flush();
+    return !m_canceled;
 }
 
 void DotGraphGenerator::nodeToDot(TreeLeafItem* node, QTextStream& out, const QString& parent)
@@ -160,15 +269,19 @@ void DotGraphGenerator::nodeToDot(TreeLeafItem* node, QTextStream& out, const QS
     const QString color = getColor(node->cost(), m_maxCost);
     // group nodes with same cost but different label
     bool wasGrouped = false;
-    while (node && node->children().count() == 1 && node->children().first()->cost() == node->cost()) {
+    const TreeLeafItem* end = node->chainEnd();
+    QString lastLabel = prettyLabel(node);
+    while (node != end) {
         if (m_canceled) {
             return;
         }
         node = node->children().first();
 
-        if (prettyLabel(node->label()) != prettyLabel(node->parent()->label())) {
-            label += " | " + prettyLabel(node->label());
+        const QString nodeLabel = prettyLabel(node);
+        if (nodeLabel != lastLabel) {
+            label += " | " + nodeLabel;
             wasGrouped = true;
+            lastLabel = nodeLabel;
         }
     }
     QString shape;
@@ -195,13 +308,3 @@ void DotGraphGenerator::nodeToDot(TreeLeafItem* node, QTextStream& out, const QS
         nodeToDot(child, out, id);
     }
 }
-
-QString DotGraphGenerator::outputFile() const
-{
-    return m_file.fileName();
-}
-
-QString DotGraphGenerator::mostCostIntensiveGraphvizId() const
-{
-    return m_costlyGraphvizId;
-}
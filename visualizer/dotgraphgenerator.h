@@ -23,54 +23,115 @@
 
 #include <QTextStream>
 #include <QThread>
-#include <KTemporaryFile>
+#include <QtCore/QAtomicInt>
+#include <QtCore/QByteArray>
+#include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
 
 #include "visualizer_export.h"
 
+#include "massifdata/filedata.h"
+
 namespace Massif {
 
 class SnapshotItem;
 class TreeLeafItem;
 
+/**
+ * Generates Dot graphs of heap trees in a persistent worker thread.
+ *
+ * Only the latest request is handled: requests that follow each other within
+ * the debounce interval are coalesced, and a newer request cancels the graph
+ * that is currently generated.
+ */
 class VISUALIZER_EXPORT DotGraphGenerator : public QThread
 {
     Q_OBJECT
 public:
+    explicit DotGraphGenerator(QObject* parent = 0);
     /**
-     * Generates a Dot graph file representing @p snapshot
-     * and writes it to a temporary file.
+     * Stops the worker thread.
      */
-    DotGraphGenerator(const SnapshotItem* snapshot, const QString& timeUnit, QObject* parent = 0);
+    ~DotGraphGenerator();
+
     /**
-     * Generates a Dot graph file representing @p node
-     * and writes it to a temporary file.
+     * Coalesces requests that arrive within @p msecs milliseconds of each other, 100 by default.
      */
-    DotGraphGenerator(const TreeLeafItem* node, const QString& timeUnit, QObject* parent = 0);
-    ~DotGraphGenerator();
+    void setDebounceInterval(int msecs);
+
+    /**
+     * Requests a Dot graph representing @p snapshot, replacing any earlier request.
+     *
+     * @p data owns the snapshot and is kept alive while the graph is generated.
+     */
+    void requestGraph(const FileDataHandle& data, const SnapshotItem* snapshot, const QString& timeUnit);
+    /**
+     * Requests a Dot graph representing @p node, replacing any earlier request.
+     *
+     * @p data owns the node and is kept alive while the graph is generated.
+     */
+    void requestGraph(const FileDataHandle& data, const TreeLeafItem* node, const QString& timeUnit);
 
     /**
-     * Stops generating the Dot graph file and deletes the temp file.
+     * Drops the pending request and stops generating the current graph.
+     * Does not wait for the worker, which releases its data handle once done.
      */
     void cancel();
 
+    /**
+     * Cancels all requests and stops the worker thread.
+     */
+    void stop();
+
     virtual void run();
+
     /**
-     * @return A path to the generated Dot graph file. Path might be empty if errors occurred.
+     * Takes the graph of the latest request, if it was generated completely.
+     *
+     * @p graph is set to the graph in the Dot format, @p costlyGraphvizId to
+     * the GraphViz node ID for the most cost-intensive tree leaf item.
+     *
+     * @return False if no new graph is available.
      */
-    QString outputFile() const;
+    bool takeGraph(QByteArray* graph, QString* costlyGraphvizId);
+
+signals:
     /**
-     * @return The GraphViz node ID for the most cost-intensive tree leaf item.
+     * Emitted when the graph of the latest request can be taken.
      */
-    QString mostCostIntensiveGraphvizId() const;
+    void graphReady();
 
 private:
+    struct Job
+    {
+        Job();
+
+        FileDataHandle data;
+        const SnapshotItem* snapshot;
+        const TreeLeafItem* node;
+        QString timeUnit;
+    };
+
+    void addRequest(const Job& job);
+    /// @return False if the job got canceled
+    bool generate(const Job& job, QTextStream& out);
     void nodeToDot(TreeLeafItem* node, QTextStream& out, const QString& parent);
-    const SnapshotItem* m_snapshot;
-    const TreeLeafItem* m_node;
-    KTemporaryFile m_file;
-    bool m_canceled;
+
+    mutable QMutex m_mutex;
+    // signaled on new requests, cancellation and stop
+    QWaitCondition m_wakeUp;
+    Job m_pending;
+    bool m_hasPending;
+    bool m_stopped;
+    // set under the lock, but polled by generate() without it
+    QAtomicInt m_canceled;
+    int m_debounceInterval;
+    QByteArray m_graph;
+    QString m_graphId;
+    bool m_hasGraph;
+
+    // only used by the worker thread
     unsigned long m_maxCost;
-    QString m_timeUnit;
     QString m_costlyGraphvizId;
 };
 
@@ -20,39 +20,145 @@
 
 #include "filtereddatatreemodel.h"
 #include "datatreemodel.h"
+#include "datatreesearch.h"
+#include "labelsearchindex.h"
+
+#include "massifdata/treeleafitem.h"
 
 #include <QDebug>
 
 using namespace Massif;
 
 FilteredDataTreeModel::FilteredDataTreeModel(DataTreeModel* parent)
-    : QSortFilterProxyModel(parent)
+    : QSortFilterProxyModel(parent), m_search(0), m_stale(false)
 {
     setDynamicSortFilter(true);
     setSourceModel(parent);
+
+    connect(parent, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)),
+            this, SLOT(sourceRowsAboutToBeRemoved(QModelIndex)));
+    connect(parent, SIGNAL(rowsInserted(QModelIndex,int,int)),
+            this, SLOT(sourceRowsInserted(QModelIndex)));
+}
+
+FilteredDataTreeModel::~FilteredDataTreeModel()
+{
+    stopSearch();
+    // stopped searches delete themselves once done, but not after we are gone
+    foreach (DataTreeSearch* search, findChildren<DataTreeSearch*>()) {
+        search->wait();
+    }
 }
 
 void FilteredDataTreeModel::setFilter(const QString& needle)
 {
+    if (needle == m_needle) {
+        return;
+    }
     m_needle = needle;
-    invalidate();
+    startSearch();
+}
+
+void FilteredDataTreeModel::startSearch()
+{
+    stopSearch();
+
+    const FileData* data = static_cast<DataTreeModel*>(sourceModel())->source();
+    if (m_needle.isEmpty() || !data) {
+        m_accepted.clear();
+        m_stale = false;
+        m_filterNeedle = m_needle;
+        invalidateFilter();
+        return;
+    }
+
+    if (!m_index) {
+        m_index = LabelSearchIndexHandle(new LabelSearchIndex(data));
+    }
+    // typing more characters only removes matches, no need to look at all labels again
+    const bool refine = !m_lastNeedle.isEmpty() && m_needle.contains(m_lastNeedle, Qt::CaseInsensitive);
+    m_search = new DataTreeSearch(m_index, m_needle, refine ? &m_lastLabels : 0, this);
+    connect(m_search, SIGNAL(resultsReady()), this, SLOT(searchResultsReady()));
+    m_stale = true;
+    m_search->start();
+}
+
+void FilteredDataTreeModel::stopSearch()
+{
+    if (!m_search) {
+        return;
+    }
+    // don't block while the search finishes, it holds on to the index until then
+    disconnect(m_search, 0, this, 0);
+    m_search->cancel();
+    connect(m_search, SIGNAL(finished()), m_search, SLOT(deleteLater()));
+    if (m_search->isFinished()) {
+        m_search->deleteLater();
+    }
+    m_search = 0;
+}
+
+void FilteredDataTreeModel::searchResultsReady()
+{
+    // might be queued for a search that was stopped already
+    if (!m_search || sender() != m_search) {
+        return;
+    }
+    const bool done = m_search->isDone();
+    if (m_stale) {
+        m_accepted = m_search->takeResults();
+        m_filterNeedle = m_search->needle();
+        m_stale = false;
+    } else {
+        m_accepted.unite(m_search->takeResults());
+    }
+    if (done) {
+        m_lastNeedle = m_search->needle();
+        m_lastLabels = m_search->labels();
+        stopSearch();
+    }
+    invalidateFilter();
+}
+
+void FilteredDataTreeModel::resetIndex()
+{
+    stopSearch();
+    m_accepted.clear();
+    m_stale = false;
+    m_lastNeedle.clear();
+    m_lastLabels.clear();
+    m_index.clear();
+}
+
+void FilteredDataTreeModel::sourceRowsAboutToBeRemoved(const QModelIndex& parent)
+{
+    // the snapshots are only removed when the source data changes
+    if (!parent.isValid()) {
+        resetIndex();
+    }
+}
+
+void FilteredDataTreeModel::sourceRowsInserted(const QModelIndex& parent)
+{
+    if (!parent.isValid()) {
+        resetIndex();
+        startSearch();
+    }
 }
 
 bool FilteredDataTreeModel::filterAcceptsRow(int source_row, const QModelIndex& source_parent) const
 {
+    if (m_filterNeedle.isEmpty()) {
+        return true;
+    }
     const QModelIndex& dataIdx = sourceModel()->index(source_row, 0, source_parent);
     Q_ASSERT(dataIdx.isValid());
-    if (sourceModel()->data(dataIdx).toString().contains(m_needle, Qt::CaseInsensitive)) {
+    const TreeLeafItem* node = static_cast<TreeLeafItem*>(dataIdx.internalPointer());
+    if (node && m_accepted.contains(node)) {
         return true;
-    } else {
-        const int rows = sourceModel()->rowCount(dataIdx);
-        for ( int i = 0; i < rows; ++i ) {
-            if ( filterAcceptsRow(i, dataIdx) ) {
-                return true;
-            }
-        }
-        return false;
     }
+    // snapshots are matched by their text, heap tree items by their label
+    return !source_parent.isValid() && sourceModel()->data(dataIdx).toString().contains(m_filterNeedle, Qt::CaseInsensitive);
 }
 
 bool FilteredDataTreeModel::filterAcceptsColumn(int, const QModelIndex&) const
@@ -23,14 +23,28 @@
 
 #include <QtGui/QSortFilterProxyModel>
 
+#include <QtCore/QSet>
+#include <QtCore/QVector>
+
+#include "labelsearchindex.h"
+
 #include "visualizer_export.h"
 
 namespace Massif {
 
 class DataTreeModel;
+class DataTreeSearch;
+class TreeLeafItem;
 
 /**
  * Filter class for DataTreeModel
+ *
+ * The heap tree items are searched in a background thread, matches
+ * show up in batches while the search is still running. The matches of
+ * the previous search stay visible until the first batch replaces them.
+ *
+ * Only the function names and addresses of the items are searched, not their
+ * costs as shown in the tree, see LabelSearchIndex.
  */
 class VISUALIZER_EXPORT FilteredDataTreeModel : public QSortFilterProxyModel
 {
@@ -38,12 +52,18 @@ class VISUALIZER_EXPORT FilteredDataTreeModel : public QSortFilterProxyModel
 
 public:
     explicit FilteredDataTreeModel(DataTreeModel* parent);
+    virtual ~FilteredDataTreeModel();
 
 public slots:
     void setFilter(const QString& needle);
 
+private slots:
+    void searchResultsReady();
+    void sourceRowsAboutToBeRemoved(const QModelIndex& parent);
+    void sourceRowsInserted(const QModelIndex& parent);
+
 protected:
-    /// true for any branch that has an item in it that matches m_needle
+    /// true for any branch that has an item in it that matches m_filterNeedle
     virtual bool filterAcceptsRow(int source_row, const QModelIndex& source_parent) const;
     /// always true
     virtual bool filterAcceptsColumn(int source_column, const QModelIndex& source_parent) const;
@@ -52,8 +72,26 @@ private:
     /// we don't want that
     virtual void setSourceModel(QAbstractItemModel* sourceModel);
 
+    /// starts searching for m_needle, refining the last search if possible
+    void startSearch();
+    /// stops the running search, if any, without waiting for it
+    void stopSearch();
+    /// drops the index and the last search, since the source data changed
+    void resetIndex();
+
     /// search string that should be contained in the data (case insensitively)
     QString m_needle;
+    /// search string of the matches that are shown
+    QString m_filterNeedle;
+    LabelSearchIndexHandle m_index;
+    DataTreeSearch* m_search;
+    /// the matching items found so far, including their ancestors
+    QSet<const TreeLeafItem*> m_accepted;
+    /// true while m_accepted still holds the matches of the previous search
+    bool m_stale;
+    /// the last search that finished and its matching labels
+    QString m_lastNeedle;
+    QVector<int> m_lastLabels;
 };
 
 }
@@ -0,0 +1,112 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "flamegraphlayouter.h"
+
+#include "massifdata/treeleafitem.h"
+
+#include <QtCore/QList>
+
+using namespace Massif;
+
+FlameGraphFrame::FlameGraphFrame()
+    : node(0), depth(0), recursive(false)
+{
+}
+
+FlameGraphFrame::FlameGraphFrame(const QRectF& rect, TreeLeafItem* node, int depth, bool recursive)
+    : rect(rect), node(node), depth(depth), recursive(recursive)
+{
+}
+
+FlameGraphLayouter::FlameGraphLayouter()
+    : m_height(0), m_rowHeight(0)
+{
+}
+
+FlameGraphLayouter::~FlameGraphLayouter()
+{
+}
+
+void FlameGraphLayouter::layout(TreeLeafItem* zoom, qreal width, qreal height, qreal rowHeight)
+{
+    m_frames.clear();
+    m_height = height;
+    m_rowHeight = rowHeight;
+    if (!zoom || !zoom->cost() || rowHeight <= 0) {
+        return;
+    }
+
+    // the parents of the zoomed frame span the whole width, without their other children
+    QList<TreeLeafItem*> parents;
+    for (TreeLeafItem* parent = zoom->parent(); parent; parent = parent->parent()) {
+        parents.prepend(parent);
+    }
+    int depth = 0;
+    foreach (TreeLeafItem* parent, parents) {
+        layoutFrame(parent, depth++, 0, width, false);
+    }
+
+    layoutFrame(zoom, depth, 0, width, true);
+}
+
+void FlameGraphLayouter::layoutFrame(TreeLeafItem* node, int depth, qreal x, qreal width, bool recursive)
+{
+    // leave a gap of one pixel between the rows
+    const QRectF frame(x, depth * m_rowHeight, width, m_rowHeight - 1);
+    if (frame.top() > m_height) {
+        return;
+    }
+    m_frames << FlameGraphFrame(frame, node, depth, recursive);
+
+    if (!recursive || !node->cost()) {
+        return;
+    }
+
+    const qreal scale = width / node->cost();
+    foreach (TreeLeafItem* child, node->children()) {
+        const qreal childWidth = child->cost() * scale;
+        // frames narrower than a pixel, and thus all their children, are not visible
+        if (childWidth >= 1) {
+            layoutFrame(child, depth + 1, x, childWidth, true);
+        }
+        x += childWidth;
+    }
+}
+
+void FlameGraphLayouter::clear()
+{
+    m_frames.clear();
+}
+
+QVector<FlameGraphFrame> FlameGraphLayouter::frames() const
+{
+    return m_frames;
+}
+
+const FlameGraphFrame* FlameGraphLayouter::frameAt(const QPointF& pos) const
+{
+    for (int i = m_frames.size() - 1; i >= 0; --i) {
+        if (m_frames.at(i).rect.contains(pos)) {
+            return &m_frames.at(i);
+        }
+    }
+    return 0;
+}
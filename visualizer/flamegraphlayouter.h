@@ -0,0 +1,94 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MASSIF_FLAMEGRAPHLAYOUTER_H
+#define MASSIF_FLAMEGRAPHLAYOUTER_H
+
+#include <QtCore/QRectF>
+#include <QtCore/QVector>
+
+#include "visualizer_export.h"
+
+namespace Massif {
+
+class TreeLeafItem;
+
+/**
+ * A frame in an icicle graph.
+ */
+struct VISUALIZER_EXPORT FlameGraphFrame
+{
+    FlameGraphFrame();
+    FlameGraphFrame(const QRectF& rect, TreeLeafItem* node, int depth, bool recursive);
+
+    QRectF rect;
+    TreeLeafItem* node;
+    /// 0 for the root of the heap tree
+    int depth;
+    /// false for the parents of the zoomed node, which are shown without their other children
+    bool recursive;
+};
+
+/**
+ * Lays out a heap tree as icicle graph: the zoomed node spans the whole width,
+ * children are placed below their parent with a width that is proportional to
+ * their cost. The parents of the zoomed node are stacked above it.
+ *
+ * Frames narrower than a pixel or below the visible area are culled together
+ * with all their children, so the number of frames is bounded by the area.
+ */
+class VISUALIZER_EXPORT FlameGraphLayouter
+{
+public:
+    FlameGraphLayouter();
+    ~FlameGraphLayouter();
+
+    /**
+     * Lays out @p zoom in an area of @p width times @p height, one row of
+     * @p rowHeight per level of the tree.
+     */
+    void layout(TreeLeafItem* zoom, qreal width, qreal height, qreal rowHeight);
+
+    /**
+     * Removes all frames.
+     */
+    void clear();
+
+    /**
+     * @return All frames of the last layout, every frame comes before its children.
+     */
+    QVector<FlameGraphFrame> frames() const;
+
+    /**
+     * @return The frame at @p pos or zero if there is none.
+     */
+    const FlameGraphFrame* frameAt(const QPointF& pos) const;
+
+private:
+    void layoutFrame(TreeLeafItem* node, int depth, qreal x, qreal width, bool recursive);
+
+    qreal m_height;
+    qreal m_rowHeight;
+    QVector<FlameGraphFrame> m_frames;
+};
+
+}
+
+#endif // MASSIF_FLAMEGRAPHLAYOUTER_H
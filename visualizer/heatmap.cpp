@@ -0,0 +1,174 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "heatmap.h"
+
+#include "timeseriesindex.h"
+
+#include "massifdata/costkernels.h"
+
+#include <QtCore/qalgorithms.h>
+#include <QtGui/QColor>
+
+#include <cmath>
+
+using namespace Massif;
+
+namespace {
+
+struct RowLessThan
+{
+    RowLessThan(const QVector<double>& keys)
+        : keys(keys)
+    {
+    }
+
+    bool operator()(int l, int r) const
+    {
+        // descending
+        return keys.at(l) > keys.at(r);
+    }
+
+    const QVector<double>& keys;
+};
+
+const int colorCount = 256;
+
+QVector<QRgb> colorTable()
+{
+    // from dark blue for cheap to bright red for expensive cells
+    QVector<QRgb> colors(colorCount);
+    for (int i = 0; i < colorCount; ++i) {
+        colors[i] = QColor::fromHsv(240 - i * 240 / (colorCount - 1), 255, 128 + i / 2).rgb();
+    }
+    return colors;
+}
+
+}
+
+HeatMap::HeatMap()
+    : m_index(0), m_maxCost(0)
+{
+}
+
+HeatMap::~HeatMap()
+{
+}
+
+void HeatMap::setSource(const TimeSeriesIndex* index, const QVector<Trend>& trends, RowOrder order)
+{
+    m_index = index;
+    m_rows.clear();
+    m_labelRows.clear();
+    m_maxCost = 0;
+    m_image = QImage();
+    if (!index) {
+        return;
+    }
+
+    const int labels = index->labelCount();
+    const int snapshots = index->snapshotCount();
+
+    QVector<double> keys(labels, 0);
+    if (order == ByGrowth) {
+        foreach (const Trend& trend, trends) {
+            keys[trend.label] = trend.score;
+        }
+    }
+    for (int label = 0; label < labels; ++label) {
+        const quint64 peak = maxCost(index->costs(label), snapshots);
+        m_maxCost = qMax(m_maxCost, peak);
+        if (order == ByPeak) {
+            keys[label] = peak;
+        }
+    }
+
+    m_rows.resize(labels);
+    for (int label = 0; label < labels; ++label) {
+        m_rows[label] = label;
+    }
+    qStableSort(m_rows.begin(), m_rows.end(), RowLessThan(keys));
+
+    m_labelRows.resize(labels);
+    for (int row = 0; row < labels; ++row) {
+        m_labelRows[m_rows.at(row)] = row;
+    }
+
+    render();
+}
+
+void HeatMap::render()
+{
+    const int snapshots = m_index->snapshotCount();
+    if (m_rows.isEmpty() || !snapshots) {
+        return;
+    }
+
+    static const QVector<QRgb> colors = colorTable();
+    const double scale = m_maxCost ? (colorCount - 1) / std::log(double(m_maxCost) + 1) : 0;
+
+    m_image = QImage(snapshots, m_rows.size(), QImage::Format_ARGB32);
+    for (int row = 0; row < m_rows.size(); ++row) {
+        const quint64* costs = m_index->costs(m_rows.at(row));
+        QRgb* line = reinterpret_cast<QRgb*>(m_image.scanLine(row));
+        for (int column = 0; column < snapshots; ++column) {
+            const quint64 cost = costs[column];
+            line[column] = cost ? colors.at(qMin(colorCount - 1, int(std::log(double(cost) + 1) * scale))) : 0;
+        }
+    }
+}
+
+const TimeSeriesIndex* HeatMap::seriesIndex() const
+{
+    return m_index;
+}
+
+int HeatMap::rowCount() const
+{
+    return m_rows.size();
+}
+
+int HeatMap::columnCount() const
+{
+    return m_index ? m_index->snapshotCount() : 0;
+}
+
+int HeatMap::labelForRow(int row) const
+{
+    return m_rows.at(row);
+}
+
+int HeatMap::rowForLabel(int label) const
+{
+    if (label < 0 || label >= m_labelRows.size()) {
+        return -1;
+    }
+    return m_labelRows.at(label);
+}
+
+quint64 HeatMap::cost(int row, int column) const
+{
+    return m_index->cost(m_rows.at(row), column);
+}
+
+QImage HeatMap::image() const
+{
+    return m_image;
+}
@@ -0,0 +1,107 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MASSIF_HEATMAP_H
+#define MASSIF_HEATMAP_H
+
+#include <QtCore/QVector>
+#include <QtGui/QImage>
+
+#include "trendanalyzer.h"
+#include "visualizer_export.h"
+
+namespace Massif {
+
+class TimeSeriesIndex;
+
+/**
+ * Renders the costs of all call sites over all detailed snapshots into an
+ * image, one pixel per call site and snapshot.
+ *
+ * Rows are call sites, columns are detailed snapshots. The cost of every
+ * cell can be looked up in constant time, e.g. for tooltips.
+ */
+class VISUALIZER_EXPORT HeatMap
+{
+public:
+    enum RowOrder {
+        /// most expensive call sites at their peak first
+        ByPeak,
+        /// call sites with the highest growth score first
+        ByGrowth
+    };
+
+    HeatMap();
+    ~HeatMap();
+
+    /**
+     * Set the call sites in @p index, ordered according to @p order which
+     * requires the @p trends for @c ByGrowth. The index must outlive this map.
+     */
+    void setSource(const TimeSeriesIndex* index, const QVector<Trend>& trends, RowOrder order);
+
+    /**
+     * @return The index the rows refer to or zero if none is set.
+     */
+    const TimeSeriesIndex* seriesIndex() const;
+
+    /**
+     * @return Number of call sites.
+     */
+    int rowCount() const;
+    /**
+     * @return Number of detailed snapshots.
+     */
+    int columnCount() const;
+
+    /**
+     * @return The call site id in @c seriesIndex() shown in @p row.
+     */
+    int labelForRow(int row) const;
+    /**
+     * @return The row of call site @p label or -1 if it is not shown.
+     */
+    int rowForLabel(int label) const;
+    /**
+     * @return The cost of the call site in @p row in detailed snapshot @p column.
+     */
+    quint64 cost(int row, int column) const;
+
+    /**
+     * @return The rendered heat map, one pixel per cell.
+     *         Cells without any cost are transparent.
+     */
+    QImage image() const;
+
+private:
+    void render();
+
+    const TimeSeriesIndex* m_index;
+    // row => label id
+    QVector<int> m_rows;
+    // label id => row
+    QVector<int> m_labelRows;
+    quint64 m_maxCost;
+    QImage m_image;
+};
+
+}
+
+#endif // MASSIF_HEATMAP_H
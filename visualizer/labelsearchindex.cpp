@@ -0,0 +1,219 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "labelsearchindex.h"
+
+#include "massifdata/filedata.h"
+#include "massifdata/snapshotitem.h"
+#include "massifdata/symbol.h"
+#include "massifdata/treeleafitem.h"
+
+#include <QtCore/QPair>
+#include <QtCore/qalgorithms.h>
+
+using namespace Massif;
+
+namespace {
+
+quint64 trigram(const QChar* c)
+{
+    return (quint64(c[0].unicode()) << 32) | (quint64(c[1].unicode()) << 16) | c[2].unicode();
+}
+
+bool sortBySize(const QVector<int>* l, const QVector<int>* r)
+{
+    return l->size() < r->size();
+}
+
+/// keeps the ids in @p ids that are also in @p other, both need to be sorted
+void intersect(QVector<int>& ids, const QVector<int>& other)
+{
+    int kept = 0;
+    int j = 0;
+    for (int i = 0; i < ids.size() && j < other.size(); ++i) {
+        while (j < other.size() && other.at(j) < ids.at(i)) {
+            ++j;
+        }
+        if (j < other.size() && other.at(j) == ids.at(i)) {
+            ids[kept++] = ids.at(i);
+        }
+    }
+    ids.resize(kept);
+}
+
+}
+
+LabelSearchIndex::LabelSearchIndex(const FileData* data)
+    : m_snapshots(data->snapshots())
+{
+    m_snapshotOffsets.reserve(m_snapshots.size() + 1);
+    m_snapshotOffsets << 0;
+}
+
+LabelSearchIndex::~LabelSearchIndex()
+{
+}
+
+int LabelSearchIndex::snapshotCount() const
+{
+    return m_snapshots.size();
+}
+
+int LabelSearchIndex::indexedSnapshotCount() const
+{
+    return m_snapshotOffsets.size() - 1;
+}
+
+bool LabelSearchIndex::isComplete() const
+{
+    return m_snapshotOffsets.size() > m_snapshots.size();
+}
+
+void LabelSearchIndex::indexNextSnapshot()
+{
+    Q_ASSERT(!isComplete());
+    const SnapshotItem* snapshot = m_snapshots.at(m_snapshotOffsets.size() - 1);
+    if (snapshot->heapTree()) {
+        // pre-order, such that parents are indexed before their children
+        QVector< QPair<const TreeLeafItem*, int> > stack;
+        stack << qMakePair(static_cast<const TreeLeafItem*>(snapshot->heapTree()), -1);
+        while (!stack.isEmpty()) {
+            const QPair<const TreeLeafItem*, int> item = stack.last();
+            stack.pop_back();
+            const int id = m_nodes.size();
+            m_nodes << item.first;
+            m_parents << item.second;
+            // the root is shown as the snapshot itself, its label is not searched
+            m_nodeLabels << (item.second == -1 ? -1 : labelId(item.first));
+            const QList<TreeLeafItem*> children = item.first->children();
+            for (int i = children.size() - 1; i >= 0; --i) {
+                stack << qMakePair(static_cast<const TreeLeafItem*>(children.at(i)), id);
+            }
+        }
+    }
+    m_snapshotOffsets << m_nodes.size();
+}
+
+int LabelSearchIndex::labelId(const TreeLeafItem* node)
+{
+    QHash<QString, int>::const_iterator it = m_labelIds.constFind(node->label());
+    if (it != m_labelIds.constEnd()) {
+        return it.value();
+    }
+    const int id = m_texts.size();
+    m_labelIds.insert(node->label(), id);
+
+    const Symbol symbol = node->symbol() ? *node->symbol() : Symbol(node->label());
+    QString text = symbol.name().toLower();
+    addTrigrams(text, id);
+    if (symbol.shortName() != symbol.name()) {
+        const QString shortName = symbol.shortName().toLower();
+        addTrigrams(shortName, id);
+        text += QLatin1Char('\n') + shortName;
+    }
+    if (!symbol.address().isEmpty()) {
+        const QString address = symbol.address().toLower();
+        addTrigrams(address, id);
+        text += QLatin1Char('\n') + address;
+    }
+    m_texts << text;
+    return id;
+}
+
+void LabelSearchIndex::addTrigrams(const QString& text, int id)
+{
+    for (int i = 0; i + 3 <= text.size(); ++i) {
+        QVector<int>& ids = m_trigrams[trigram(text.constData() + i)];
+        // labels are added in the order of their ids
+        if (ids.isEmpty() || ids.last() != id) {
+            ids << id;
+        }
+    }
+}
+
+int LabelSearchIndex::labelCount() const
+{
+    return m_texts.size();
+}
+
+int LabelSearchIndex::nodeCount() const
+{
+    return m_nodes.size();
+}
+
+QVector<int> LabelSearchIndex::find(const QString& needle, const QVector<int>* candidates) const
+{
+    const QString lower = needle.toLower();
+    QVector<int> ids;
+    if (candidates) {
+        ids = *candidates;
+    } else if (lower.size() >= 3) {
+        // only labels that contain all trigrams of the needle can match
+        QVector<const QVector<int>*> lists;
+        for (int i = 0; i + 3 <= lower.size(); ++i) {
+            QHash<quint64, QVector<int> >::const_iterator it = m_trigrams.constFind(trigram(lower.constData() + i));
+            if (it == m_trigrams.constEnd()) {
+                return QVector<int>();
+            }
+            lists << &it.value();
+        }
+        qSort(lists.begin(), lists.end(), sortBySize);
+        ids = *lists.first();
+        for (int i = 1; i < lists.size() && !ids.isEmpty(); ++i) {
+            intersect(ids, *lists.at(i));
+        }
+    } else {
+        ids.resize(m_texts.size());
+        for (int i = 0; i < ids.size(); ++i) {
+            ids[i] = i;
+        }
+    }
+
+    int kept = 0;
+    for (int i = 0; i < ids.size(); ++i) {
+        if (m_texts.at(ids.at(i)).contains(lower)) {
+            ids[kept++] = ids.at(i);
+        }
+    }
+    ids.resize(kept);
+    return ids;
+}
+
+void LabelSearchIndex::collectNodes(int snapshot, const QVector<bool>& matches, QVector<bool>* marked,
+                                    QList<const TreeLeafItem*>* nodes) const
+{
+    Q_ASSERT(snapshot + 1 < m_snapshotOffsets.size());
+    const int end = m_snapshotOffsets.at(snapshot + 1);
+    for (int i = m_snapshotOffsets.at(snapshot); i < end; ++i) {
+        const int label = m_nodeLabels.at(i);
+        if (label == -1 || !matches.at(label)) {
+            continue;
+        }
+        for (int node = i; node != -1 && !marked->at(node); node = m_parents.at(node)) {
+            (*marked)[node] = true;
+            *nodes << m_nodes.at(node);
+        }
+    }
+}
+
+QMutex* LabelSearchIndex::mutex()
+{
+    return &m_mutex;
+}
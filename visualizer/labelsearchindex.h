@@ -0,0 +1,136 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MASSIF_LABELSEARCHINDEX_H
+#define MASSIF_LABELSEARCHINDEX_H
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+#include "visualizer_export.h"
+
+namespace Massif {
+
+class FileData;
+class SnapshotItem;
+class TreeLeafItem;
+
+/**
+ * Substring search over the unique labels of all heap trees of a file.
+ *
+ * Every unique label gets an id and is indexed by the trigrams of its parsed
+ * name, with and without template arguments, and of its address. Costs are no
+ * part of the labels and hence can't be searched for. The nodes of all heap trees are
+ * stored in a flat list with the index of their parent, such that the nodes
+ * of matching labels and their ancestors can be found without visiting the
+ * trees again.
+ *
+ * The index is built one snapshot at a time, which allows to stop and resume
+ * building it. It is not thread safe, only the thread holding mutex() may use it.
+ */
+class VISUALIZER_EXPORT LabelSearchIndex
+{
+public:
+    /**
+     * Prepares the index for @p data, which needs to outlive it.
+     */
+    explicit LabelSearchIndex(const FileData* data);
+    ~LabelSearchIndex();
+
+    /**
+     * @return Number of snapshots of the file.
+     */
+    int snapshotCount() const;
+    /**
+     * @return Number of snapshots indexed so far, they are indexed in order.
+     */
+    int indexedSnapshotCount() const;
+    /**
+     * @return True if the heap trees of all snapshots are indexed.
+     */
+    bool isComplete() const;
+    /**
+     * Indexes the heap tree of the next snapshot that is not indexed yet.
+     */
+    void indexNextSnapshot();
+
+    /**
+     * @return Number of unique labels indexed so far.
+     */
+    int labelCount() const;
+
+    /**
+     * @return The ids of all labels that contain @p needle, case insensitively, sorted ascendingly.
+     *
+     * If @p candidates is given, only those labels are considered. This is useful to refine the
+     * result of a previous search for a substring of @p needle.
+     */
+    QVector<int> find(const QString& needle, const QVector<int>* candidates = 0) const;
+
+    /**
+     * Appends the nodes of @p snapshot with one of the labels in @p matches to @p nodes,
+     * together with all their ancestors that are not yet marked in @p marked.
+     *
+     * @p matches has one entry per label, @p marked one per indexed node.
+     */
+    void collectNodes(int snapshot, const QVector<bool>& matches, QVector<bool>* marked,
+                      QList<const TreeLeafItem*>* nodes) const;
+    /**
+     * @return Number of nodes indexed so far.
+     */
+    int nodeCount() const;
+
+    /**
+     * @return The lock that has to be held while using the index.
+     */
+    QMutex* mutex();
+
+private:
+    int labelId(const TreeLeafItem* node);
+    void addTrigrams(const QString& text, int id);
+
+    QList<SnapshotItem*> m_snapshots;
+    // snapshot => first node, one more entry for the end of the last indexed snapshot
+    QVector<int> m_snapshotOffsets;
+    QVector<const TreeLeafItem*> m_nodes;
+    // node => label, or -1 for the roots
+    QVector<int> m_nodeLabels;
+    // node => parent node, or -1 for the roots
+    QVector<int> m_parents;
+    QHash<QString, int> m_labelIds;
+    // label => lower case text that is searched
+    QVector<QString> m_texts;
+    // trigram => sorted ids of the labels that contain it
+    QHash<quint64, QVector<int> > m_trigrams;
+    QMutex m_mutex;
+};
+
+/**
+ * An index shared by consecutive searches, the last one to finish deletes it.
+ */
+typedef QSharedPointer<LabelSearchIndex> LabelSearchIndexHandle;
+
+}
+
+#endif // MASSIF_LABELSEARCHINDEX_H
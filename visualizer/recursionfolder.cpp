@@ -0,0 +1,183 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "recursionfolder.h"
+
+#include "massifdata/snapshotitem.h"
+#include "massifdata/symbol.h"
+#include "massifdata/symboltable.h"
+#include "massifdata/treeleafitem.h"
+
+#include <QtCore/QHash>
+#include <QtCore/qalgorithms.h>
+
+using namespace Massif;
+
+namespace {
+
+bool sortLeafsByCost(TreeLeafItem* l, TreeLeafItem* r)
+{
+    return l->cost() > r->cost();
+}
+
+/**
+ * @return The function of @p symbol that recursive calls are detected by,
+ *         an empty string if its frames are never folded.
+ */
+QString recursionKey(const Symbol* symbol)
+{
+    if (symbol->isBelowThreshold()) {
+        return QString();
+    }
+    // unknown functions can only be told apart by their object
+    if (symbol->function().startsWith(QLatin1String("???"))) {
+        return symbol->name();
+    }
+    return symbol->function();
+}
+
+/**
+ * Folds the runs of recursive calls in a single pass over a heap tree.
+ */
+struct Folder
+{
+    explicit Folder(SymbolTable* symbols) : symbols(symbols), foldedFrames(0) {}
+
+    const Symbol* symbolFor(const TreeLeafItem* node);
+    TreeLeafItem* foldNode(const TreeLeafItem* node);
+    /// adds the children of @p node, which is part of a run of frames of @p function, to @p target
+    void foldChildren(TreeLeafItem* target, const TreeLeafItem* node, const QString& function, unsigned int depth);
+
+    SymbolTable* symbols;
+    // folded item => its children by label, frames of different levels of a run might share a caller
+    QHash<const TreeLeafItem*, QHash<QString, TreeLeafItem*> > children;
+    int foldedFrames;
+};
+
+const Symbol* Folder::symbolFor(const TreeLeafItem* node)
+{
+    // only items that were built by hand lack a symbol
+    return node->symbol() ? symbols->insert(*node->symbol()) : symbols->symbol(node->label());
+}
+
+TreeLeafItem* Folder::foldNode(const TreeLeafItem* node)
+{
+    TreeLeafItem* item = new TreeLeafItem;
+    item->setSymbol(symbolFor(node));
+    item->setCost(node->cost());
+    foldChildren(item, node, recursionKey(item->symbol()), 1);
+    return item;
+}
+
+void Folder::foldChildren(TreeLeafItem* target, const TreeLeafItem* node, const QString& function, unsigned int depth)
+{
+    foreach (const TreeLeafItem* child, node->children()) {
+        const Symbol* symbol = symbolFor(child);
+        const QString childFunction = recursionKey(symbol);
+        if (!function.isEmpty() && childFunction == function) {
+            // recursive call, its cost is already included in the run
+            ++foldedFrames;
+            target->setRecursionDepth(qMax(target->recursionDepth(), depth + 1));
+            foldChildren(target, child, function, depth + 1);
+            continue;
+        }
+
+        TreeLeafItem* existing = children[target].value(child->label());
+        if (existing) {
+            existing->setCost(existing->cost() + child->cost());
+            foldChildren(existing, child, childFunction, 1);
+        } else {
+            TreeLeafItem* item = foldNode(child);
+            target->addChild(item);
+            children[target].insert(child->label(), item);
+        }
+    }
+
+    if (depth == 1) {
+        // the run is complete, restore the order
+        QList<TreeLeafItem*> sorted = target->children();
+        qSort(sorted.begin(), sorted.end(), sortLeafsByCost);
+        target->setChildren(sorted);
+    }
+}
+
+}
+
+RecursionFolder::RecursionFolder(const FileDataHandle& data)
+    : m_original(data), m_foldedFrames(0)
+{
+}
+
+RecursionFolder::~RecursionFolder()
+{
+}
+
+FileDataHandle RecursionFolder::data(bool folded)
+{
+    if (!folded) {
+        return m_original;
+    }
+    if (!m_folded) {
+        // folded for the first time
+        m_folded = FileDataHandle(fold(m_original.data(), &m_foldedFrames));
+    }
+    return m_folded;
+}
+
+int RecursionFolder::foldedFrames() const
+{
+    return m_foldedFrames;
+}
+
+FileData* RecursionFolder::fold(const FileData* data, int* foldedFrames)
+{
+    FileData* ret = new FileData;
+    ret->setCmd(data->cmd());
+    ret->setDescription(data->description());
+    ret->setTimeUnit(data->timeUnit());
+    foreach (const SnapshotItem* snapshot, data->snapshots()) {
+        SnapshotItem* copy = new SnapshotItem;
+        copy->setNumber(snapshot->number());
+        copy->setTime(snapshot->time());
+        copy->setMemHeap(snapshot->memHeap());
+        copy->setMemHeapExtra(snapshot->memHeapExtra());
+        copy->setMemStacks(snapshot->memStacks());
+        if (snapshot->heapTree()) {
+            copy->setHeapTree(fold(snapshot->heapTree(), ret->symbols(), foldedFrames));
+        }
+        ret->addSnapshot(copy);
+        if (snapshot == data->peak()) {
+            ret->setPeak(copy);
+        }
+    }
+    ret->updateColumns();
+    return ret;
+}
+
+TreeLeafItem* RecursionFolder::fold(const TreeLeafItem* root, SymbolTable* symbols, int* foldedFrames)
+{
+    Folder folder(symbols);
+    TreeLeafItem* ret = folder.foldNode(root);
+    ret->updateChains();
+    if (foldedFrames) {
+        *foldedFrames += folder.foldedFrames;
+    }
+    return ret;
+}
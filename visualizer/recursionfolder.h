@@ -0,0 +1,88 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MASSIF_RECURSIONFOLDER_H
+#define MASSIF_RECURSIONFOLDER_H
+
+#include "visualizer_export.h"
+
+#include "massifdata/filedata.h"
+
+namespace Massif {
+
+class SymbolTable;
+class TreeLeafItem;
+
+/**
+ * Folds recursive calls in the heap trees of a file.
+ *
+ * A run of frames of the same function, each called by the previous one, is
+ * replaced by a single node. Its children are the merged children of all
+ * frames in the run and its recursion depth is the length of the run.
+ *
+ * The folded trees are stored in a copy of the data, which is built when it is
+ * requested for the first time, in a single pass over all nodes. The original
+ * data is never modified, workers reading either variant keep it alive through
+ * their handle while the other one is shown.
+ */
+class VISUALIZER_EXPORT RecursionFolder
+{
+public:
+    /**
+     * Prepares folding the heap trees of @p data.
+     */
+    explicit RecursionFolder(const FileDataHandle& data);
+    ~RecursionFolder();
+
+    /**
+     * @return The data with folded heap trees if @p folded is true,
+     *         otherwise the original data.
+     */
+    FileDataHandle data(bool folded);
+
+    /**
+     * @return Number of frames that got folded away in all heap trees,
+     *         zero if the trees were never folded.
+     */
+    int foldedFrames() const;
+
+    /**
+     * @return A copy of @p data with folded heap trees.
+     *         @p foldedFrames is increased by the number of frames folded away.
+     *
+     * @note The caller has to delete the data afterwards.
+     */
+    static FileData* fold(const FileData* data, int* foldedFrames = 0);
+
+    /**
+     * @return A folded copy of the heap tree @p root, whose symbols are taken from @p symbols.
+     *         @p foldedFrames is increased by the number of frames folded away.
+     */
+    static TreeLeafItem* fold(const TreeLeafItem* root, SymbolTable* symbols, int* foldedFrames = 0);
+
+private:
+    FileDataHandle m_original;
+    FileDataHandle m_folded;
+    int m_foldedFrames;
+};
+
+}
+
+#endif // MASSIF_RECURSIONFOLDER_H
@@ -0,0 +1,167 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "sparklinedelegate.h"
+
+#include "massifdata/costkernels.h"
+#include "massifdata/treeleafitem.h"
+
+#include "datatreemodel.h"
+#include "timeseriesindex.h"
+
+#include <QtGui/QPainter>
+#include <QtGui/QPolygonF>
+
+using namespace Massif;
+
+namespace {
+const int sparklineWidth = 60;
+const int margin = 2;
+const int maxCachedSparklines = 1000;
+}
+
+SparklineDelegate::SparklineDelegate(QObject* parent)
+    : QStyledItemDelegate(parent), m_index(0), m_cache(maxCachedSparklines)
+{
+}
+
+SparklineDelegate::~SparklineDelegate()
+{
+}
+
+void SparklineDelegate::setSeriesIndex(const TimeSeriesIndex* index)
+{
+    m_index = index;
+    m_labelIds.clear();
+    m_cache.clear();
+}
+
+int SparklineDelegate::labelForIndex(const QModelIndex& index) const
+{
+    if (!m_index) {
+        return -1;
+    }
+    TreeLeafItem* node = index.data(DataTreeModel::TreeItemRole).value<TreeLeafItem*>();
+    if (!node) {
+        return -1;
+    }
+    QHash<const TreeLeafItem*, int>::const_iterator it = m_labelIds.constFind(node);
+    if (it != m_labelIds.constEnd()) {
+        return it.value();
+    }
+    const int label = m_index->labelId(node->label());
+    m_labelIds.insert(node, label);
+    return label;
+}
+
+QPixmap SparklineDelegate::sparkline(int label, const QSize& size, const QColor& color) const
+{
+    if (size != m_cacheSize) {
+        m_cache.clear();
+        m_cacheSize = size;
+    }
+
+    const QPair<int, QRgb> key(label, color.rgba());
+    if (const QPixmap* cached = m_cache.object(key)) {
+        return *cached;
+    }
+
+    QPixmap pixmap(size);
+    pixmap.fill(Qt::transparent);
+
+    const int count = m_index->snapshotCount();
+    const quint64* costs = m_index->costs(label);
+    const quint64 peak = maxCost(costs, count);
+
+    if (count > 1 && peak) {
+        const int width = size.width();
+        const qreal height = size.height() - 1;
+        QPolygonF line;
+        if (count <= width) {
+            for (int i = 0; i < count; ++i) {
+                line << QPointF(qreal(i) * (width - 1) / (count - 1), height - height * costs[i] / peak);
+            }
+        } else {
+            // more snapshots than pixels, show the maximum of each pixel column
+            for (int x = 0; x < width; ++x) {
+                const int begin = x * count / width;
+                const int end = qMin(count, (x + 1) * count / width + 1);
+                const quint64 cost = maxCost(costs + begin, end - begin);
+                line << QPointF(x, height - height * cost / peak);
+            }
+        }
+
+        QPainter painter(&pixmap);
+        painter.setRenderHint(QPainter::Antialiasing);
+        QPolygonF area(line);
+        area << QPointF(line.last().x(), height) << QPointF(line.first().x(), height);
+        QColor fill(color);
+        fill.setAlpha(60);
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(fill);
+        painter.drawPolygon(area);
+        painter.setPen(color);
+        painter.drawPolyline(line);
+    }
+
+    m_cache.insert(key, new QPixmap(pixmap));
+    return pixmap;
+}
+
+void SparklineDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    const int label = labelForIndex(index);
+    if (label == -1 || option.rect.width() < 3 * sparklineWidth) {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+
+    const QRect sparkRect(option.rect.right() - sparklineWidth - margin + 1, option.rect.top() + margin,
+                          sparklineWidth, option.rect.height() - 2 * margin);
+
+    QStyleOptionViewItem textOption(option);
+    textOption.rect.setRight(sparkRect.left() - margin - 1);
+    QStyledItemDelegate::paint(painter, textOption, index);
+
+    // continue the background of the row behind the sparkline
+    const QRect background(sparkRect.left() - margin, option.rect.top(),
+                           option.rect.right() - sparkRect.left() + margin + 1, option.rect.height());
+    const bool selected = option.state & QStyle::State_Selected;
+    if (selected) {
+        painter->fillRect(background, option.palette.highlight());
+    } else {
+        const QVariant brush = index.data(Qt::BackgroundRole);
+        if (brush.canConvert<QBrush>()) {
+            painter->fillRect(background, brush.value<QBrush>());
+        }
+    }
+
+    const QColor color = option.palette.color(selected ? QPalette::HighlightedText : QPalette::Text);
+    painter->drawPixmap(sparkRect.topLeft(), sparkline(label, sparkRect.size(), color));
+}
+
+QSize SparklineDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    QSize size = QStyledItemDelegate::sizeHint(option, index);
+    if (labelForIndex(index) != -1) {
+        size.rwidth() += sparklineWidth + 2 * margin;
+    }
+    return size;
+}
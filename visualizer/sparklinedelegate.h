@@ -0,0 +1,77 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MASSIF_SPARKLINEDELEGATE_H
+#define MASSIF_SPARKLINEDELEGATE_H
+
+#include <QtGui/QStyledItemDelegate>
+#include <QtGui/QPixmap>
+#include <QtCore/QCache>
+#include <QtCore/QHash>
+#include <QtCore/QPair>
+
+#include "visualizer_export.h"
+
+namespace Massif {
+
+class TimeSeriesIndex;
+class TreeLeafItem;
+
+/**
+ * Draws a small chart of the cost of a call site over all detailed snapshots
+ * next to its label in a view on a DataTreeModel.
+ *
+ * The most recently rendered sparklines are cached per call site.
+ */
+class VISUALIZER_EXPORT SparklineDelegate : public QStyledItemDelegate
+{
+public:
+    SparklineDelegate(QObject* parent = 0);
+    virtual ~SparklineDelegate();
+
+    /**
+     * Set the @p index the cost series are taken from, must outlive this delegate
+     * or be reset with zero. This clears the cache.
+     */
+    void setSeriesIndex(const TimeSeriesIndex* index);
+
+    /**
+     * @return The sparkline of call site @p label in the given @p size and @p color.
+     */
+    QPixmap sparkline(int label, const QSize& size, const QColor& color) const;
+
+    virtual void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const;
+    virtual QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const;
+
+private:
+    /// @return The call site id in the series index for @p index or -1
+    int labelForIndex(const QModelIndex& index) const;
+
+    const TimeSeriesIndex* m_index;
+    // node => label id, such that the label is hashed only once per node
+    mutable QHash<const TreeLeafItem*, int> m_labelIds;
+    // (label id, color) => rendered sparkline
+    mutable QCache<QPair<int, QRgb>, QPixmap> m_cache;
+    mutable QSize m_cacheSize;
+};
+
+}
+
+#endif // MASSIF_SPARKLINEDELEGATE_H
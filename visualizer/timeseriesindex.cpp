@@ -0,0 +1,152 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "timeseriesindex.h"
+
+#include "massifdata/filedata.h"
+#include "massifdata/snapshotitem.h"
+#include "massifdata/treeleafitem.h"
+
+#include "util.h"
+
+using namespace Massif;
+
+TimeSeriesIndex::TimeSeriesIndex(const FileData* data)
+{
+    foreach (SnapshotItem* snapshot, data->snapshots()) {
+        if (snapshot->heapTree()) {
+            m_snapshots << snapshot;
+        }
+    }
+
+    // first pass: assign ids to all labels, so the series can be stored contiguously
+    foreach (SnapshotItem* snapshot, m_snapshots) {
+        foreach (const TreeLeafItem* child, snapshot->heapTree()->children()) {
+            collectLabels(child);
+        }
+    }
+
+    // second pass: fill in the costs
+    m_costs.fill(0, m_labels.size() * m_snapshots.size());
+    m_nodes.fill(0, m_labels.size() * m_snapshots.size());
+    m_onPath.fill(0, m_labels.size());
+    for (int i = 0; i < m_snapshots.size(); ++i) {
+        foreach (TreeLeafItem* child, m_snapshots.at(i)->heapTree()->children()) {
+            indexNode(child, i);
+        }
+    }
+    m_onPath.clear();
+}
+
+TimeSeriesIndex::~TimeSeriesIndex()
+{
+}
+
+void TimeSeriesIndex::collectLabels(const TreeLeafItem* node)
+{
+    if (isBelowThreshold(node->label())) {
+        return;
+    }
+    if (!m_labelIds.contains(node->label())) {
+        m_labelIds.insert(node->label(), m_labels.size());
+        m_labels.append(node->label());
+    }
+    foreach (const TreeLeafItem* child, node->children()) {
+        collectLabels(child);
+    }
+}
+
+void TimeSeriesIndex::indexNode(TreeLeafItem* node, int snapshot)
+{
+    if (isBelowThreshold(node->label())) {
+        return;
+    }
+    const int id = m_labelIds.value(node->label());
+    const int offset = id * m_snapshots.size() + snapshot;
+    if (!m_onPath.at(id)) {
+        // don't count recursive calls twice
+        m_costs[offset] += node->cost();
+    }
+    if (!m_nodes.at(offset) || m_nodes.at(offset)->cost() < node->cost()) {
+        m_nodes[offset] = node;
+    }
+
+    ++m_onPath[id];
+    foreach (TreeLeafItem* child, node->children()) {
+        indexNode(child, snapshot);
+    }
+    --m_onPath[id];
+}
+
+QList< SnapshotItem* > TimeSeriesIndex::snapshots() const
+{
+    return m_snapshots;
+}
+
+int TimeSeriesIndex::snapshotCount() const
+{
+    return m_snapshots.size();
+}
+
+int TimeSeriesIndex::labelCount() const
+{
+    return m_labels.size();
+}
+
+QString TimeSeriesIndex::label(int id) const
+{
+    return m_labels.at(id);
+}
+
+int TimeSeriesIndex::labelId(const QString& label) const
+{
+    return m_labelIds.value(label, -1);
+}
+
+const quint64* TimeSeriesIndex::costs(int id) const
+{
+    Q_ASSERT(id >= 0 && id < m_labels.size());
+    return m_costs.constData() + id * m_snapshots.size();
+}
+
+quint64 TimeSeriesIndex::cost(int id, int snapshot) const
+{
+    Q_ASSERT(snapshot >= 0 && snapshot < m_snapshots.size());
+    return costs(id)[snapshot];
+}
+
+TreeLeafItem* TimeSeriesIndex::node(int id, int snapshot) const
+{
+    Q_ASSERT(id >= 0 && id < m_labels.size());
+    Q_ASSERT(snapshot >= 0 && snapshot < m_snapshots.size());
+    return m_nodes.at(id * m_snapshots.size() + snapshot);
+}
+
+TreeLeafItem* TimeSeriesIndex::peakNode(int id) const
+{
+    TreeLeafItem* peak = 0;
+    for (int i = 0; i < m_snapshots.size(); ++i) {
+        TreeLeafItem* n = node(id, i);
+        if (n && (!peak || n->cost() > peak->cost())) {
+            peak = n;
+        }
+    }
+    return peak;
+}
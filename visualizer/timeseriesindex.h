@@ -0,0 +1,111 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MASSIF_TIMESERIESINDEX_H
+#define MASSIF_TIMESERIESINDEX_H
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+#include "visualizer_export.h"
+
+namespace Massif {
+
+class FileData;
+class SnapshotItem;
+class TreeLeafItem;
+
+/**
+ * Cost of every call site over all detailed snapshots of a file.
+ *
+ * A call site is identified by its label, every unique label gets an id.
+ * The costs of a call site are stored contiguously, one entry per detailed
+ * snapshot. If a call site shows up multiple times in a single heap tree,
+ * the costs of all occurrences are summed up, except for those nested
+ * below another occurrence of the same call site, e.g. in recursions.
+ */
+class VISUALIZER_EXPORT TimeSeriesIndex
+{
+public:
+    /**
+     * Builds the index for @p data, this visits every node once.
+     */
+    explicit TimeSeriesIndex(const FileData* data);
+    ~TimeSeriesIndex();
+
+    /**
+     * @return The detailed snapshots, in the order of the cost series.
+     */
+    QList<SnapshotItem*> snapshots() const;
+    /**
+     * @return Number of detailed snapshots, i.e. the length of each cost series.
+     */
+    int snapshotCount() const;
+
+    /**
+     * @return Number of unique call sites.
+     */
+    int labelCount() const;
+    /**
+     * @return The label for call site @p id.
+     */
+    QString label(int id) const;
+    /**
+     * @return The id of the call site with @p label or -1 if it is unknown.
+     */
+    int labelId(const QString& label) const;
+
+    /**
+     * @return Pointer to the @c snapshotCount() costs of call site @p id.
+     */
+    const quint64* costs(int id) const;
+    /**
+     * @return Cost of call site @p id in the detailed snapshot @p snapshot.
+     */
+    quint64 cost(int id, int snapshot) const;
+    /**
+     * @return The most expensive node of call site @p id in detailed snapshot @p snapshot
+     *         or zero if the call site does not occur there.
+     */
+    TreeLeafItem* node(int id, int snapshot) const;
+    /**
+     * @return The most expensive node of call site @p id over all snapshots.
+     */
+    TreeLeafItem* peakNode(int id) const;
+
+private:
+    void collectLabels(const TreeLeafItem* node);
+    void indexNode(TreeLeafItem* node, int snapshot);
+
+    QList<SnapshotItem*> m_snapshots;
+    QVector<QString> m_labels;
+    QHash<QString, int> m_labelIds;
+    // labels x snapshots, stored per label
+    QVector<quint64> m_costs;
+    QVector<TreeLeafItem*> m_nodes;
+    // label => number of occurrences on the current path while indexing
+    QVector<int> m_onPath;
+};
+
+}
+
+#endif // MASSIF_TIMESERIESINDEX_H
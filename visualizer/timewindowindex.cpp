@@ -0,0 +1,170 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "timewindowindex.h"
+
+#include "massifdata/costkernels.h"
+
+#include <QtCore/qalgorithms.h>
+
+#include <algorithm>
+
+using namespace Massif;
+
+namespace {
+struct ScoreGreater
+{
+    explicit ScoreGreater(const QVector<double>& scores) : m_scores(scores) {}
+    bool operator()(int lhs, int rhs) const
+    {
+        const double l = m_scores.at(lhs);
+        const double r = m_scores.at(rhs);
+        return l > r || (l == r && lhs < rhs);
+    }
+    const QVector<double>& m_scores;
+};
+}
+
+TimeWindowIndex::TimeWindowIndex()
+    : m_seriesCount(0)
+{
+}
+
+TimeWindowIndex::~TimeWindowIndex()
+{
+}
+
+void TimeWindowIndex::clear()
+{
+    m_times.clear();
+    m_seriesCount = 0;
+    m_prefixSums.clear();
+    m_maxima.clear();
+}
+
+void TimeWindowIndex::build(const QVector<double>& times, const QVector<quint64>& costs)
+{
+    clear();
+    const int n = times.size();
+    if (!n) {
+        return;
+    }
+    Q_ASSERT(costs.size() % n == 0);
+    m_times = times;
+    m_seriesCount = costs.size() / n;
+
+    m_prefixSums.resize(m_seriesCount * (n + 1));
+    for (int s = 0; s < m_seriesCount; ++s) {
+        quint64* sums = m_prefixSums.data() + s * (n + 1);
+        sums[0] = 0;
+        prefixSums(costs.constData() + s * n, n, sums + 1);
+    }
+
+    m_maxima.resize(m_seriesCount * 2 * n);
+    for (int s = 0; s < m_seriesCount; ++s) {
+        quint64* tree = m_maxima.data() + s * 2 * n;
+        const quint64* series = costs.constData() + s * n;
+        qCopy(series, series + n, tree + n);
+        for (int i = n - 1; i > 0; --i) {
+            tree[i] = qMax(tree[2 * i], tree[2 * i + 1]);
+        }
+        tree[0] = 0;
+    }
+}
+
+int TimeWindowIndex::seriesCount() const
+{
+    return m_seriesCount;
+}
+
+int TimeWindowIndex::snapshotCount() const
+{
+    return m_times.size();
+}
+
+QPair<int, int> TimeWindowIndex::snapshotRange(double t0, double t1) const
+{
+    if (t0 > t1) {
+        qSwap(t0, t1);
+    }
+    const int first = qLowerBound(m_times.constBegin(), m_times.constEnd(), t0) - m_times.constBegin();
+    const int last = qUpperBound(m_times.constBegin(), m_times.constEnd(), t1) - m_times.constBegin() - 1;
+    if (first > last) {
+        return qMakePair(-1, -1);
+    }
+    return qMakePair(first, last);
+}
+
+quint64 TimeWindowIndex::maximum(int series, int first, int last) const
+{
+    Q_ASSERT(series >= 0 && series < m_seriesCount);
+    Q_ASSERT(first >= 0 && first <= last && last < m_times.size());
+    const int n = m_times.size();
+    const quint64* tree = m_maxima.constData() + series * 2 * n;
+    if (last - first < 64) {
+        // short ranges are scanned faster than walked up
+        return maxCost(tree + n + first, last - first + 1);
+    }
+    quint64 ret = 0;
+    // walk up from the leaves [first, last], taking the nodes that stick out of the range
+    for (int l = first + n, r = last + n + 1; l < r; l /= 2, r /= 2) {
+        if (l & 1) {
+            ret = qMax(ret, tree[l++]);
+        }
+        if (r & 1) {
+            ret = qMax(ret, tree[--r]);
+        }
+    }
+    return ret;
+}
+
+double TimeWindowIndex::average(int series, int first, int last) const
+{
+    Q_ASSERT(series >= 0 && series < m_seriesCount);
+    Q_ASSERT(first >= 0 && first <= last && last < m_times.size());
+    const quint64* sums = m_prefixSums.constData() + series * (m_times.size() + 1);
+    return double(sums[last + 1] - sums[first]) / (last - first + 1);
+}
+
+QVector<int> TimeWindowIndex::topK(int k, int first, int last, Ranking ranking) const
+{
+    QVector<int> ret;
+    if (k <= 0 || !m_seriesCount || first < 0 || first > last || last >= m_times.size()) {
+        return ret;
+    }
+
+    QVector<double> scores(m_seriesCount);
+    for (int s = 0; s < m_seriesCount; ++s) {
+        if (ranking == ByMaximum) {
+            scores[s] = maximum(s, first, last);
+        } else {
+            scores[s] = average(s, first, last);
+        }
+        if (scores.at(s) > 0) {
+            ret << s;
+        }
+    }
+
+    // only the first k need to be in order
+    const int count = qMin(k, ret.size());
+    std::partial_sort(ret.begin(), ret.begin() + count, ret.end(), ScoreGreater(scores));
+    ret.resize(count);
+    return ret;
+}
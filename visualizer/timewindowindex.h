@@ -0,0 +1,94 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MASSIF_TIMEWINDOWINDEX_H
+#define MASSIF_TIMEWINDOWINDEX_H
+
+#include <QtCore/QPair>
+#include <QtCore/QVector>
+
+#include "visualizer_export.h"
+
+namespace Massif {
+
+/**
+ * Answers "which series are the most expensive ones between t0 and t1"
+ * for a set of cost series that share their time axis.
+ *
+ * Per series, prefix sums give the average of any snapshot range in constant
+ * time and a segment tree gives its maximum in logarithmic time, while both
+ * only take linear space.
+ */
+class VISUALIZER_EXPORT TimeWindowIndex
+{
+public:
+    enum Ranking {
+        /// rank by the maximum cost within the time window
+        ByMaximum,
+        /// rank by the average cost within the time window
+        ByAverage
+    };
+
+    TimeWindowIndex();
+    ~TimeWindowIndex();
+
+    /**
+     * Builds the index for @p costs, which contains one series after the other,
+     * each with one cost per entry in @p times. @p times must be sorted.
+     */
+    void build(const QVector<double>& times, const QVector<quint64>& costs);
+    void clear();
+
+    int seriesCount() const;
+    int snapshotCount() const;
+
+    /**
+     * @return The first and last snapshot within [ @p t0, @p t1 ] or (-1, -1) if there are none.
+     */
+    QPair<int, int> snapshotRange(double t0, double t1) const;
+
+    /**
+     * @return The maximum cost of @p series in the snapshots [ @p first, @p last ].
+     */
+    quint64 maximum(int series, int first, int last) const;
+    /**
+     * @return The average cost of @p series in the snapshots [ @p first, @p last ].
+     */
+    double average(int series, int first, int last) const;
+
+    /**
+     * @return Up to @p k series with cost in the snapshots [ @p first, @p last ],
+     *         most expensive first. Ties are ordered by series id.
+     */
+    QVector<int> topK(int k, int first, int last, Ranking ranking) const;
+
+private:
+    QVector<double> m_times;
+    int m_seriesCount;
+    // series x (snapshots + 1)
+    QVector<quint64> m_prefixSums;
+    // series x (2 * snapshots), per series a segment tree with the costs as leaves
+    // at [snapshots, 2 * snapshots) and entry i covering the entries 2i and 2i + 1
+    QVector<quint64> m_maxima;
+};
+
+}
+
+#endif // MASSIF_TIMEWINDOWINDEX_H
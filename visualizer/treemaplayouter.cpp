@@ -0,0 +1,176 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "treemaplayouter.h"
+
+#include "massifdata/treeleafitem.h"
+
+#include <QtCore/QMutexLocker>
+#include <QtCore/qalgorithms.h>
+
+using namespace Massif;
+
+TreeMapTile::TreeMapTile()
+    : node(0), depth(0)
+{
+}
+
+TreeMapTile::TreeMapTile(const QRectF& rect, TreeLeafItem* node, int depth)
+    : rect(rect), node(node), depth(depth)
+{
+}
+
+static bool sortByCost(const TreeLeafItem* l, const TreeLeafItem* r)
+{
+    return l->cost() > r->cost();
+}
+
+TreeMapLayouter::TreeMapLayouter(const FileDataHandle& data, TreeLeafItem* root, const QRectF& rect,
+                                 int maxDepth, qreal minArea, QObject* parent)
+    : QThread(parent), m_data(data), m_root(root), m_rect(rect), m_maxDepth(maxDepth), m_minArea(minArea), m_canceled(false)
+{
+}
+
+TreeMapLayouter::~TreeMapLayouter()
+{
+}
+
+void TreeMapLayouter::cancel()
+{
+    m_canceled = true;
+}
+
+void TreeMapLayouter::run()
+{
+    if (!m_root || m_rect.isEmpty()) {
+        return;
+    }
+
+    // breadth first, so the coarse levels are available right away
+    QVector<TreeMapTile> level;
+    level << TreeMapTile(m_rect, m_root, -1);
+    for (int depth = 0; depth < m_maxDepth && !level.isEmpty() && !m_canceled; ++depth) {
+        QVector<TreeMapTile> next;
+        foreach (const TreeMapTile& parent, level) {
+            if (parent.node->children().isEmpty()) {
+                continue;
+            }
+            // leave a small border, so nested tiles can be told apart
+            const QRectF rect = depth ? parent.rect.adjusted(1, 1, -1, -1) : parent.rect;
+            if (rect.width() * rect.height() < m_minArea) {
+                continue;
+            }
+            QList<TreeLeafItem*> children = parent.node->children();
+            qStableSort(children.begin(), children.end(), sortByCost);
+            squarify(children, rect, depth, next);
+        }
+        {
+            QMutexLocker lock(&m_mutex);
+            m_tiles += next;
+        }
+        emit levelFinished();
+        level = next;
+    }
+}
+
+QVector<TreeMapTile> TreeMapLayouter::takeTiles()
+{
+    QMutexLocker lock(&m_mutex);
+    QVector<TreeMapTile> ret = m_tiles;
+    m_tiles.clear();
+    return ret;
+}
+
+TreeLeafItem* TreeMapLayouter::root() const
+{
+    return m_root;
+}
+
+QRectF TreeMapLayouter::rect() const
+{
+    return m_rect;
+}
+
+/// @return The worst aspect ratio of a row with the given areas along a side of length @p side
+static qreal worstRatio(qreal maxArea, qreal minArea, qreal sum, qreal side)
+{
+    const qreal side2 = side * side;
+    const qreal sum2 = sum * sum;
+    return qMax(side2 * maxArea / sum2, sum2 / (side2 * minArea));
+}
+
+void TreeMapLayouter::squarify(const QList<TreeLeafItem*>& nodes, const QRectF& rect, int depth,
+                               QVector<TreeMapTile>& tiles)
+{
+    unsigned long total = 0;
+    foreach (const TreeLeafItem* node, nodes) {
+        total += node->cost();
+    }
+    if (!total || rect.isEmpty()) {
+        return;
+    }
+
+    const qreal scale = rect.width() * rect.height() / total;
+    QRectF remaining = rect;
+    int i = 0;
+    while (i < nodes.size() && nodes.at(i)->cost()) {
+        const bool vertical = remaining.width() >= remaining.height();
+        const qreal side = vertical ? remaining.height() : remaining.width();
+
+        // add tiles to the current row as long as the aspect ratios improve
+        const qreal firstArea = nodes.at(i)->cost() * scale;
+        qreal sum = firstArea;
+        qreal worst = worstRatio(firstArea, firstArea, sum, side);
+        int end = i + 1;
+        while (end < nodes.size() && nodes.at(end)->cost()) {
+            const qreal area = nodes.at(end)->cost() * scale;
+            const qreal ratio = worstRatio(firstArea, area, sum + area, side);
+            if (ratio > worst) {
+                break;
+            }
+            sum += area;
+            worst = ratio;
+            ++end;
+        }
+
+        // lay out the row along the short side of the remaining rect
+        const qreal thickness = sum / side;
+        qreal offset = 0;
+        for (int j = i; j < end; ++j) {
+            const qreal length = nodes.at(j)->cost() * scale / thickness;
+            QRectF tile;
+            if (vertical) {
+                tile = QRectF(remaining.left(), remaining.top() + offset, thickness, length);
+            } else {
+                tile = QRectF(remaining.left() + offset, remaining.top(), length, thickness);
+            }
+            tiles << TreeMapTile(tile, nodes.at(j), depth);
+            offset += length;
+        }
+        if (vertical) {
+            remaining.setLeft(remaining.left() + thickness);
+        } else {
+            remaining.setTop(remaining.top() + thickness);
+        }
+        i = end;
+    }
+}
+
+#include "treemaplayouter.moc"
@@ -0,0 +1,116 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MASSIF_TREEMAPLAYOUTER_H
+#define MASSIF_TREEMAPLAYOUTER_H
+
+#include <QThread>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QRectF>
+#include <QtCore/QVector>
+
+#include "visualizer_export.h"
+
+#include "massifdata/filedata.h"
+
+namespace Massif {
+
+class TreeLeafItem;
+
+/**
+ * A rectangle in a tree map.
+ */
+struct VISUALIZER_EXPORT TreeMapTile
+{
+    TreeMapTile();
+    TreeMapTile(const QRectF& rect, TreeLeafItem* node, int depth);
+
+    QRectF rect;
+    TreeLeafItem* node;
+    /// 0 for the children of the laid out root
+    int depth;
+};
+
+/**
+ * Computes a squarified tree map of a heap tree, level by level.
+ *
+ * Only the first few levels below the root are laid out and tiles that
+ * are too small to be seen are not subdivided any further. To see deeper
+ * levels, start a new layout for a node further down the tree.
+ *
+ * The tiles of every finished level can be taken while the next one is
+ * still being computed, @c levelFinished() is emitted whenever new tiles
+ * are available.
+ */
+class VISUALIZER_EXPORT TreeMapLayouter : public QThread
+{
+    Q_OBJECT
+public:
+    /**
+     * Lays out the children of @p root in @p rect, down to @p maxDepth levels.
+     * Tiles with an area below @p minArea are not subdivided.
+     *
+     * @p data owns the tree and is kept alive while the layouter exists.
+     */
+    TreeMapLayouter(const FileDataHandle& data, TreeLeafItem* root, const QRectF& rect,
+                    int maxDepth = 4, qreal minArea = 64, QObject* parent = 0);
+    ~TreeMapLayouter();
+
+    /**
+     * Stops the layout after the current level.
+     */
+    void cancel();
+
+    virtual void run();
+
+    /**
+     * @return The tiles that got laid out since the last call.
+     */
+    QVector<TreeMapTile> takeTiles();
+
+    TreeLeafItem* root() const;
+    QRectF rect() const;
+
+    /**
+     * Lays out @p nodes, sorted by descending cost, with squarified tiles
+     * in @p rect and appends them to @p tiles.
+     */
+    static void squarify(const QList<TreeLeafItem*>& nodes, const QRectF& rect, int depth,
+                         QVector<TreeMapTile>& tiles);
+
+signals:
+    void levelFinished();
+
+private:
+    FileDataHandle m_data;
+    TreeLeafItem* m_root;
+    QRectF m_rect;
+    int m_maxDepth;
+    qreal m_minArea;
+    bool m_canceled;
+
+    QMutex m_mutex;
+    QVector<TreeMapTile> m_tiles;
+};
+
+}
+
+#endif // MASSIF_TREEMAPLAYOUTER_H
@@ -0,0 +1,179 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "trendanalyzer.h"
+
+#include "massifdata/costkernels.h"
+#include "massifdata/snapshotitem.h"
+
+#include "timeseriesindex.h"
+
+#include <QtCore/QtConcurrentMap>
+#include <QtCore/qalgorithms.h>
+
+#include <KDebug>
+
+using namespace Massif;
+
+Trend::Trend()
+    : label(-1), slope(0), growth(0), monotonicity(0), score(0), peak(0), last(0)
+{
+}
+
+namespace {
+
+struct FitTrend
+{
+    typedef Trend result_type;
+
+    FitTrend(const TimeSeriesIndex* index, const QVector<double>& times)
+        : index(index), times(times)
+    {
+    }
+
+    Trend operator()(int label) const
+    {
+        return TrendAnalyzer::fit(index, times, label);
+    }
+
+    const TimeSeriesIndex* index;
+    QVector<double> times;
+};
+
+bool sortByScore(const Trend& l, const Trend& r)
+{
+    return l.score > r.score;
+}
+
+}
+
+TrendAnalyzer::TrendAnalyzer(const FileDataHandle& data, QObject* parent)
+    : QThread(parent), m_data(data), m_index(0), m_canceled(false)
+{
+}
+
+TrendAnalyzer::~TrendAnalyzer()
+{
+    delete m_index;
+}
+
+void TrendAnalyzer::cancel()
+{
+    m_canceled = true;
+}
+
+void TrendAnalyzer::run()
+{
+    if (m_canceled) {
+        return;
+    }
+
+    TimeSeriesIndex* index = new TimeSeriesIndex(m_data.data());
+    if (m_canceled) {
+        delete index;
+        return;
+    }
+
+    QVector<double> times;
+    times.reserve(index->snapshotCount());
+    foreach (SnapshotItem* snapshot, index->snapshots()) {
+        times << snapshot->time();
+    }
+
+    QVector<int> labels(index->labelCount());
+    for (int i = 0; i < labels.size(); ++i) {
+        labels[i] = i;
+    }
+
+    kDebug() << "fitting trends for" << labels.size() << "call sites over" << times.size() << "snapshots";
+    QVector<Trend> trends = QtConcurrent::blockingMapped< QVector<Trend> >(labels, FitTrend(index, times));
+    qSort(trends.begin(), trends.end(), sortByScore);
+
+    if (m_canceled) {
+        delete index;
+        return;
+    }
+    m_index = index;
+    m_trends = trends;
+}
+
+Trend TrendAnalyzer::fit(const TimeSeriesIndex* index, const QVector<double>& times, int label)
+{
+    Trend trend;
+    trend.label = label;
+
+    const int n = times.size();
+    const quint64* costs = index->costs(label);
+    if (!n) {
+        return trend;
+    }
+
+    double meanTime = 0;
+    foreach (double time, times) {
+        meanTime += time;
+    }
+    meanTime /= n;
+    const double meanCost = double(sumCosts(costs, n)) / n;
+    trend.peak = maxCost(costs, n);
+    trend.last = costs[n - 1];
+
+    if (n < 2) {
+        return trend;
+    }
+
+    double covariance = 0;
+    double variance = 0;
+    int ups = 0;
+    int downs = 0;
+    for (int i = 0; i < n; ++i) {
+        const double dt = times.at(i) - meanTime;
+        covariance += dt * (costs[i] - meanCost);
+        variance += dt * dt;
+        if (i) {
+            if (costs[i] > costs[i - 1]) {
+                ++ups;
+            } else if (costs[i] < costs[i - 1]) {
+                ++downs;
+            }
+        }
+    }
+
+    if (variance > 0) {
+        trend.slope = covariance / variance;
+    }
+    trend.growth = trend.slope * (times.at(n - 1) - times.at(0));
+    trend.monotonicity = double(ups - downs) / (n - 1);
+    trend.score = trend.growth * qMax(0.0, trend.monotonicity);
+    return trend;
+}
+
+TimeSeriesIndex* TrendAnalyzer::takeIndex()
+{
+    TimeSeriesIndex* ret = m_index;
+    m_index = 0;
+    return ret;
+}
+
+QVector<Trend> TrendAnalyzer::trends() const
+{
+    return m_trends;
+}
+
+#include "trendanalyzer.moc"
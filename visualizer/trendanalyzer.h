@@ -0,0 +1,105 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MASSIF_TRENDANALYZER_H
+#define MASSIF_TRENDANALYZER_H
+
+#include <QThread>
+#include <QtCore/QVector>
+
+#include "visualizer_export.h"
+
+#include "massifdata/filedata.h"
+
+namespace Massif {
+
+class TimeSeriesIndex;
+
+/**
+ * Growth trend of a single call site over all detailed snapshots.
+ */
+struct VISUALIZER_EXPORT Trend
+{
+    Trend();
+
+    /// id of the call site in the TimeSeriesIndex
+    int label;
+    /// slope of the least squares fit, in bytes per time unit
+    double slope;
+    /// increase over the whole run according to the fit, in bytes
+    double growth;
+    /// -1 for strictly decreasing, 1 for strictly increasing costs
+    double monotonicity;
+    /// growth weighted by monotonicity, used for ranking
+    double score;
+    quint64 peak;
+    quint64 last;
+};
+
+/**
+ * Fits a linear trend to the cost series of every call site in parallel.
+ *
+ * Slow leaks never make it to the top of the peak snapshot, but they
+ * show up here with a steady growth and a high monotonicity.
+ */
+class VISUALIZER_EXPORT TrendAnalyzer : public QThread
+{
+    Q_OBJECT
+public:
+    /**
+     * Analyzes the trends in @p data, which is kept alive while the analyzer exists.
+     */
+    explicit TrendAnalyzer(const FileDataHandle& data, QObject* parent = 0);
+    ~TrendAnalyzer();
+
+    /**
+     * Stops the analysis.
+     */
+    void cancel();
+
+    virtual void run();
+
+    /**
+     * @return The index the trends refer to, or zero if the analysis did not finish.
+     *
+     * @note The caller takes ownership.
+     */
+    TimeSeriesIndex* takeIndex();
+
+    /**
+     * @return The trends of all call sites, sorted by their score.
+     */
+    QVector<Trend> trends() const;
+
+    /**
+     * Fits a trend to the costs of call site @p label in @p index.
+     */
+    static Trend fit(const TimeSeriesIndex* index, const QVector<double>& times, int label);
+
+private:
+    FileDataHandle m_data;
+    TimeSeriesIndex* m_index;
+    QVector<Trend> m_trends;
+    bool m_canceled;
+};
+
+}
+
+#endif // MASSIF_TRENDANALYZER_H
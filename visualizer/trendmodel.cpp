@@ -0,0 +1,209 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "trendmodel.h"
+
+#include "timeseriesindex.h"
+#include "util.h"
+
+#include <KLocalizedString>
+
+#include <QtCore/qalgorithms.h>
+
+using namespace Massif;
+
+namespace {
+
+struct TrendLessThan
+{
+    TrendLessThan(const TimeSeriesIndex* index, int column)
+        : index(index), column(column)
+    {
+    }
+
+    bool operator()(const Trend& l, const Trend& r) const
+    {
+        switch (column) {
+            case TrendModel::FunctionColumn:
+                return prettyLabel(index->label(l.label)) < prettyLabel(index->label(r.label));
+            case TrendModel::GrowthColumn:
+                return l.score < r.score;
+            case TrendModel::MonotonicityColumn:
+                return l.monotonicity < r.monotonicity;
+            case TrendModel::PeakColumn:
+                return l.peak < r.peak;
+            case TrendModel::LastColumn:
+                return l.last < r.last;
+        }
+        return false;
+    }
+
+    const TimeSeriesIndex* index;
+    int column;
+};
+
+}
+
+TrendModel::TrendModel(QObject* parent)
+    : QAbstractTableModel(parent), m_index(0)
+{
+}
+
+TrendModel::~TrendModel()
+{
+    delete m_index;
+}
+
+void TrendModel::setSource(TimeSeriesIndex* index, const QVector<Trend>& trends)
+{
+    beginResetModel();
+    delete m_index;
+    m_index = index;
+    m_trends = index ? trends : QVector<Trend>();
+    endResetModel();
+}
+
+TimeSeriesIndex* TrendModel::seriesIndex() const
+{
+    return m_index;
+}
+
+int TrendModel::labelForIndex(const QModelIndex& idx) const
+{
+    if (!m_index || !idx.isValid() || idx.parent().isValid() || idx.row() >= m_trends.size()) {
+        return -1;
+    }
+    return m_trends.at(idx.row()).label;
+}
+
+QVector<Trend> TrendModel::trends() const
+{
+    return m_trends;
+}
+
+QVariant TrendModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractItemModel::headerData(section, orientation, role);
+    }
+    switch (section) {
+        case FunctionColumn:
+            return i18n("Function");
+        case GrowthColumn:
+            return i18n("Growth");
+        case MonotonicityColumn:
+            return i18n("Monotonicity");
+        case PeakColumn:
+            return i18n("Peak");
+        case LastColumn:
+            return i18n("Last");
+    }
+    return QVariant();
+}
+
+QVariant TrendModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+
+    Q_ASSERT(index.row() >= 0 && index.row() < rowCount(index.parent()));
+    Q_ASSERT(index.column() >= 0 && index.column() < columnCount(index.parent()));
+    Q_ASSERT(m_index);
+
+    const Trend& trend = m_trends.at(index.row());
+
+    if (role == Qt::ToolTipRole) {
+        return i18n("%1\nfitted growth of %2 over the whole run, %3% monotonic",
+                    prettyLabel(m_index->label(trend.label)),
+                    prettyCostDelta(long(trend.growth)),
+                    int(trend.monotonicity * 100));
+    }
+
+    if (role == Qt::TextAlignmentRole && index.column() != FunctionColumn) {
+        return int(Qt::AlignRight | Qt::AlignVCenter);
+    }
+
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    switch (index.column()) {
+        case FunctionColumn:
+            return prettyLabel(m_index->label(trend.label));
+        case GrowthColumn:
+            return prettyCostDelta(long(trend.growth));
+        case MonotonicityColumn:
+            return i18nc("%1: monotonicity in percent", "%1%", int(trend.monotonicity * 100));
+        case PeakColumn:
+            return prettyCost(trend.peak);
+        case LastColumn:
+            return prettyCost(trend.last);
+    }
+    return QVariant();
+}
+
+int TrendModel::columnCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return NUM_COLUMNS;
+}
+
+int TrendModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_trends.size();
+}
+
+void TrendModel::sort(int column, Qt::SortOrder order)
+{
+    if (!m_index || column < 0 || column >= NUM_COLUMNS) {
+        return;
+    }
+    emit layoutAboutToBeChanged();
+    // remember the labels of the persistent indices, e.g. the current one of the view
+    const QModelIndexList oldIndices = persistentIndexList();
+    QVector<int> labels;
+    labels.reserve(oldIndices.size());
+    foreach (const QModelIndex& idx, oldIndices) {
+        labels << labelForIndex(idx);
+    }
+
+    qStableSort(m_trends.begin(), m_trends.end(), TrendLessThan(m_index, column));
+    if (order == Qt::DescendingOrder) {
+        QAlgorithmsPrivate::qReverse(m_trends.begin(), m_trends.end());
+    }
+
+    QVector<int> rows(m_index->labelCount(), -1);
+    for (int row = 0; row < m_trends.size(); ++row) {
+        rows[m_trends.at(row).label] = row;
+    }
+    QModelIndexList newIndices;
+    for (int i = 0; i < oldIndices.size(); ++i) {
+        const int row = labels.at(i) == -1 ? -1 : rows.at(labels.at(i));
+        newIndices << (row == -1 ? QModelIndex() : index(row, oldIndices.at(i).column()));
+    }
+    changePersistentIndexList(oldIndices, newIndices);
+    emit layoutChanged();
+}
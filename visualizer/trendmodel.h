@@ -0,0 +1,85 @@
+/*
+   This file is part of Massif Visualizer
+
+   Copyright 2011 Milian Wolff <mail@milianw.de>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License version 2 as published by the Free Software Foundation.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MASSIF_TRENDMODEL_H
+#define MASSIF_TRENDMODEL_H
+
+#include <QtCore/QAbstractTableModel>
+#include <QtCore/QVector>
+
+#include "trendanalyzer.h"
+#include "visualizer_export.h"
+
+namespace Massif {
+
+class TimeSeriesIndex;
+
+/**
+ * A sortable table of the growth trends of all call sites.
+ */
+class VISUALIZER_EXPORT TrendModel : public QAbstractTableModel
+{
+public:
+    enum Columns {
+        FunctionColumn,
+        GrowthColumn,
+        MonotonicityColumn,
+        PeakColumn,
+        LastColumn,
+        NUM_COLUMNS
+    };
+
+    TrendModel(QObject* parent = 0);
+    virtual ~TrendModel();
+
+    /**
+     * Set the @p trends computed on @p index. The model takes ownership of @p index.
+     */
+    void setSource(TimeSeriesIndex* index, const QVector<Trend>& trends);
+
+    /**
+     * @return The index the trends refer to, or zero if none is set.
+     */
+    TimeSeriesIndex* seriesIndex() const;
+
+    /**
+     * @return The call site id in @c seriesIndex() for @p idx or -1 if it is invalid.
+     */
+    int labelForIndex(const QModelIndex& idx) const;
+
+    /**
+     * @return The trends of all call sites, in the current sort order.
+     */
+    QVector<Trend> trends() const;
+
+    virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
+    virtual int rowCount(const QModelIndex& parent = QModelIndex()) const;
+    virtual int columnCount(const QModelIndex& parent = QModelIndex()) const;
+    virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+    virtual void sort(int column, Qt::SortOrder order = Qt::AscendingOrder);
+
+private:
+    TimeSeriesIndex* m_index;
+    QVector<Trend> m_trends;
+};
+
+}
+
+#endif // MASSIF_TRENDMODEL_H
@@ -21,6 +21,7 @@
 #include "util.h"
 
 #include "massifdata/snapshotitem.h"
+#include "massifdata/symbol.h"
 #include "massifdata/treeleafitem.h"
 
 #include <KGlobal>
@@ -28,63 +29,174 @@
 #include <KConfigGroup>
 #include <KDebug>
 
+#include <QtCore/QAtomicInt>
+#include <QtCore/QCache>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QThreadStorage>
 #include <QTextDocument>
 
 namespace Massif {
 
-QString prettyCost(unsigned long cost)
+namespace {
+
+/**
+ * The settings used for formatting, shared by all threads. The mutex is only
+ * locked by threads whose cache is older than the last reloadFormatSettings().
+ */
+struct FormatSettings
+{
+    FormatSettings()
+        : generation(1), loaded(false), precision(1), shortenTemplates(false)
+    {
+    }
+
+    // bumped by every reloadFormatSettings()
+    QAtomicInt generation;
+    QMutex mutex;
+    bool loaded;
+    int precision;
+    bool shortenTemplates;
+};
+
+K_GLOBAL_STATIC(FormatSettings, formatSettings)
+
+/**
+ * The settings and strings used for formatting by one thread, such that views
+ * do not need to read the config or format the same cost again whenever they
+ * get repainted. Background workers format as well, but every thread has its
+ * own cache, hence no locking is needed.
+ */
+struct FormatCache
+{
+    FormatCache()
+        : generation(0), precision(1), shortenTemplates(false)
+        , costs(10000), symbols(2000)
+    {
+    }
+
+    int generation;
+    int precision;
+    bool shortenTemplates;
+    // cost => formatted with the current precision, least recently used ones get dropped
+    QCache<unsigned long, QString> costs;
+    // labels that are not part of a symbol table => parsed label
+    QCache<QString, Symbol> symbols;
+};
+
+K_GLOBAL_STATIC(QThreadStorage<FormatCache*>, formatCaches)
+
+/// @return The cache of the current thread, up to date with the settings.
+FormatCache* formatCache()
 {
-    Q_ASSERT(KGlobal::config());
-    KConfigGroup conf = KGlobal::config()->group(QLatin1String("Settings"));
-    int precision = conf.readEntry(QLatin1String("prettyCostPrecision"), 1);
-    return KGlobal::locale()->formatByteSize(cost, precision);
+    FormatCache* cache = formatCaches->localData();
+    if (!cache) {
+        cache = new FormatCache;
+        formatCaches->setLocalData(cache);
+    }
+    const int generation = formatSettings->generation;
+    if (cache->generation != generation) {
+        QMutexLocker lock(&formatSettings->mutex);
+        if (!formatSettings->loaded) {
+            Q_ASSERT(KGlobal::config());
+            KConfigGroup conf = KGlobal::config()->group(QLatin1String("Settings"));
+            formatSettings->precision = conf.readEntry(QLatin1String("prettyCostPrecision"), 1);
+            formatSettings->shortenTemplates = conf.readEntry(QLatin1String("shortenTemplates"), false);
+            formatSettings->loaded = true;
+        }
+        cache->precision = formatSettings->precision;
+        cache->shortenTemplates = formatSettings->shortenTemplates;
+        cache->costs.clear();
+        cache->generation = generation;
+    }
+    return cache;
 }
 
-QString prettyLabel(const QString& label)
+/// @return The parsed @p label, which stays valid until the next call on this thread.
+const Symbol& cachedSymbol(const QString& label)
 {
-    QString ret;
+    QCache<QString, Symbol>& symbols = formatCache()->symbols;
+    Symbol* symbol = symbols.object(label);
+    if (!symbol) {
+        symbol = new Symbol(label);
+        symbols.insert(label, symbol);
+    }
+    return *symbol;
+}
 
-    int colonPos = label.indexOf(": ");
-    if (colonPos == -1) {
-        ret = label;
-    } else {
-        ret = label.mid(colonPos + 2);
+}
+
+QString prettyCost(unsigned long cost)
+{
+    FormatCache* cache = formatCache();
+    const QString* cached = cache->costs.object(cost);
+    if (cached) {
+        return *cached;
     }
+    const QString formatted = KGlobal::locale()->formatByteSize(cost, cache->precision);
+    cache->costs.insert(cost, new QString(formatted));
+    return formatted;
+}
 
-    Q_ASSERT(KGlobal::config());
-    KConfigGroup conf = KGlobal::config()->group(QLatin1String("Settings"));
-    if (conf.readEntry(QLatin1String("shortenTemplates"), false)) {
-        // remove template arguments between <...>
-        int depth = 0;
-        int open = 0;
-        for (int i = 0; i < ret.length(); ++i) {
-            if (ret.at(i) == '<') {
-                if (!depth) {
-                    open = i;
-                }
-                ++depth;
-            } else if (ret.at(i) == '>') {
-                --depth;
-                if (!depth) {
-                    ret.remove(open + 1, i - open - 1);
-                    i = open + 1;
-                    open = 0;
-                }
-            }
-        }
+int prettyCostPrecision()
+{
+    return formatCache()->precision;
+}
+
+bool shortenTemplates()
+{
+    return formatCache()->shortenTemplates;
+}
+
+void reloadFormatSettings()
+{
+    QMutexLocker lock(&formatSettings->mutex);
+    formatSettings->loaded = false;
+    formatSettings->generation.ref();
+}
+
+QString prettyCostDelta(long delta)
+{
+    if (delta < 0) {
+        return i18nc("%1: cost that got released", "-%1", prettyCost(-delta));
     }
+    return i18nc("%1: cost that got allocated", "+%1", prettyCost(delta));
+}
 
-    return ret;
+QString prettyLabel(const QString& label)
+{
+    return prettyLabel(cachedSymbol(label));
+}
+
+QString prettyLabel(const Symbol& symbol)
+{
+    return shortenTemplates() ? symbol.shortName() : symbol.name();
+}
+
+QString prettyLabel(const TreeLeafItem* node)
+{
+    if (node->symbol()) {
+        return prettyLabel(*node->symbol());
+    }
+    return prettyLabel(node->label());
 }
 
 QString functionInLabel(const QString& label)
 {
-    QString ret = prettyLabel(label);
-    int pos = ret.lastIndexOf(" (");
-    if (pos != -1) {
-        ret.resize(pos);
+    return functionInLabel(cachedSymbol(label));
+}
+
+QString functionInLabel(const Symbol& symbol)
+{
+    return shortenTemplates() ? symbol.shortFunction() : symbol.function();
+}
+
+QString functionInLabel(const TreeLeafItem* node)
+{
+    if (node->symbol()) {
+        return functionInLabel(*node->symbol());
     }
-    return ret;
+    return functionInLabel(node->label());
 }
 
 bool isBelowThreshold(const QString& label)
@@ -92,26 +204,19 @@ bool isBelowThreshold(const QString& label)
     return label.indexOf("all below massif's threshold") != -1;
 }
 
-QString formatLabel(const QString& label)
+QString formatSymbol(const Symbol& symbol)
 {
-    static QRegExp pattern("^(0x.+: )?([^\\)]+\\))(?: \\(([^\\)]+)\\))?$", Qt::CaseSensitive,
-                           QRegExp::RegExp2);
-    pattern.setMinimal(true);
-    if (pattern.indexIn(label) != -1) {
-        QString ret;
-        if (!pattern.cap(2).isEmpty()) {
-            ret += i18n("<dt>function:</dt><dd>%1</dd>\n", Qt::escape(pattern.cap(2)));
-        }
-        if (!pattern.cap(3).isEmpty()) {
-            ret += i18n("<dt>location:</dt><dd>%1</dd>\n", Qt::escape(pattern.cap(3)));
-        }
-        if (!pattern.cap(1).isEmpty()) {
-            ret += i18n("<dt>address:</dt><dd>%1</dd>\n", Qt::escape(pattern.cap(1)));
-        }
-        return ret;
-    } else {
-        return label;
+    QString ret;
+    if (!symbol.function().isEmpty()) {
+        ret += i18n("<dt>function:</dt><dd>%1</dd>\n", Qt::escape(symbol.isBelowThreshold() ? symbol.name() : symbol.function()));
+    }
+    if (!symbol.location().isEmpty()) {
+        ret += i18n("<dt>location:</dt><dd>%1</dd>\n", Qt::escape(symbol.location()));
     }
+    if (!symbol.address().isEmpty()) {
+        ret += i18n("<dt>address:</dt><dd>%1</dd>\n", Qt::escape(symbol.address()));
+    }
+    return ret;
 }
 
 QString tooltipForTreeLeaf(TreeLeafItem* node, SnapshotItem* snapshot, const QString& label)
@@ -120,7 +225,14 @@ QString tooltipForTreeLeaf(TreeLeafItem* node, SnapshotItem* snapshot, const QSt
     tooltip += i18n("<dt>cost:</dt><dd>%1, i.e. %2% of snapshot #%3</dd>", prettyCost(node ? node->cost() : 0),
                     // yeah nice how I round to two decimals, right? :D
                     double(int(double(node ? node->cost() : 0)/snapshot->memHeap()*10000))/100, snapshot->number());
-    tooltip += formatLabel(label);
+    if (node && node->symbol() && node->label() == label) {
+        tooltip += formatSymbol(*node->symbol());
+    } else {
+        tooltip += formatSymbol(cachedSymbol(label));
+    }
+    if (node && node->recursionDepth() > 1) {
+        tooltip += i18n("<dt>recursion depth:</dt><dd>%1</dd>", node->recursionDepth());
+    }
     tooltip += "</dl></body></html>";
     return tooltip;
 }
@@ -29,22 +29,60 @@ namespace Massif {
 
 class TreeLeafItem;
 class SnapshotItem;
+class Symbol;
 
 /**
  * Returns a prettified cost string.
  */
 VISUALIZER_EXPORT QString prettyCost(unsigned long cost);
 
+/**
+ * @return The number of decimals used by prettyCost().
+ */
+VISUALIZER_EXPORT int prettyCostPrecision();
+
+/**
+ * @return Whether prettyLabel() and functionInLabel() strip template arguments.
+ */
+VISUALIZER_EXPORT bool shortenTemplates();
+
+/**
+ * Reads the settings for the functions below again and drops all cached strings.
+ * Needs to be called whenever the settings got changed.
+ */
+VISUALIZER_EXPORT void reloadFormatSettings();
+
+/**
+ * Returns a prettified, signed string for a change in cost.
+ */
+VISUALIZER_EXPORT QString prettyCostDelta(long delta);
+
 /**
  * Prepares a tree node's label for the UI.
  * So far, only the Mem-Adress will get stripped.
  */
 VISUALIZER_EXPORT QString prettyLabel(const QString& label);
+/**
+ * Prepares the already parsed label @p symbol for the UI.
+ */
+VISUALIZER_EXPORT QString prettyLabel(const Massif::Symbol& symbol);
+/**
+ * Prepares the label of @p node for the UI, without parsing it again if possible.
+ */
+VISUALIZER_EXPORT QString prettyLabel(const Massif::TreeLeafItem* node);
 
 /**
  * Extracts the function name from the @p label
  */
 VISUALIZER_EXPORT QString functionInLabel(const QString& label);
+/**
+ * @return The function name of the already parsed label @p symbol.
+ */
+VISUALIZER_EXPORT QString functionInLabel(const Massif::Symbol& symbol);
+/**
+ * @return The function name in the label of @p node, without parsing it again if possible.
+ */
+VISUALIZER_EXPORT QString functionInLabel(const Massif::TreeLeafItem* node);
 
 /**
  * Checks whether this label denotes a tree node